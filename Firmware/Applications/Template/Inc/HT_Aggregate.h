@@ -0,0 +1,51 @@
+#ifndef __HT_AGGREGATE_H__
+#define __HT_AGGREGATE_H__
+
+#include <stdint.h>
+
+// Windowed aggregation of samples.
+// Every sample is folded into running accumulators kept in retention memory;
+// when a window ends one summary (count, min, max, mean, standard deviation
+// per channel) is uploaded instead of the raw points, on the summary topic
+// ("st=<topic>" sets it, see HT_Config.h). Raw samples stay in the flash
+// journal and are only uploaded on a backfill request.
+//
+// The accumulators are exact integer moments of the 0.1 unit values (sum and
+// sum of squares) rather than floating point Welford updates: the Cortex-M3
+// has no FPU, and integer moments have no cancellation error to guard against.
+
+#define HT_AGG_WINDOW_S         0       // Default window: off until set with "aw=", 0 disables aggregation
+#define HT_AGG_STR_SIZE         112     // Formatted summary plus terminator
+
+typedef struct {
+    int64_t sum_sq;             // Sum of squared values, 0.01 units
+    int32_t sum;                // Sum of values, 0.1 units
+    uint16_t count;             // Valid values, missing ones are skipped
+    int16_t min;
+    int16_t max;
+} HT_AggChannel;
+
+// Kept in retention memory
+typedef struct {
+    uint32_t start;             // Window start, aligned to the window length
+    uint8_t backfill;           // Raw journal upload requested
+    uint8_t reserved[3];
+    HT_AggChannel temperature;
+    HT_AggChannel humidity;
+} HT_AggState;
+
+// Forgets the current window.
+void HT_Agg_Reset(HT_AggState *state);
+
+// Adds one sample taken at now (seconds). When now is past the current window,
+// that window is copied to closed and a new one started first; returns 1 then.
+uint8_t HT_Agg_Add(HT_AggState *state, uint32_t window_s, uint32_t now,
+                   int16_t temperature, int16_t humidity, HT_AggState *closed);
+
+// Formats a closed window as "start,length,n,min,max,mean,sd" for temperature
+// followed by "n,min,max,mean,sd" for humidity, in 0.1 units; a channel without
+// valid values is just "0". start is passed separately so the caller can convert
+// it to UTC. Returns the length.
+uint8_t HT_Agg_Format(const HT_AggState *window, uint32_t start, uint32_t window_s, char *out);
+
+#endif // __HT_AGGREGATE_H__
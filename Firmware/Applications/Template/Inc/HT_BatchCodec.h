@@ -0,0 +1,70 @@
+#ifndef __HT_BATCHCODEC_H__
+#define __HT_BATCHCODEC_H__
+
+#include <stdint.h>
+#include "HT_SampleRing.h"  // For HT_SampleRecord
+
+// Compact encodings for a batch of samples in one uplink message.
+//
+// HT_BATCH_FORMAT_DELTA (about 3 bytes per sample):
+//   header   uint8 version | flags (HT_BATCH_FLAG_*)
+//            varint base time, varint interval (s)
+//            [varint VBAT mV] [varint RSSI] when flagged
+//   sample   zig-zag varint time deviation from previous time + interval
+//            varint temperature code, varint humidity code
+//   Value codes are 0 for a missing value, zigzag(delta from the previous
+//   present value) + 1 otherwise. The first deltas are taken from 0. The
+//   payload ends with the message, there is no sample count.
+//
+// HT_BATCH_FORMAT_CBOR (RFC 8949), for generic decoders:
+//   {"t0": base, "dt": interval, ["vbat": mV,] ["rssi": r,]
+//    "s": [_ [time deviation, temp, hum], ...]}
+//   with absolute deci values, null when missing, and an indefinite-length
+//   sample array so samples can be appended while streaming.
+//
+// Either message may be sent LZ compressed as a whole, see HT_Lz.h.
+
+#define HT_BATCH_FORMAT_DELTA       0
+#define HT_BATCH_FORMAT_CBOR        1
+
+#define HT_BATCH_VERSION            0x10    // High nibble of the first byte
+#define HT_BATCH_FLAG_VBAT          (1 << 0)
+#define HT_BATCH_FLAG_RSSI          (1 << 1)
+
+#define HT_BATCH_HEADER_MAX         40      // Worst case header, either format
+#define HT_BATCH_SAMPLE_MAX         13      // Worst case sample, either format
+
+#define HT_BATCH_OK                 0
+#define HT_BATCH_ERROR_FULL         -1      // Not enough room, nothing written
+#define HT_BATCH_ERROR_FORMAT       -2
+
+typedef struct {
+    uint8_t flags;          // HT_BATCH_FLAG_* fields present
+    uint16_t vbat_mv;
+    uint8_t rssi;
+} HT_BatchExtra;
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t len;
+    uint8_t format;
+    uint16_t interval;
+    uint16_t count;             // Samples encoded
+    uint32_t prev_time;
+    int16_t prev_temperature;
+    int16_t prev_humidity;
+} HT_BatchEncoder;
+
+// Starts a batch in buf. extra may be NULL.
+int HT_Batch_Begin(HT_BatchEncoder *enc, uint8_t format, uint8_t *buf, uint16_t size,
+                   uint32_t base_time, uint16_t interval, const HT_BatchExtra *extra);
+
+// Appends one sample. Returns HT_BATCH_ERROR_FULL, leaving the batch intact,
+// when the sample and the batch terminator would not fit.
+int HT_Batch_Add(HT_BatchEncoder *enc, const HT_SampleRecord *record);
+
+// Terminates the batch. Returns the payload length.
+uint16_t HT_Batch_End(HT_BatchEncoder *enc);
+
+#endif // __HT_BATCHCODEC_H__
@@ -0,0 +1,71 @@
+#ifndef __HT_CONFIG_H__
+#define __HT_CONFIG_H__
+
+#include <stdint.h>
+#include "HT_Report.h"
+
+// Device configuration store.
+// Settings are kept as typed key/value records in two shadow files of the
+// flash file system. A commit writes the older copy with the next sequence
+// number, so a reset in the middle of a write leaves the previous copy intact.
+// The values are loaded once into retention memory and only read from flash
+// again when the retention area was formatted; writes happen only when a value
+// actually changes. The summary topic is the exception: it is too long for the
+// retention area and is read from the newest copy when a session needs it.
+
+#define HT_CONFIG_FILE_0            "config0"
+#define HT_CONFIG_FILE_1            "config1"
+#define HT_CONFIG_LEGACY_FILE       "testFile"      // Interval of older firmware, migrated once
+#define HT_CONFIG_MAGIC             0x46434353UL    // "SCCF"
+#define HT_CONFIG_FORMAT            1               // Record encoding, not the key set
+#define HT_CONFIG_MAX_SIZE          128             // Header plus every record
+#define HT_CONFIG_TOPIC_MAX         63              // Summary topic length
+
+#define HT_CONFIG_INTERVAL_MS       30000UL         // 30 seconds
+
+// Record keys. Never reuse a number: unknown keys are skipped on load and
+// missing ones keep their default, so old and new firmware share the files.
+#define HT_CONFIG_KEY_INTERVAL_MS   1
+#define HT_CONFIG_KEY_DEADBAND_TEMP 2
+#define HT_CONFIG_KEY_DEADBAND_HUM  3
+#define HT_CONFIG_KEY_HEARTBEAT_S   4
+#define HT_CONFIG_KEY_AGGREGATE_S   5
+#define HT_CONFIG_KEY_SUMMARY_TOPIC 6       // Not in HT_Config, see HT_Config_GetTopic
+
+#define HT_CONFIG_OK                0
+#define HT_CONFIG_ERROR_WRITE       -1      // File could not be written, RAM copy kept
+#define HT_CONFIG_ERROR_TOPIC       -2      // Topic too long or with wildcards
+
+typedef struct {
+    uint32_t interval_ms;           // Sampling period
+    HT_ReportConfig report;         // Reporting policy
+    uint32_t aggregate_s;           // Summary window, 0 uploads raw samples instead
+} HT_Config;
+
+// Retention copy of the store
+typedef struct {
+    HT_Config values;
+    uint32_t seq;                   // Sequence number of the newest copy, 0 if none
+    uint8_t slot;                   // File holding the newest copy
+    uint8_t loaded;                 // values reflect the flash copy
+    uint8_t reserved[2];
+} HT_ConfigState;
+
+// Returns the current configuration, loading it from flash on first use after
+// the retention area was formatted.
+const HT_Config *HT_Config_Get(void);
+
+// Replaces the configuration. Nothing is written when config equals the
+// current values. Returns HT_CONFIG_OK or HT_CONFIG_ERROR_WRITE.
+int HT_Config_Set(const HT_Config *config);
+
+// Copies the summary topic to topic (HT_CONFIG_TOPIC_MAX + 1 bytes) and
+// returns its length, or returns 0 and leaves topic alone when none was set.
+uint8_t HT_Config_GetTopic(char *topic);
+
+// Sets the summary topic, len 0 going back to the built-in one. Nothing is
+// written when it is unchanged. Returns HT_CONFIG_OK, HT_CONFIG_ERROR_TOPIC or
+// HT_CONFIG_ERROR_WRITE.
+int HT_Config_SetTopic(const char *topic, uint8_t len);
+
+#endif // __HT_CONFIG_H__
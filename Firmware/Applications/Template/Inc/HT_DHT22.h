@@ -3,24 +3,50 @@
 
 #include <stdint.h>
 #include "bsp.h" // For pad_config_t, gpio_pin_config_t
+#include "HT_DHT22_Decoder.h" // For DHT22 return codes and frame decoder
+#include "HT_Sensor.h"        // For HT_SensorReading
 
 #define DHT22_GPIO_INSTANCE 0
 #define DHT22_GPIO_PIN      2
 // According to the GPIO Table in HT_GPIO_Api.h, GPIO2 is on PAD ID 13.
 #define DHT22_PAD_ID        13 //2 // o Correta para uso Ã© o Pin Number da GPIO0_2
 
-// DHT22_Read function return codes
-#define DHT22_OK                    0   // Success
-#define DHT22_ERROR_TIMEOUT_START   -1  // Timeout waiting for sensor response to start
-#define DHT22_ERROR_TIMEOUT_LOW     -2  // Timeout waiting for response low pulse to end
-#define DHT22_ERROR_TIMEOUT_HIGH    -3  // Timeout waiting for response high pulse to end
-#define DHT22_ERROR_TIMEOUT_DATA    -4  // Timeout during data bit reception
-#define DHT22_ERROR_CHECKSUM        -5  // Checksum mismatch
+// Sensor supply switched by a GPIO so the DHT22 is only powered during acquisition.
+// Off by default: the demo board wires VCC straight to the supply rail. Set to 1
+// after moving the sensor VCC to GPIO10 (PAD ID 25), which nothing else on the
+// board uses; GPIO3..GPIO5 drive the LEDs and GPIO6/7 the buttons.
+#define DHT22_POWER_ENABLE          0
+#define DHT22_POWER_GPIO_INSTANCE   0
+#define DHT22_POWER_GPIO_PIN        10
+#define DHT22_POWER_PAD_ID          25     // GPIO10 is on PAD ID 25
+
+// Acquisition mode selection.
+// 1: edges are timestamped by the GPIO interrupt against a free-running timer and
+//    decoded after the frame, so the scheduler keeps running during the transfer.
+// 0: legacy busy-wait polling with the scheduler suspended.
+// Overridable from the command line so the host simulator (Test/) covers both.
+#ifndef DHT22_EDGE_CAPTURE_ENABLE
+#define DHT22_EDGE_CAPTURE_ENABLE   1
+#endif
+
+#define DHT22_CAPTURE_TIMER_INSTANCE 2     // Free-running timer used to timestamp edges
+#define DHT22_CAPTURE_TIMER_TICKS_US 26    // Timer ticks per microsecond (26MHz clock)
+#define DHT22_FRAME_TIMEOUT_MS       10    // A full frame takes ~5ms
+#define DHT22_MIN_PERIOD_MS          2000  // Minimum sampling period
+#define DHT22_WARMUP_MS              2000  // Stabilisation time after power-on
+// Falling (ACK low), rising (ACK high), falling (first bit) and a rising/falling pair per bit.
+#define DHT22_FRAME_EDGES            (3 + 80)
 
 // Initializes the GPIO pin for the DHT22 sensor.
 void DHT22_Init(void);
 
-// Reads temperature and humidity from the DHT22 sensor.
-int DHT22_Read(float *temperature, float *humidity);
+// Switches the DHT22 supply (no-op when DHT22_POWER_ENABLE is 0).
+void DHT22_Power(uint8_t on);
+
+// Reads temperature and humidity (in tenths) from the DHT22 sensor.
+int DHT22_Read(HT_SensorReading *reading);
+
+// DHT22 descriptor for the sensor abstraction layer (HT_Sensor.h).
+extern const HT_SensorDriver DHT22_Driver;
 
-#endif // __HT_DHT22_H__ 
\ No newline at end of file
+#endif // __HT_DHT22_H__
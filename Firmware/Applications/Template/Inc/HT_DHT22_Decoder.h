@@ -0,0 +1,41 @@
+#ifndef __HT_DHT22_DECODER_H__
+#define __HT_DHT22_DECODER_H__
+
+#include <stdint.h>
+
+// Hardware-independent DHT22 frame decoder. It only depends on <stdint.h> so the
+// same source can be built on the target and on a development host.
+
+#define DHT22_FRAME_BITS    40
+#define DHT22_FRAME_PULSES  (2 * DHT22_FRAME_BITS)   // Low/high pair per bit
+
+// Bit threshold relative to the mean low pulse (~50us): "0" highs are 26-28us and
+// "1" highs are ~70us, so the midpoint sits at ~97% of the low baseline.
+#define DHT22_BIT_THRESHOLD_NUM 97
+#define DHT22_BIT_THRESHOLD_DEN 100
+
+// DHT22 return codes, shared by the decoder and the acquisition driver
+#define DHT22_OK                    0   // Success
+#define DHT22_ERROR_TIMEOUT_START   -1  // Timeout waiting for sensor response to start
+#define DHT22_ERROR_TIMEOUT_LOW     -2  // Timeout waiting for response low pulse to end
+#define DHT22_ERROR_TIMEOUT_HIGH    -3  // Timeout waiting for response high pulse to end
+#define DHT22_ERROR_TIMEOUT_DATA    -4  // Timeout during data bit reception (truncated frame)
+#define DHT22_ERROR_CHECKSUM        -5  // Checksum mismatch
+#define DHT22_ERROR_FRAME           -6  // Pulse widths inconsistent with a DHT22 frame
+#define DHT22_ERROR                 -7  // Acquisition not initialised
+
+// Decoded frame. Values are kept in tenths as transmitted by the sensor.
+typedef struct {
+    int16_t temperature;    // Temperature in 0.1 degC
+    int16_t humidity;       // Relative humidity in 0.1 %
+    uint8_t raw[5];         // Received bytes, checksum included
+} DHT22_Frame;
+
+// Decodes low/high pulse pairs into a frame.
+// pulses: pulse widths in any consistent time unit (us, timer ticks or loop counts),
+//         starting with the low pulse of bit 0.
+// count:  number of pulses available; less than DHT22_FRAME_PULSES is a truncated frame.
+// Returns DHT22_OK, DHT22_ERROR_TIMEOUT_DATA, DHT22_ERROR_FRAME or DHT22_ERROR_CHECKSUM.
+int DHT22_DecodeFrame(const uint16_t *pulses, uint16_t count, DHT22_Frame *frame);
+
+#endif // __HT_DHT22_DECODER_H__
@@ -0,0 +1,31 @@
+#ifndef __HT_DIAG_H__
+#define __HT_DIAG_H__
+
+#include <stdint.h>
+
+// On-chip diagnostics: battery voltage and die temperature taken in one
+// batched ADC conversion per wake, completed by ADC interrupt callbacks.
+
+#define HT_DIAG_TIMEOUT_MS      50
+#define HT_DIAG_VBAT_RESDIV     ADC_VbatResDivRatio3Over16   // Keeps VBAT within the ADC input range
+#define HT_DIAG_VBAT_DIV_NUM    16
+#define HT_DIAG_VBAT_DIV_DEN    3
+#define HT_DIAG_STR_SIZE        16  // "65535,-3276.8" plus terminator
+
+#define HT_DIAG_OK              0
+#define HT_DIAG_ERROR_START     -1  // Conversion request rejected
+#define HT_DIAG_ERROR_TIMEOUT   -2  // Callbacks did not arrive in time
+#define HT_DIAG_ERROR_THERMAL   -3  // Thermal calibration (EFUSE) not available
+
+typedef struct {
+    uint16_t vbat_mv;       // Battery voltage in mV
+    int16_t die_temp;       // Die temperature in 0.1 degC
+} HT_DiagReading;
+
+// Samples VBAT and die temperature in one batch.
+int HT_Diag_Sample(HT_DiagReading *reading);
+
+// Formats a reading as "<vbat_mv>,<die_temp>" (e.g. "3712,27.5"). Returns the length.
+uint8_t HT_Diag_Format(const HT_DiagReading *reading, char *out);
+
+#endif // __HT_DIAG_H__
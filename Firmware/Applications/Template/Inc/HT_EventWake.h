@@ -0,0 +1,38 @@
+#ifndef __HT_EVENTWAKE_H__
+#define __HT_EVENTWAKE_H__
+
+#include <stdint.h>
+
+// Event-triggered wake-up.
+// An external contact (door, HVAC relay, comparator) on a wakeup pad wakes the
+// device from hibernate. That wake does a single immediate acquisition and
+// reports it together with the pad state, while the periodic deep sleep timer
+// keeps running so the regular schedule is not shifted.
+//
+// Off by default. The SDK has no pull configuration for the wakeup pads
+// (slpManSetWakeupPad only selects the edges), so a pad with nothing wired to
+// it floats and can wake the device at random, each wake forcing a radio
+// session. Enable it only once the contact circuit holds the pad at a defined
+// level, e.g. with an external pull-up or pull-down resistor.
+
+#define HT_EVENT_WAKE_ENABLE        0
+#define HT_EVENT_WAKE_PAD           0       // Wakeup pad 0..2 (only these have configurable edges)
+#define HT_EVENT_WAKE_RISING        1       // Wake on rising edge
+#define HT_EVENT_WAKE_FALLING       1       // Wake on falling edge
+#define HT_EVENT_STR_SIZE           16      // "pad,level,count" plus terminator
+
+// Enables the wakeup pad and records whether this boot was caused by it.
+// Call as early as possible after wake-up so the pad level is the one that triggered.
+void HT_EventWake_Init(void);
+
+// Non-zero when the current wake was triggered by the event pad.
+uint8_t HT_EventWake_Triggered(void);
+
+// Called from the PadN_WakeupIntHandler while awake.
+void HT_EventWake_IntHandler(uint8_t pad);
+
+// Formats the last event as "<pad>,<level>,<count>" where count is the number
+// of events since the retention memory was formatted. Returns the length.
+uint8_t HT_EventWake_Format(char *out);
+
+#endif // __HT_EVENTWAKE_H__
@@ -106,6 +106,8 @@ ________________________________________________________________________________
 #define GREEN_LED_PIN                  5                                        /**</ Green LED pin number. */
 #define GREEN_LED_PAD_ID               16                                       /**</ Green LED Pad ID. */
 
+#define HT_GPIO_IRQ_HANDLERS           4                                        /**</ GPIO interrupt users sharing PXIC_Gpio_IRQn. */
+
 /* Typedefs  ------------------------------------------------------------------*/
 
 /**
@@ -118,9 +120,30 @@ typedef enum {
     HT_GREEN_LED
 } HT_Led_Type;
 
+/**
+ * \brief GPIO interrupt handler registered with HT_GPIO_RegisterIRQHandler.
+ *        It must clear the interrupt flags of its own pins.
+ */
+typedef void (*HT_GPIO_IRQHandler)(void);
+
 extern osMessageQueueId_t btnQueue;
 /* Functions ------------------------------------------------------------------*/
 
+/*!******************************************************************
+ * \fn int HT_GPIO_RegisterIRQHandler(uint32_t instance, uint16_t mask, HT_GPIO_IRQHandler handler)
+ * \brief Registers a handler on the shared GPIO interrupt vector. The vector
+ *        is owned by a dispatcher that calls every handler whose pins have
+ *        their interrupt flag set, so several GPIO users can coexist.
+ *
+ * \param[in] uint32_t instance                         GPIO instance
+ * \param[in] uint16_t mask                             pins served by the handler
+ * \param[in] HT_GPIO_IRQHandler handler                handler to call
+ * \param[out] none
+ *
+ * \retval 0 on success, -1 when all HT_GPIO_IRQ_HANDLERS slots are taken.
+ *******************************************************************/
+int HT_GPIO_RegisterIRQHandler(uint32_t instance, uint16_t mask, HT_GPIO_IRQHandler handler);
+
 /*!******************************************************************
  * \fn void HT_GPIO_ButtonInit(void)
  * \brief Initialize blue and white buttons in the GPIO pins
@@ -0,0 +1,47 @@
+#ifndef __HT_JOURNAL_H__
+#define __HT_JOURNAL_H__
+
+#include <stdint.h>
+#include "HT_SampleRing.h"
+
+// Persistent sample journal.
+// Most wakes only sample, append one record and hibernate again without
+// touching the radio; when the reporting policy (HT_Report.h) asks for a
+// transmission the device connects once and flushes every pending record.
+// Records first go to a ring in
+// retention SRAM (HT_SampleRing.h) and are spilled to flash only when the
+// ring is full: to the raw QSPI log (HT_QLog.h), or to a file in the flash
+// file system when HT_QLOG_ENABLE is 0.
+// Appending does not commit the retention data, so a sampling-only wake writes
+// no flash at all. The retention flash copy is refreshed when the ring spills
+// and when the journal is cleared; ring records appended since then are lost on
+// a power loss, hibernate keeps them.
+
+#define HT_JOURNAL_FILE             "journal"
+#define HT_JOURNAL_MAX_RECORDS      2048    // 16KB of the file system (file backend)
+
+#define HT_JOURNAL_OK               0
+#define HT_JOURNAL_ERROR_OPEN       -1      // File could not be opened or created
+#define HT_JOURNAL_ERROR_WRITE      -2      // Short write
+#define HT_JOURNAL_ERROR_FULL       -3      // Ring full and HT_JOURNAL_MAX_RECORDS reached in the file
+
+// Appends one record. Returns HT_JOURNAL_OK or a negative error code.
+int HT_Journal_Append(const HT_SampleRecord *record);
+
+// Number of records waiting for upload, flash and ring.
+uint16_t HT_Journal_Count(void);
+
+// Reads up to count records starting at index first, oldest first (flash
+// then ring). Returns the number of records read or a negative error code.
+int HT_Journal_Read(uint16_t first, HT_SampleRecord *records, uint16_t count);
+
+// Discards every record after a successful upload.
+void HT_Journal_Clear(void);
+
+// Non-zero when this wake must connect and flush the journal regardless of
+// the reporting policy: first boot, event wake or flash journal full. With
+// retain set the raw records are kept for backfill, and a full flash log only
+// counts when it cannot overwrite its oldest records (file backend).
+uint8_t HT_Journal_UploadDue(uint8_t retain);
+
+#endif // __HT_JOURNAL_H__
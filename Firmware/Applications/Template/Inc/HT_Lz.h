@@ -0,0 +1,36 @@
+#ifndef __HT_LZ_H__
+#define __HT_LZ_H__
+
+#include <stdint.h>
+
+// Small LZSS compressor for batch payloads.
+// Matches are searched in the input already consumed, so no window buffer is
+// needed beyond the payload itself; the window is limited to HT_LZ_WINDOW bytes
+// to bound the search time. Either side can be built for the host as well.
+//
+// Format:
+//   uint8 HT_LZ_MAGIC, uint16 little endian uncompressed length
+//   groups of one control byte followed by up to 8 items, control bit 0 (LSB)
+//   first: 0 = literal byte, 1 = match of two bytes
+//     uint8 distance - 1     (1..HT_LZ_WINDOW bytes back)
+//     uint8 length - HT_LZ_MIN_MATCH
+// The magic has a high nibble of 2, which neither a delta batch (0x1_) nor a
+// CBOR batch (a map, 0xA_ or 0xBF) can start with.
+
+#define HT_LZ_MAGIC             0x20
+#define HT_LZ_HEADER_SIZE       3
+#define HT_LZ_WINDOW            256
+#define HT_LZ_MIN_MATCH         3
+#define HT_LZ_MAX_MATCH         (HT_LZ_MIN_MATCH + 255)
+
+#define HT_LZ_ERROR_FULL        -1      // Output would not be smaller than out_max
+#define HT_LZ_ERROR_FORMAT      -2      // Not a valid compressed stream
+
+// Compresses in_len bytes. Returns the compressed length or HT_LZ_ERROR_FULL,
+// in which case the input should be sent as is.
+int HT_Lz_Compress(const uint8_t *in, uint16_t in_len, uint8_t *out, uint16_t out_max);
+
+// Reverses HT_Lz_Compress. Returns the uncompressed length or a negative error code.
+int HT_Lz_Decompress(const uint8_t *in, uint16_t in_len, uint8_t *out, uint16_t out_max);
+
+#endif // __HT_LZ_H__
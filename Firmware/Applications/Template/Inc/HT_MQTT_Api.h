@@ -78,7 +78,7 @@ uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *ad
 /*!******************************************************************
  * \fn void HT_MQTT_Publish(MQTTClient *mqtt_client, char *topic, uint8_t *payload, uint32_t len, enum QoS qos, uint8_t retained, uint16_t id, uint8_t dup)
 
- * \brief Send an MQTT publish packet and wait for all acks, depending on the QoSs option.
+ * \brief Send an MQTT publish packet through the MQTT I/O task and wait for all acks, depending on the QoSs option.
  *
  * \param[in] MQTTClient *mqtt_client           MQTT client handle.
  * \param[in] char *topic                       MQTT topic publish to.
@@ -118,6 +118,17 @@ void HT_MQTT_SubscribeCallback(MessageData *msg);
  *******************************************************************/
 void HT_MQTT_Subscribe(MQTTClient *mqtt_client, char *topic, enum QoS qos);
 
+/*!******************************************************************
+ * \fn int HT_MQTT_Disconnect(MQTTClient *mqtt_client)
+
+ * \brief Send an MQTT disconnect packet and close the socket.
+ *
+ * \param[in] MQTTClient *mqtt_client           MQTT client handle.
+ *  
+ * \retval SUCCESS or FAILURE.
+ *******************************************************************/
+int HT_MQTT_Disconnect(MQTTClient *mqtt_client);
+
 #endif /* __HT_MQTT_API_H__ */
 
 /************************ HT Micron Semicondutores S.A *****END OF FILE****/
@@ -0,0 +1,84 @@
+#ifndef __HT_MQTT_TASK_H__
+#define __HT_MQTT_TASK_H__
+
+#include <stdint.h>
+#include "MQTTClient.h"
+
+// MQTT I/O task.
+// One task owns the socket of the connected client: it reads incoming packets,
+// sends the keepalive and runs the publish, subscribe and disconnect commands
+// queued by the application, reporting each result to a completion callback.
+// Between packets it blocks on its queue with a timeout that ends at the next
+// keepalive, so the CPU can stay in tickless idle.
+//
+// QoS1 publishes do not hold the task for the round trip: they go out with
+// MQTTPublishAsync and complete when their PUBACK arrives, so up to
+// MAX_INFLIGHT_MESSAGES are outstanding at once. Only a full window makes the
+// task wait for an acknowledgement. A batch command sends several publishes
+// with one network write, so the modem transmits them in a single burst.
+//
+// lwIP select() cannot wait on a queue and the loopback interface is disabled,
+// so a small watcher task blocks in select() and posts a readable event to the
+// queue. The watcher never reads or writes; it is re-armed by the I/O task once
+// the packet was handled. Before the socket is closed, or a new connection is
+// attached, the I/O task stops the watcher and waits for it to leave select(),
+// so select() never runs on a closed or reused descriptor. select() times out
+// every HT_MQTT_WATCH_POLL_MS for the watcher to see the request.
+//
+// The connection itself is opened by the caller (HT_MQTT_Connect) while the
+// task is idle, then handed over with HT_MQTT_Task_Start. Message handlers and
+// completion callbacks run in the I/O task; HT_MQTT_Task_Call made from there
+// runs the command in place.
+
+#define HT_MQTT_TASK_QUEUE_SIZE     8
+#define HT_MQTT_TASK_STACK_SIZE     (1024*4)    // Runs the subscribe handlers
+#define HT_MQTT_WATCH_STACK_SIZE    1024
+#define HT_MQTT_TASK_READ_MS        1000        // Rest of a packet once readable
+#define HT_MQTT_TASK_PING_WAIT_MS   10000       // PINGRESP before the session is dropped
+#define HT_MQTT_WATCH_POLL_MS       1000        // Longest wait for the watcher to stop
+
+#define HT_MQTT_TASK_OK             0
+#define HT_MQTT_TASK_ERROR_FULL     -1          // Command queue full
+#define HT_MQTT_TASK_ERROR_STOPPED  -2          // HT_MQTT_Task_Start never called
+
+typedef enum {
+    HT_MQTT_CMD_PUBLISH = 0,
+    HT_MQTT_CMD_PUBLISH_BATCH,
+    HT_MQTT_CMD_SUBSCRIBE,
+    HT_MQTT_CMD_DISCONNECT,
+    HT_MQTT_CMD_ATTACH,             // Internal: a new connection was handed over
+    HT_MQTT_CMD_READABLE            // Internal: posted by the watcher
+} HT_MQTT_CommandType;
+
+// Called in the I/O task with the MQTTClient return code (SUCCESS or FAILURE)
+typedef void (*HT_MQTT_Callback)(int rc, void *arg);
+
+// topic and message.payload must stay valid until the callback ran. A batch
+// completes each message through its own handler, and done once every message
+// was sent or failed; the batch array must stay valid until then.
+typedef struct {
+    HT_MQTT_CommandType type;
+    MQTTClient *client;
+    const char *topic;
+    MQTTMessage message;            // Publish only
+    enum QoS qos;                   // Subscribe only
+    messageHandler handler;         // Subscribe only
+    MQTTBatchMessage *batch;        // Batch only, QoS0 or QoS1 messages
+    uint8_t count;                  // Batch only; watcher arm number for a readable event
+    uint8_t disconnect;             // Batch only: ends with a DISCONNECT, see MQTTPublishBatch
+    HT_MQTT_Callback done;          // Optional
+    void *arg;
+} HT_MQTT_Command;
+
+// Hands a connected client over to the I/O task, creating the tasks on first use.
+int HT_MQTT_Task_Start(MQTTClient *client);
+
+// Queues a command without waiting. Returns HT_MQTT_TASK_OK or a negative error,
+// in which case the callback is not called.
+int HT_MQTT_Task_Post(const HT_MQTT_Command *cmd);
+
+// Queues a command and waits for it to complete. Returns the MQTTClient return
+// code; callers are serialised, cmd->done and cmd->arg are overwritten.
+int HT_MQTT_Task_Call(HT_MQTT_Command *cmd);
+
+#endif // __HT_MQTT_TASK_H__
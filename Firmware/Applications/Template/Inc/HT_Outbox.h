@@ -0,0 +1,67 @@
+#ifndef __HT_OUTBOX_H__
+#define __HT_OUTBOX_H__
+
+#include <stdint.h>
+
+// Persistent store-and-forward queue for outgoing messages.
+// Reports are published straight away; only the ones the broker did not
+// acknowledge (QoS1) are queued in a file of fixed-size slots, and removed once
+// a later session got their PUBACK. Every report takes a sequence number that
+// never repeats, sent as the MQTT 5 user property "seq" on the first attempt
+// and on every replay, so the consumer can drop a copy that was resent after a
+// lost PUBACK. Numbers are handed out from retention memory; the checkpoint
+// only holds a limit kept half of HT_OUTBOX_SEQ_BLOCK or more ahead, where
+// numbering resumes after a power loss.
+
+#define HT_OUTBOX_FILE              "outbox"
+#define HT_OUTBOX_SLOTS             24
+#define HT_OUTBOX_PAYLOAD_MAX       340     // Sensor statistics of HT_SENSOR_MAX sensors
+#define HT_OUTBOX_SEQ_BLOCK         64      // Sequence numbers per checkpoint
+
+#define HT_OUTBOX_OK                0
+#define HT_OUTBOX_ERROR_OPEN        -1      // File could not be opened or created
+#define HT_OUTBOX_ERROR_WRITE       -2      // Short write
+#define HT_OUTBOX_ERROR_SIZE        -3      // Payload longer than HT_OUTBOX_PAYLOAD_MAX
+#define HT_OUTBOX_ERROR_EMPTY       -4      // Nothing queued
+#define HT_OUTBOX_ERROR_CORRUPT     -5      // Slot failed its CRC check
+
+typedef struct {
+    uint32_t seq;
+    uint8_t topic;                  // Application topic index
+    uint8_t reserved;
+    uint16_t len;
+    uint16_t crc;                   // Covers the whole slot with crc set to 0
+    uint16_t reserved2;
+    uint8_t payload[HT_OUTBOX_PAYLOAD_MAX];
+} HT_OutboxMessage;
+
+// Queue position, kept in retention memory
+typedef struct {
+    uint32_t next_seq;              // 0 until the file was scanned once
+    uint32_t seq_limit;             // Numbering resumes here after a power loss
+    uint16_t first;                 // Slot of the oldest message
+    uint16_t count;
+    uint16_t dropped;               // Oldest messages overwritten while full
+    uint16_t reserved;
+} HT_OutboxState;
+
+// Takes the sequence number of a new message.
+uint32_t HT_Outbox_NextSeq(void);
+
+// Queues one message under the sequence number it was first sent with,
+// overwriting the oldest one when full. Returns HT_OUTBOX_OK or a negative
+// error code.
+int HT_Outbox_Push(uint32_t seq, uint8_t topic, const uint8_t *payload, uint16_t len);
+
+// Messages waiting for an acknowledgement.
+uint16_t HT_Outbox_Count(void);
+
+// Reads the message index places after the oldest one, so several can be in
+// flight at once. Returns HT_OUTBOX_OK or a negative error code; a corrupt
+// message must still be removed with HT_Outbox_Pop.
+int HT_Outbox_Peek(uint16_t index, HT_OutboxMessage *msg);
+
+// Removes the oldest message once it was acknowledged.
+void HT_Outbox_Pop(void);
+
+#endif // __HT_OUTBOX_H__
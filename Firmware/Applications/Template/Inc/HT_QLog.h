@@ -0,0 +1,67 @@
+#ifndef __HT_QLOG_H__
+#define __HT_QLOG_H__
+
+#include <stdint.h>
+#include "HT_SampleRing.h"  // For HT_SampleRecord
+
+// Append-only sample log written straight to the QSPI flash, bypassing the
+// file system metadata commits.
+//
+// The region is split in 4KB sectors used round-robin, so every sector is
+// erased equally often. Slot 0 of a sector holds its header (sequence number,
+// erase count, flags), slots 1..255 hold fixed 16-byte records. Headers and
+// records are programmed first and confirmed by a separate commit word, so a
+// reset in the middle of a write leaves an uncommitted slot instead of a
+// corrupt one. The log position is kept in retention memory; only after a
+// power-on reset the sector headers are scanned and the write slot found by
+// binary search, which is bounded by the region size, not the log content.
+//
+// Uploaded records are released by opening a new sector flagged as the new
+// tail. When the log wraps the oldest sector is dropped.
+//
+// littlefs is configured over the whole FLASH_FS_REGION (84 blocks), so the log
+// lives in the unassigned area between the FOTA region and the PMU backup.
+
+#define HT_QLOG_ENABLE          1
+
+#define HT_QLOG_REGION_OFFSET   0x320000    // FLASH_FOTA_REGION_END
+#define HT_QLOG_REGION_SIZE     0x10000     // 64KB
+#define HT_QLOG_SECTOR_SIZE     0x1000
+#define HT_QLOG_SECTORS         (HT_QLOG_REGION_SIZE / HT_QLOG_SECTOR_SIZE)
+#define HT_QLOG_SLOT_SIZE       16
+#define HT_QLOG_SLOTS           (HT_QLOG_SECTOR_SIZE / HT_QLOG_SLOT_SIZE)   // Header included
+#define HT_QLOG_SECTOR_RECORDS  (HT_QLOG_SLOTS - 1)
+// Records guaranteed to be kept, one sector is lost when the log wraps
+#define HT_QLOG_CAPACITY        ((HT_QLOG_SECTORS - 1) * HT_QLOG_SECTOR_RECORDS)
+
+#define HT_QLOG_OK              0
+#define HT_QLOG_ERROR_FLASH     -1      // QSPI driver error
+
+// Log position, kept in retention memory
+typedef struct {
+    uint32_t head_seq;      // Sequence number of the sector being written
+    uint32_t tail_seq;      // Sequence number of the oldest sector with pending records
+    uint16_t head_slot;     // Next free slot in the head sector
+    uint16_t tail_slot;     // First pending slot in the tail sector
+    uint8_t head;           // Physical index of the head sector
+    uint8_t valid;          // Position known, no scan needed
+    uint16_t dropped;       // Records lost to wrap-around since the last clear
+} HT_QLogState;
+
+// Restores the log position, scanning the flash after a power-on reset.
+void HT_QLog_Init(HT_QLogState *state);
+
+// Appends one record.
+int HT_QLog_Append(HT_QLogState *state, const HT_SampleRecord *record);
+
+// Number of pending records.
+uint16_t HT_QLog_Count(const HT_QLogState *state);
+
+// Reads up to count pending records starting at index first. Uncommitted
+// slots read back with both values HT_SAMPLE_NO_VALUE. Returns the number read.
+int HT_QLog_Read(const HT_QLogState *state, uint16_t first, HT_SampleRecord *records, uint16_t count);
+
+// Releases every pending record.
+int HT_QLog_Clear(HT_QLogState *state);
+
+#endif // __HT_QLOG_H__
@@ -0,0 +1,72 @@
+#ifndef __HT_REPORT_H__
+#define __HT_REPORT_H__
+
+#include <stdint.h>
+
+// Send-on-delta reporting policy.
+// A wake connects only when temperature or humidity moved past its deadband
+// since the last value actually sent, or when the heartbeat deadline since the
+// last transmission passed. Otherwise the sample is only journaled.
+//
+// A failed session (no connection, or a message left without PUBACK) postpones
+// the next attempt by HT_REPORT_BACKOFF_MIN_S, doubling per failure up to
+// HT_REPORT_BACKOFF_MAX_S, so an outage costs one attach per backoff period
+// rather than one per wake.
+//
+// Settable over the interval topic with comma separated commands:
+//   "dt=<0.1 degC>"  temperature deadband, 0 disables the temperature trigger
+//   "dh=<0.1 %RH>"   humidity deadband, 0 disables the humidity trigger
+//   "hb=DDHHMMSS"    heartbeat, maximum time without transmitting
+// e.g. "dt=5,dh=20,hb=00060000".
+
+#define HT_REPORT_DEADBAND_TEMP     5       // 0.5 degC
+#define HT_REPORT_DEADBAND_HUM      20      // 2.0 %RH
+#define HT_REPORT_HEARTBEAT_S       3600    // 1 hour
+#define HT_REPORT_HEARTBEAT_MAX_S   (580UL * 3600)  // Longest deep sleep timer
+#define HT_REPORT_BACKOFF_MIN_S     300     // 5 minutes
+#define HT_REPORT_BACKOFF_MAX_S     (6UL * 3600)
+
+#define HT_REPORT_OK                0
+#define HT_REPORT_ERROR_SYNTAX      -1      // Unknown key or malformed value
+
+typedef struct {
+    int16_t deadband_temp;      // 0.1 degC
+    int16_t deadband_hum;       // 0.1 %RH
+    uint32_t heartbeat_s;
+} HT_ReportConfig;
+
+// Kept in retention memory, the configuration lives in the config store (HT_Config.h)
+typedef struct {
+    int16_t sent_temp;          // Last transmitted values, HT_SAMPLE_NO_VALUE if none
+    int16_t sent_hum;
+    uint32_t sent_time;         // When the last transmission happened, seconds
+    uint32_t retry_time;        // No connection attempt before this time while failures != 0
+    uint8_t has_sent;           // sent_* are meaningful
+    uint8_t failures;           // Failed sessions in a row
+    uint8_t reserved[2];
+} HT_ReportState;
+
+// Fills config with the defaults above.
+void HT_Report_Defaults(HT_ReportConfig *config);
+
+// Forgets the last transmission.
+void HT_Report_Reset(HT_ReportState *state);
+
+// Non-zero when the sample must be transmitted now. Missing values never
+// trigger on their own, the heartbeat covers a silent sensor.
+uint8_t HT_Report_Due(const HT_ReportConfig *config, const HT_ReportState *state, int16_t temperature, int16_t humidity, uint32_t now);
+
+// Records a successful transmission.
+void HT_Report_Sent(HT_ReportState *state, int16_t temperature, int16_t humidity, uint32_t now);
+
+// Records a failed session, moving the next attempt back.
+void HT_Report_Failed(HT_ReportState *state, uint32_t now);
+
+// Non-zero while connection attempts are postponed after a failure.
+uint8_t HT_Report_BackingOff(const HT_ReportState *state, uint32_t now);
+
+// Applies "key=value[,key=value...]" commands to config. Nothing is changed
+// unless the whole payload is valid. Returns HT_REPORT_OK or HT_REPORT_ERROR_SYNTAX.
+int HT_Report_Configure(HT_ReportConfig *config, const uint8_t *payload, uint8_t len);
+
+#endif // __HT_REPORT_H__
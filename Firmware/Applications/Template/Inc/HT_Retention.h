@@ -0,0 +1,72 @@
+#ifndef __HT_RETENTION_H__
+#define __HT_RETENTION_H__
+
+#include <stdint.h>
+#include "HT_Sensor.h"
+#include "HT_SampleRing.h"
+#include "HT_Report.h"
+#include "HT_QLog.h"
+#include "HT_Config.h"
+#include "HT_Outbox.h"
+#include "HT_Time.h"
+#include "HT_Aggregate.h"
+
+// Application state kept in the user NV area (UNLOAD_DRAM_USRNV). The SDK keeps
+// it in retention SRAM through hibernate and restores it from flash at power-on,
+// so the flash copy only needs refreshing at checkpoints; state changed since
+// the last one falls back to the checkpoint after a power loss.
+
+#define HT_RETENTION_MAGIC      0x53434C4DUL    // "SCLM"
+#define HT_RETENTION_VERSION    12
+#define HT_RETENTION_MAX_SIZE   1024            // UNLOAD_DRAM_USRNV length in the linker script
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+
+    // Sensor supply
+    uint32_t sensor_power_on;       // 8Hz continuous counter when the sensor supply came up
+    uint8_t sensor_powered;         // Supply is known to be on
+    uint8_t reserved0[3];
+
+    // Sensor read statistics, indexed by registry slot
+    HT_SensorStats sensor_stats[HT_SENSOR_MAX];
+
+    // Wakeup pad events
+    uint16_t event_count;           // Events since the retention area was formatted
+    uint8_t event_level;            // Pad level when the last event woke the device
+    uint8_t reserved1;
+
+    // Network time mapping of the hibernate counter
+    HT_TimeState time;
+
+    // Configuration store, see HT_Config.h
+    HT_ConfigState config;
+
+    // Reporting policy
+    HT_ReportState report;
+
+    // Sample journal
+    HT_SampleRing sample_ring;      // Records not yet spilled to the flash journal
+    HT_QLogState qlog;              // Flash journal position
+
+    // Messages waiting for a broker acknowledgement
+    HT_OutboxState outbox;
+
+    // Summary window being accumulated
+    HT_AggState aggregate;
+} HT_RetentionData;
+
+// Compile-time guard against outgrowing the retention area
+typedef char HT_RetentionSizeCheck[(sizeof(HT_RetentionData) <= HT_RETENTION_MAX_SIZE) ? 1 : -1];
+
+// Returns the retention data, formatting it on first use or after a layout change.
+HT_RetentionData *HT_Retention_Get(void);
+
+// Checkpoint: marks the retention data as modified so the SDK also writes it to
+// flash before the next sleep. Not needed for hibernate itself, so avoid it on
+// the per-wake sampling path.
+void HT_Retention_Commit(void);
+
+#endif // __HT_RETENTION_H__
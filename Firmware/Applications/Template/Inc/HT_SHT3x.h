@@ -0,0 +1,25 @@
+#ifndef __HT_SHT3X_H__
+#define __HT_SHT3X_H__
+
+#include <stdint.h>
+#include "HT_Sensor.h"
+
+// Sensirion SHT3x temperature/humidity sensor on I2C1 (PAD 15 SDA / PAD 16 SCL).
+// Disabled by default: those pads are shared with UART0 (unilog).
+#define SHT3X_ENABLE            0
+
+#define SHT3X_I2C_ADDR          0x44    // ADDR pin low, 0x45 when high
+#define SHT3X_CMD_MEASURE_HIGH  0x2400  // Single shot, high repeatability, no clock stretching
+#define SHT3X_CMD_SOFT_RESET    0x30A2
+#define SHT3X_CONVERSION_MS     16      // Max 15.5ms for high repeatability
+#define SHT3X_MIN_PERIOD_MS     100
+#define SHT3X_WARMUP_MS         2       // Power-up time, max 1.5ms
+#define SHT3X_I2C_TIMEOUT_MS    10      // Bound on one transfer, 6 bytes take ~0.2ms at 400kHz
+
+#define SHT3X_ERROR_I2C         -1      // Address NACK or bus error: no answer
+#define SHT3X_ERROR_TIMEOUT     -2      // Transfer stalled or cut part-way (timeout class)
+#define SHT3X_ERROR_CRC         -5      // CRC mismatch on the received words (integrity class, see HT_Sensor.h)
+
+extern const HT_SensorDriver SHT3x_Driver;
+
+#endif // __HT_SHT3X_H__
@@ -0,0 +1,51 @@
+#ifndef __HT_SAMPLERING_H__
+#define __HT_SAMPLERING_H__
+
+#include <stdint.h>
+
+// Ring of timestamped samples meant to live in retention SRAM, so batching
+// across hibernate cycles costs no flash writes: pushes are not committed to
+// flash, only the journal checkpoints are. A generation counter and a CRC over
+// the header and the stored records detect a ring that did not survive
+// (brown-out, layout change) instead of uploading garbage.
+
+#define HT_RING_RECORDS         96          // 768 bytes of records
+#define HT_SAMPLE_NO_VALUE      INT16_MIN   // Stored when no sensor produced a reading
+
+#define HT_RING_OK              0
+#define HT_RING_ERROR_FULL      -1
+
+typedef struct {
+    uint32_t time;          // Sample time in seconds
+    int16_t temperature;    // 0.1 degC or HT_SAMPLE_NO_VALUE
+    int16_t humidity;       // 0.1 %RH or HT_SAMPLE_NO_VALUE
+} HT_SampleRecord;
+
+typedef struct {
+    uint32_t generation;    // Incremented on every change
+    uint16_t head;          // Index of the oldest record
+    uint16_t count;         // Records stored
+    uint16_t crc;           // CRC-16/CCITT of generation, head, count and the stored records
+    uint16_t reserved;
+    HT_SampleRecord records[HT_RING_RECORDS];
+} HT_SampleRing;
+
+// CRC-16/CCITT update over len bytes, start with 0xFFFF.
+uint16_t HT_Ring_Crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+
+// Empties the ring, keeping the generation counter running.
+void HT_Ring_Reset(HT_SampleRing *ring);
+
+// Non-zero when the header is consistent and the CRC matches.
+uint8_t HT_Ring_IsValid(const HT_SampleRing *ring);
+
+// Appends a record. Returns HT_RING_OK or HT_RING_ERROR_FULL.
+int HT_Ring_Push(HT_SampleRing *ring, const HT_SampleRecord *record);
+
+// Copies up to n records starting at the first-th oldest. Returns the number copied.
+uint16_t HT_Ring_Read(const HT_SampleRing *ring, uint16_t first, HT_SampleRecord *out, uint16_t n);
+
+// Discards the n oldest records.
+void HT_Ring_Drop(HT_SampleRing *ring, uint16_t n);
+
+#endif // __HT_SAMPLERING_H__
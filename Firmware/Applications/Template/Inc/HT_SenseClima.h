@@ -45,11 +45,28 @@
 #include "HT_GPIO_Api.h"
 #include "cmsis_os2.h"
 #include "MQTTClient.h"
+#include "HT_MQTT_Task.h"
+#include "HT_SensorAcq.h"
+#include "HT_Diag.h"
+#include "HT_SensorRetry.h"
+#include "HT_Retention.h"
+#include "HT_EventWake.h"
+#include "HT_Journal.h"
+#include "HT_BatchCodec.h"
+#include "HT_Lz.h"
+#include "HT_Report.h"
+#include "HT_Config.h"
+#include "HT_Outbox.h"
+#include "HT_Time.h"
+#include "HT_Aggregate.h"
+#include "hibtimer_qcx212.h"
 
 /* Defines  ------------------------------------------------------------------*/
 #define LED_TASK_STACK_SIZE  (1024*4) 
 #define HT_MQTT_KEEP_ALIVE_INTERVAL 240                   /**</ Keep alive interval in ms. */
-#define HT_MQTT_VERSION 4                                 /**</ MQTT protocol version. */
+#define HT_MQTT_VERSION 5                                 /**</ MQTT protocol version, 5 sends topic aliases. */
+#define HT_MQTT_SESSION_EXPIRY 86400                      /**</ MQTT 5 session kept by the broker after a disconnection, in s. */
+#define HT_MQTT_RECEIVE_MAXIMUM 2                         /**</ MQTT 5 QoS1 messages the broker may send us unacknowledged. */
 
 #if MQTT_TLS_ENABLE == 1
 #define HT_MQTT_PORT   8883                               /**</ MQTT TCP TLS port. */
@@ -60,7 +77,10 @@
 #define HT_MQTT_SEND_TIMEOUT 60000                        /**</ MQTT TX timeout. */
 #define HT_MQTT_RECEIVE_TIMEOUT   60000                   /**</ MQTT RX timeout. */
 #define HT_MQTT_BUFFER_SIZE 1024                          /**</ Maximum MQTT buffer size. */
+#define HT_MQTT_SEND_BUFFER_SIZE 512                      /**</ MQTT TX buffer, publish payloads are written from their own buffer. */
 #define HT_SUBSCRIBE_BUFF_SIZE  6                         /**</ Maximum buffer size to received from MQTT subscribe. */
+#define HT_BATCH_UPLINK_FORMAT  HT_BATCH_FORMAT_DELTA     /**</ Journal upload encoding, see HT_BatchCodec.h. */
+#define HT_MQTT_CONNECT_ATTEMPTS 3                        /**</ Connection attempts before hibernating with the outbox queued. */
 
 /* Typedefs  ------------------------------------------------------------------*/
 
@@ -111,6 +131,19 @@ void HT_FSM_SetSubscribeBuff(uint8_t *buff, uint8_t payload_len);
 void interval_manager(uint8_t *payload, uint8_t payload_len, 
     uint8_t *topic, uint8_t topic_len);
 
+/*!******************************************************************
+ * \fn void HT_SampleWake(void)
+ * \brief Acquires one reading and appends it to the sample journal. Returns
+ *        when the reading must be transmitted (reporting policy, first
+ *        boot, event wake), otherwise hibernates again without using the radio.
+ *
+ * \param[in]  none
+ * \param[out] none
+ *
+ * \retval none
+ *******************************************************************/
+void HT_SampleWake(void);
+
 /*!******************************************************************
  * \fn void HT_Fsm(void)
  * \brief Finite State Machine of Push Button Example. Connect to
@@ -0,0 +1,97 @@
+#ifndef __HT_SENSOR_H__
+#define __HT_SENSOR_H__
+
+#include <stdint.h>
+
+// Sensor readings are carried end-to-end as signed tenths of a unit, so the
+// Cortex-M3 (no FPU) never touches soft-float or printf on the sampling path.
+
+#define HT_SENSOR_DECI_STR_SIZE  8   // "-3276.8" plus terminator
+#define HT_SENSOR_MAX            4   // Maximum number of registered sensors
+
+// Capability flags
+#define HT_SENSOR_CAP_TEMPERATURE   (1 << 0)  // Reports temperature
+#define HT_SENSOR_CAP_HUMIDITY      (1 << 1)  // Reports humidity
+#define HT_SENSOR_CAP_TRIGGERED     (1 << 2)  // Conversion is started by trigger() and collected by read()
+#define HT_SENSOR_CAP_POWER         (1 << 3)  // Supply can be switched by power()
+
+#define HT_SENSOR_OK                0
+#define HT_SENSOR_ERROR_ABSENT      -20       // Sensor did not answer during init
+
+// Driver read() error codes follow a common classification so the retry policy
+// (HT_SensorRetry.h) works for every sensor:
+//   -1      the sensor did not answer at all
+//   -2..-4  the transfer started but timed out part-way
+//   others  data integrity errors (checksum, framing)
+#define HT_SENSOR_ERROR_NO_RESPONSE     -1
+#define HT_SENSOR_ERROR_TIMEOUT_LAST    -4
+
+#define HT_SENSOR_ERROR_SLOTS       8         // errors[n] counts code -n, errors[0] any other code
+
+typedef struct {
+    int16_t temperature;    // Temperature in 0.1 degC
+    int16_t humidity;       // Relative humidity in 0.1 %
+} HT_SensorReading;
+
+// Read statistics, counters saturate at 0xFFFF.
+typedef struct {
+    uint16_t reads;                             // Read attempts
+    uint16_t errors[HT_SENSOR_ERROR_SLOTS];     // Failed reads per error code
+    uint16_t dead;                              // Acquisitions abandoned for lack of response
+} HT_SensorStats;
+
+// Sensor driver descriptor. Unsupported operations are left NULL.
+typedef struct {
+    const char *name;
+    uint8_t caps;                               // HT_SENSOR_CAP_* flags
+    uint16_t conversion_ms;                     // Delay between trigger() and read()
+    uint16_t min_period_ms;                     // Minimum time between two samples
+    uint16_t warmup_ms;                         // Stabilisation time after power-on
+    int (*init)(void);                          // Returns HT_SENSOR_OK when the sensor is present
+    int (*trigger)(void);                       // Starts a conversion
+    int (*read)(HT_SensorReading *reading);     // Collects the reading, 0 on success
+    void (*power)(uint8_t on);                  // Switches the sensor supply
+} HT_SensorDriver;
+
+// Formats a value in tenths as a decimal string ("27.8", "-0.5").
+// out must hold at least HT_SENSOR_DECI_STR_SIZE bytes. Returns the string length.
+uint8_t HT_Sensor_FormatDeci(int16_t value, char *out);
+
+// Formats an unsigned integer in decimal. out must hold at least 11 bytes.
+// Returns the string length.
+uint8_t HT_Sensor_FormatUInt(uint32_t value, char *out);
+
+// Initializes every registered sensor and keeps the ones that answered.
+// Returns the number of sensors available.
+uint8_t HT_Sensor_InitAll(void);
+
+// Number of sensors available after HT_Sensor_InitAll.
+uint8_t HT_Sensor_Count(void);
+
+// Descriptor of the idx-th available sensor.
+const HT_SensorDriver *HT_Sensor_Get(uint8_t idx);
+
+// Samples the sensors selected in mask (bit n = sensor n) in one batch: every
+// triggered sensor is started first, a single wait covers the slowest
+// conversion, then all of them are read. status[n] receives each read result.
+void HT_Sensor_SampleAll(uint8_t mask, HT_SensorReading *readings, int *status);
+
+// Minimum sampling period among the sensors selected in mask.
+uint16_t HT_Sensor_MinPeriod(uint8_t mask);
+
+// Lifetime read statistics of the idx-th available sensor, kept in retention
+// memory under the sensor's registry slot so they survive hibernate.
+HT_SensorStats *HT_Sensor_GetStats(uint8_t idx);
+
+// Switches the sensor supplies on and records the power-on time in retention
+// memory. Call as early as possible after wake-up so warm-up is under way by the
+// time the sensors are first read.
+void HT_Sensor_PowerOn(void);
+
+// Switches the sensor supplies off before sleeping.
+void HT_Sensor_PowerOff(void);
+
+// Blocks until the slowest registered sensor finished its warm-up.
+void HT_Sensor_WaitReady(void);
+
+#endif // __HT_SENSOR_H__
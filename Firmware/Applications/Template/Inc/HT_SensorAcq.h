@@ -0,0 +1,43 @@
+#ifndef __HT_SENSORACQ_H__
+#define __HT_SENSORACQ_H__
+
+#include <stdint.h>
+
+// Convergence-based multi-sample acquisition.
+// Samples are added one at a time; acquisition stops as soon as the last
+// HT_ACQ_WINDOW readings agree within the configured tolerance, and the
+// reported value is a robust average of that window instead of the last read.
+
+#define HT_ACQ_WINDOW            3      // Consecutive readings that must agree
+#define HT_ACQ_MAX_SAMPLES       6      // Stop and report after this many good readings
+#define HT_ACQ_MAX_ATTEMPTS      10     // Give up after this many reads (good or bad)
+#define HT_ACQ_TEMP_TOLERANCE    3      // Max spread in the window, 0.1 degC
+#define HT_ACQ_HUM_TOLERANCE     10     // Max spread in the window, 0.1 %RH
+#define HT_ACQ_REDUCE_MEDIAN     1      // 1: median of the window, 0: mean without min/max
+
+typedef enum {
+    HT_ACQ_PENDING = 0,     // Need more readings
+    HT_ACQ_CONVERGED,       // Window agrees within tolerance
+    HT_ACQ_SATURATED,       // HT_ACQ_MAX_SAMPLES reached without converging
+    HT_ACQ_FAILED           // HT_ACQ_MAX_ATTEMPTS reached without enough readings
+} HT_AcqStatus;
+
+typedef struct {
+    int16_t temperature[HT_ACQ_MAX_SAMPLES];    // 0.1 degC
+    int16_t humidity[HT_ACQ_MAX_SAMPLES];       // 0.1 %RH
+    uint8_t count;                              // Good readings stored
+    uint8_t attempts;                           // Reads performed, including failures
+} HT_Acq;
+
+// Clears all stored readings.
+void HT_Acq_Reset(HT_Acq *acq);
+
+// Accounts for one read attempt. ok is zero when the sensor read failed, in
+// which case temperature/humidity are ignored.
+HT_AcqStatus HT_Acq_AddSample(HT_Acq *acq, uint8_t ok, int16_t temperature, int16_t humidity);
+
+// Reduces the readings to a single value. Uses the last HT_ACQ_WINDOW readings
+// when converged, otherwise every stored reading. Returns 0 if nothing was stored.
+uint8_t HT_Acq_GetResult(const HT_Acq *acq, int16_t *temperature, int16_t *humidity);
+
+#endif // __HT_SENSORACQ_H__
@@ -0,0 +1,39 @@
+#ifndef __HT_SENSORRETRY_H__
+#define __HT_SENSORRETRY_H__
+
+#include <stdint.h>
+#include "HT_Sensor.h"
+
+// Retry policy for sensor reads.
+// Every read result is counted per error code in the sensor statistics, then
+// the failure class (see HT_Sensor.h) decides how long to wait before the next
+// attempt or whether to stop trying during this wake:
+//   - no response: the sensor is considered dead after HT_RETRY_DEAD_LIMIT in a row;
+//   - timeout: the wait doubles from the sensor minimum period up to
+//     HT_RETRY_BACKOFF_MAX_MS, giving up after HT_RETRY_TIMEOUT_LIMIT in a row;
+//   - integrity errors and successes: retry at the minimum period.
+
+#define HT_RETRY_DEAD_LIMIT         2       // Consecutive no-response reads before giving up
+#define HT_RETRY_TIMEOUT_LIMIT      4       // Consecutive timeouts before giving up
+#define HT_RETRY_BACKOFF_MAX_MS     8000    // Backoff ceiling
+#define HT_RETRY_GIVE_UP            0xFFFF  // Returned instead of a delay when the sensor is abandoned
+#define HT_RETRY_STATS_STR_SIZE     80      // "name:reads,e0..e7,dead" plus terminator
+
+typedef struct {
+    uint8_t no_response;    // Consecutive reads without any answer
+    uint8_t timeouts;       // Consecutive reads that timed out part-way
+} HT_Retry;
+
+// Clears the consecutive failure counters, call once per acquisition.
+void HT_Retry_Reset(HT_Retry *retry);
+
+// Accounts for one read result and returns the delay in ms before the next
+// attempt, or HT_RETRY_GIVE_UP. stats may be NULL.
+uint16_t HT_Retry_Next(HT_Retry *retry, HT_SensorStats *stats, int status, uint16_t min_period_ms);
+
+// Formats the statistics as "name:reads,e0,e1,...,e7,dead" where en counts
+// error code -n and e0 any other code. out must hold HT_RETRY_STATS_STR_SIZE
+// bytes. Returns the string length.
+uint8_t HT_Retry_FormatStats(const char *name, const HT_SensorStats *stats, char *out);
+
+#endif // __HT_SENSORRETRY_H__
@@ -0,0 +1,47 @@
+#ifndef __HT_TIME_H__
+#define __HT_TIME_H__
+
+#include <stdint.h>
+
+// Wall-clock time kept across hibernate.
+// When the radio is up, UTC is taken from the network (NITZ through
+// appGetSystemTimeUtcSync, or SNTP when the network sends no time). Between
+// syncs, time is extrapolated from the 8Hz hibernate counter, which keeps
+// counting through hibernate. Every resync measures how far the counter drifted
+// and folds it into a ppm correction, so samples stay within about a second of
+// UTC without waking the radio just to learn the time.
+//
+// Before the first sync after power-on, timestamps are device seconds (below
+// HT_TIME_UTC_MIN) and are converted to UTC at upload time by HT_Time_Resolve.
+
+#define HT_TIME_SNTP_ENABLE         1
+#define HT_TIME_SNTP_SERVER         "pool.ntp.org"
+#define HT_TIME_HZ                  8               // timerlist_hib_get_8HZcounter rate
+#define HT_TIME_UTC_MIN             1577836800UL    // 2020-01-01, older network times are rejected
+#define HT_TIME_DRIFT_MIN_S         3600            // Shortest sync interval used to measure drift
+#define HT_TIME_DRIFT_MAX_PPM       500             // Correction limit, beyond that the sync is distrusted
+
+#define HT_TIME_OK                  0
+#define HT_TIME_ERROR_UNAVAILABLE   -1              // No network time yet, SNTP requested
+
+// Kept in retention memory
+typedef struct {
+    uint32_t sync_utc;              // UTC seconds at the last sync
+    uint32_t sync_ticks;            // 8Hz counter at the start of that second
+    int32_t drift_ppm;              // Counter rate correction
+    uint8_t synced;                 // sync_* belong to this power cycle
+    uint8_t reserved[3];
+} HT_TimeState;
+
+// UTC seconds when synced since power-on, device seconds otherwise.
+uint32_t HT_Time_Now(void);
+
+// Converts a device seconds timestamp of this power cycle to UTC once synced.
+// UTC timestamps are returned unchanged.
+uint32_t HT_Time_Resolve(uint32_t time);
+
+// Takes the network time and updates the drift correction. Call with the radio
+// attached. Returns HT_TIME_OK or HT_TIME_ERROR_UNAVAILABLE.
+int HT_Time_Sync(void);
+
+#endif // __HT_TIME_H__
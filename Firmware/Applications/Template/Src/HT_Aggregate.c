@@ -0,0 +1,134 @@
+#include <string.h>
+#include "HT_Aggregate.h"
+#include "HT_Sensor.h"      // For HT_Sensor_FormatDeci
+#include "HT_SampleRing.h"  // For HT_SAMPLE_NO_VALUE
+
+static void HT_Agg_ResetChannel(HT_AggChannel *ch) {
+    ch->sum_sq = 0;
+    ch->sum = 0;
+    ch->count = 0;
+    ch->min = INT16_MAX;
+    ch->max = INT16_MIN;
+}
+
+static void HT_Agg_AddChannel(HT_AggChannel *ch, int16_t value) {
+    if (value == HT_SAMPLE_NO_VALUE || ch->count == UINT16_MAX)
+        return;
+
+    ch->sum += value;
+    ch->sum_sq += (int32_t)value * value;
+    ch->count++;
+
+    if (value < ch->min)
+        ch->min = value;
+    if (value > ch->max)
+        ch->max = value;
+}
+
+static uint32_t HT_Agg_Sqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+// Mean rounded to 0.1, half away from zero
+static int16_t HT_Agg_Mean(const HT_AggChannel *ch) {
+    int32_t n = ch->count;
+
+    return (int16_t)((ch->sum >= 0) ? (2 * ch->sum + n) / (2 * n) : (2 * ch->sum - n) / (2 * n));
+}
+
+// Population standard deviation rounded to 0.1, from n*sum_sq - sum^2 which is exact
+static int16_t HT_Agg_StdDev(const HT_AggChannel *ch) {
+    uint64_t n = ch->count;
+    int64_t spread = (int64_t)n * ch->sum_sq - (int64_t)ch->sum * ch->sum;
+    uint64_t root;
+
+    if (spread <= 0)
+        return 0;
+
+    // sqrt(spread) / n in 0.01 units, then rounded to 0.1. A full window of
+    // extreme values overflows spread * 100; its root is scaled instead, which
+    // only loses what lies below 0.01 units.
+    if ((uint64_t)spread <= UINT64_MAX / 100)
+        root = HT_Agg_Sqrt((uint64_t)spread * 100);
+    else
+        root = (uint64_t)HT_Agg_Sqrt((uint64_t)spread) * 10;
+
+    return (int16_t)((root / n + 5) / 10);
+}
+
+static uint8_t HT_Agg_FormatChannel(const HT_AggChannel *ch, char *out) {
+    uint8_t len = HT_Sensor_FormatUInt(ch->count, out);
+
+    if (ch->count == 0)
+        return len;
+
+    out[len++] = ',';
+    len += HT_Sensor_FormatDeci(ch->min, &out[len]);
+    out[len++] = ',';
+    len += HT_Sensor_FormatDeci(ch->max, &out[len]);
+    out[len++] = ',';
+    len += HT_Sensor_FormatDeci(HT_Agg_Mean(ch), &out[len]);
+    out[len++] = ',';
+    len += HT_Sensor_FormatDeci(HT_Agg_StdDev(ch), &out[len]);
+
+    return len;
+}
+
+void HT_Agg_Reset(HT_AggState *state) {
+    state->start = 0;
+    HT_Agg_ResetChannel(&state->temperature);
+    HT_Agg_ResetChannel(&state->humidity);
+}
+
+uint8_t HT_Agg_Add(HT_AggState *state, uint32_t window_s, uint32_t now,
+                   int16_t temperature, int16_t humidity, HT_AggState *closed) {
+    uint8_t has_data = state->temperature.count || state->humidity.count;
+    uint8_t ret = 0;
+
+    // Also closes a window left behind by a clock step, e.g. the first network time
+    if (has_data && (now - state->start >= window_s || now < state->start)) {
+        *closed = *state;
+        ret = 1;
+        has_data = 0;
+    }
+
+    if (!has_data) {
+        HT_Agg_Reset(state);
+        state->start = now - now % window_s;
+    }
+
+    HT_Agg_AddChannel(&state->temperature, temperature);
+    HT_Agg_AddChannel(&state->humidity, humidity);
+
+    return ret;
+}
+
+uint8_t HT_Agg_Format(const HT_AggState *window, uint32_t start, uint32_t window_s, char *out) {
+    uint8_t len = HT_Sensor_FormatUInt(start, out);
+
+    out[len++] = ',';
+    len += HT_Sensor_FormatUInt(window_s, &out[len]);
+    out[len++] = ',';
+    len += HT_Agg_FormatChannel(&window->temperature, &out[len]);
+    out[len++] = ',';
+    len += HT_Agg_FormatChannel(&window->humidity, &out[len]);
+    out[len] = '\0';
+
+    return len;
+}
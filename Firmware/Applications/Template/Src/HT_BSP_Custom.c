@@ -21,6 +21,7 @@
 #include "debug_log.h"
 #include "unilog_qcx212.h"
 #include "HT_usart_unilog.h"
+#include "HT_EventWake.h"
 
 void GPR_SetUartClk(void) {
     GPR_ClockDisable(GPR_UART0FuncClk);
@@ -70,31 +71,43 @@ void BSP_CustomInit(void) {
 void Pad0_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup0_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(0);
 }
 
 void Pad1_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup1_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(1);
 }
 
 void Pad2_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup2_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(2);
 }
 
 void Pad3_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup3_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(3);
 }
 
 void Pad4_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup4_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(4);
 }
 
 void Pad5_WakeupIntHandler(void) {
     if(slpManExtIntPreProcess(PadWakeup5_IRQn)==false)
         return;
+
+    HT_EventWake_IntHandler(5);
 }
 
 /************************ HT Micron Semicondutores S.A *****END OF FILE****/
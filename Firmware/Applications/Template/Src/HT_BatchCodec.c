@@ -0,0 +1,162 @@
+#include "HT_BatchCodec.h"
+
+// CBOR major types
+#define CBOR_UINT       0x00
+#define CBOR_NINT       0x20
+#define CBOR_TEXT       0x60
+#define CBOR_ARRAY      0x80
+#define CBOR_MAP        0xA0
+#define CBOR_NULL       0xF6
+#define CBOR_ARRAY_INDEF 0x9F
+#define CBOR_BREAK      0xFF
+
+static uint32_t HT_Batch_ZigZag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static void HT_Batch_Varint(HT_BatchEncoder *enc, uint32_t value) {
+    while (value >= 0x80) {
+        enc->buf[enc->len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    enc->buf[enc->len++] = (uint8_t)value;
+}
+
+static uint32_t HT_Batch_ValueCode(int16_t value, int16_t *prev) {
+    uint32_t code;
+
+    if (value == HT_SAMPLE_NO_VALUE)
+        return 0;
+
+    code = HT_Batch_ZigZag((int32_t)value - *prev) + 1;
+    *prev = value;
+
+    return code;
+}
+
+static void HT_Batch_CborHead(HT_BatchEncoder *enc, uint8_t major, uint32_t value) {
+    if (value < 24) {
+        enc->buf[enc->len++] = major | (uint8_t)value;
+    } else if (value <= 0xFF) {
+        enc->buf[enc->len++] = major | 24;
+        enc->buf[enc->len++] = (uint8_t)value;
+    } else if (value <= 0xFFFF) {
+        enc->buf[enc->len++] = major | 25;
+        enc->buf[enc->len++] = (uint8_t)(value >> 8);
+        enc->buf[enc->len++] = (uint8_t)value;
+    } else {
+        enc->buf[enc->len++] = major | 26;
+        enc->buf[enc->len++] = (uint8_t)(value >> 24);
+        enc->buf[enc->len++] = (uint8_t)(value >> 16);
+        enc->buf[enc->len++] = (uint8_t)(value >> 8);
+        enc->buf[enc->len++] = (uint8_t)value;
+    }
+}
+
+static void HT_Batch_CborInt(HT_BatchEncoder *enc, int32_t value) {
+    if (value < 0)
+        HT_Batch_CborHead(enc, CBOR_NINT, (uint32_t)(-(value + 1)));
+    else
+        HT_Batch_CborHead(enc, CBOR_UINT, (uint32_t)value);
+}
+
+static void HT_Batch_CborKey(HT_BatchEncoder *enc, const char *key) {
+    uint8_t n = 0;
+
+    while (key[n])
+        n++;
+
+    HT_Batch_CborHead(enc, CBOR_TEXT, n);
+    for (uint8_t i = 0; i < n; ++i)
+        enc->buf[enc->len++] = (uint8_t)key[i];
+}
+
+static void HT_Batch_CborValue(HT_BatchEncoder *enc, int16_t value) {
+    if (value == HT_SAMPLE_NO_VALUE)
+        enc->buf[enc->len++] = CBOR_NULL;
+    else
+        HT_Batch_CborInt(enc, value);
+}
+
+int HT_Batch_Begin(HT_BatchEncoder *enc, uint8_t format, uint8_t *buf, uint16_t size,
+                   uint32_t base_time, uint16_t interval, const HT_BatchExtra *extra) {
+    uint8_t flags = extra ? extra->flags : 0;
+
+    if (format != HT_BATCH_FORMAT_DELTA && format != HT_BATCH_FORMAT_CBOR)
+        return HT_BATCH_ERROR_FORMAT;
+
+    if (size < HT_BATCH_HEADER_MAX + HT_BATCH_SAMPLE_MAX + 1)
+        return HT_BATCH_ERROR_FULL;
+
+    enc->buf = buf;
+    enc->size = size;
+    enc->len = 0;
+    enc->format = format;
+    enc->interval = interval;
+    enc->count = 0;
+    // The first sample is expected exactly at base_time
+    enc->prev_time = base_time - interval;
+    enc->prev_temperature = 0;
+    enc->prev_humidity = 0;
+
+    if (format == HT_BATCH_FORMAT_DELTA) {
+        enc->buf[enc->len++] = HT_BATCH_VERSION | flags;
+        HT_Batch_Varint(enc, base_time);
+        HT_Batch_Varint(enc, interval);
+        if (flags & HT_BATCH_FLAG_VBAT)
+            HT_Batch_Varint(enc, extra->vbat_mv);
+        if (flags & HT_BATCH_FLAG_RSSI)
+            HT_Batch_Varint(enc, extra->rssi);
+    } else {
+        HT_Batch_CborHead(enc, CBOR_MAP, 3 + ((flags & HT_BATCH_FLAG_VBAT) ? 1 : 0) + ((flags & HT_BATCH_FLAG_RSSI) ? 1 : 0));
+        HT_Batch_CborKey(enc, "t0");
+        HT_Batch_CborHead(enc, CBOR_UINT, base_time);
+        HT_Batch_CborKey(enc, "dt");
+        HT_Batch_CborHead(enc, CBOR_UINT, interval);
+        if (flags & HT_BATCH_FLAG_VBAT) {
+            HT_Batch_CborKey(enc, "vbat");
+            HT_Batch_CborHead(enc, CBOR_UINT, extra->vbat_mv);
+        }
+        if (flags & HT_BATCH_FLAG_RSSI) {
+            HT_Batch_CborKey(enc, "rssi");
+            HT_Batch_CborHead(enc, CBOR_UINT, extra->rssi);
+        }
+        HT_Batch_CborKey(enc, "s");
+        enc->buf[enc->len++] = CBOR_ARRAY_INDEF;
+    }
+
+    return HT_BATCH_OK;
+}
+
+int HT_Batch_Add(HT_BatchEncoder *enc, const HT_SampleRecord *record) {
+    int32_t deviation;
+
+    // Room for the worst case sample and the CBOR break
+    if (enc->len + HT_BATCH_SAMPLE_MAX + 1 > enc->size)
+        return HT_BATCH_ERROR_FULL;
+
+    deviation = (int32_t)(record->time - (enc->prev_time + enc->interval));
+    enc->prev_time = record->time;
+
+    if (enc->format == HT_BATCH_FORMAT_DELTA) {
+        HT_Batch_Varint(enc, HT_Batch_ZigZag(deviation));
+        HT_Batch_Varint(enc, HT_Batch_ValueCode(record->temperature, &enc->prev_temperature));
+        HT_Batch_Varint(enc, HT_Batch_ValueCode(record->humidity, &enc->prev_humidity));
+    } else {
+        HT_Batch_CborHead(enc, CBOR_ARRAY, 3);
+        HT_Batch_CborInt(enc, deviation);
+        HT_Batch_CborValue(enc, record->temperature);
+        HT_Batch_CborValue(enc, record->humidity);
+    }
+
+    enc->count++;
+
+    return HT_BATCH_OK;
+}
+
+uint16_t HT_Batch_End(HT_BatchEncoder *enc) {
+    if (enc->format == HT_BATCH_FORMAT_CBOR)
+        enc->buf[enc->len++] = CBOR_BREAK;
+
+    return enc->len;
+}
@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <string.h>
+#include "HT_Config.h"
+#include "HT_Retention.h"
+#include "HT_Aggregate.h"
+#include "HT_SampleRing.h"  // For HT_Ring_Crc16
+#include "osasys.h"
+
+// File layout, little endian:
+//   magic(4) format(1) count(1) length(2) seq(4) crc(2)
+//   count records of key(1) len(1) value(len)
+// crc covers everything but itself.
+#define HT_CONFIG_HEADER_SIZE   14
+#define HT_CONFIG_CRC_OFFSET    12
+
+static const char *const config_file[2] = {HT_CONFIG_FILE_0, HT_CONFIG_FILE_1};
+
+static void HT_Config_PutLE(uint8_t *p, uint32_t value, uint8_t len) {
+    for (uint8_t i = 0; i < len; ++i)
+        p[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint32_t HT_Config_GetLE(const uint8_t *p, uint8_t len) {
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < len; ++i)
+        value |= (uint32_t)p[i] << (8 * i);
+
+    return value;
+}
+
+static void HT_Config_Defaults(HT_Config *config) {
+    config->interval_ms = HT_CONFIG_INTERVAL_MS;
+    HT_Report_Defaults(&config->report);
+    config->aggregate_s = HT_AGG_WINDOW_S;
+}
+
+static uint8_t *HT_Config_PutRecord(uint8_t *p, uint8_t key, uint32_t value, uint8_t len) {
+    p[0] = key;
+    p[1] = len;
+    HT_Config_PutLE(&p[2], value, len);
+
+    return p + 2 + len;
+}
+
+static uint16_t HT_Config_Encode(const HT_Config *config, const char *topic, uint8_t topic_len,
+                                 uint32_t seq, uint8_t *buf) {
+    uint8_t *p = &buf[HT_CONFIG_HEADER_SIZE];
+    uint16_t length;
+    uint16_t crc;
+
+    // Keep buf[5] in step with the records written here
+    p = HT_Config_PutRecord(p, HT_CONFIG_KEY_INTERVAL_MS, config->interval_ms, 4);
+    p = HT_Config_PutRecord(p, HT_CONFIG_KEY_DEADBAND_TEMP, (uint16_t)config->report.deadband_temp, 2);
+    p = HT_Config_PutRecord(p, HT_CONFIG_KEY_DEADBAND_HUM, (uint16_t)config->report.deadband_hum, 2);
+    p = HT_Config_PutRecord(p, HT_CONFIG_KEY_HEARTBEAT_S, config->report.heartbeat_s, 4);
+    p = HT_Config_PutRecord(p, HT_CONFIG_KEY_AGGREGATE_S, config->aggregate_s, 4);
+    if (topic_len) {
+        p[0] = HT_CONFIG_KEY_SUMMARY_TOPIC;
+        p[1] = topic_len;
+        memcpy(&p[2], topic, topic_len);
+        p += 2 + topic_len;
+    }
+    length = p - &buf[HT_CONFIG_HEADER_SIZE];
+
+    HT_Config_PutLE(&buf[0], HT_CONFIG_MAGIC, 4);
+    buf[4] = HT_CONFIG_FORMAT;
+    buf[5] = topic_len ? 6 : 5;
+    HT_Config_PutLE(&buf[6], length, 2);
+    HT_Config_PutLE(&buf[8], seq, 4);
+
+    crc = HT_Ring_Crc16(0xFFFF, buf, HT_CONFIG_CRC_OFFSET);
+    crc = HT_Ring_Crc16(crc, &buf[HT_CONFIG_HEADER_SIZE], length);
+    HT_Config_PutLE(&buf[HT_CONFIG_CRC_OFFSET], crc, 2);
+
+    return HT_CONFIG_HEADER_SIZE + length;
+}
+
+// Reads one copy over the defaults in config, and its summary topic when topic
+// is not NULL (topic_len stays 0 without one). Returns its sequence number, 0 if invalid.
+static uint32_t HT_Config_Load(uint8_t slot, HT_Config *config, char *topic, uint8_t *topic_len) {
+    uint8_t buf[HT_CONFIG_MAX_SIZE];
+    OSAFILE fp = OsaFopen(config_file[slot], "rb");
+    uint32_t size, value;
+    uint16_t length, crc;
+    uint8_t *p, *end;
+    uint8_t count;
+
+    if (fp == PNULL)
+        return 0;
+
+    size = OsaFread(buf, 1, sizeof(buf), fp);
+    OsaFclose(fp);
+
+    if (size < HT_CONFIG_HEADER_SIZE || HT_Config_GetLE(&buf[0], 4) != HT_CONFIG_MAGIC ||
+        buf[4] != HT_CONFIG_FORMAT)
+        return 0;
+
+    count = buf[5];
+    length = HT_Config_GetLE(&buf[6], 2);
+    if ((uint32_t)HT_CONFIG_HEADER_SIZE + length > size)
+        return 0;
+
+    crc = HT_Ring_Crc16(0xFFFF, buf, HT_CONFIG_CRC_OFFSET);
+    crc = HT_Ring_Crc16(crc, &buf[HT_CONFIG_HEADER_SIZE], length);
+    if (crc != HT_Config_GetLE(&buf[HT_CONFIG_CRC_OFFSET], 2))
+        return 0;
+
+    p = &buf[HT_CONFIG_HEADER_SIZE];
+    end = p + length;
+    while (count-- && p + 2 <= end && p + 2 + p[1] <= end) {
+        value = HT_Config_GetLE(&p[2], p[1] > 4 ? 4 : p[1]);
+
+        switch (p[0]) {
+            case HT_CONFIG_KEY_INTERVAL_MS:
+                config->interval_ms = value;
+                break;
+            case HT_CONFIG_KEY_DEADBAND_TEMP:
+                config->report.deadband_temp = (int16_t)value;
+                break;
+            case HT_CONFIG_KEY_DEADBAND_HUM:
+                config->report.deadband_hum = (int16_t)value;
+                break;
+            case HT_CONFIG_KEY_HEARTBEAT_S:
+                config->report.heartbeat_s = value;
+                break;
+            case HT_CONFIG_KEY_AGGREGATE_S:
+                config->aggregate_s = value;
+                break;
+            case HT_CONFIG_KEY_SUMMARY_TOPIC:
+                if (topic != NULL && p[1] <= HT_CONFIG_TOPIC_MAX) {
+                    memcpy(topic, &p[2], p[1]);
+                    topic[p[1]] = '\0';
+                    *topic_len = p[1];
+                }
+                break;
+            default:
+                break;
+        }
+
+        p += 2 + p[1];
+    }
+
+    return HT_Config_GetLE(&buf[8], 4);
+}
+
+// Firmware before the store kept only the sampling interval, as a raw native
+// uint32 in HT_CONFIG_LEGACY_FILE. Returns 1 when that file exists.
+static uint8_t HT_Config_LoadLegacy(HT_Config *config) {
+    OSAFILE fp = OsaFopen(HT_CONFIG_LEGACY_FILE, "rb");
+    uint32_t interval_ms;
+    uint32_t n;
+
+    if (fp == PNULL)
+        return 0;
+
+    n = OsaFread(&interval_ms, sizeof(interval_ms), 1, fp);
+    OsaFclose(fp);
+
+    if (n == 1 && interval_ms != 0)
+        config->interval_ms = interval_ms;
+
+    return 1;
+}
+
+static HT_ConfigState *HT_Config_State(void) {
+    HT_ConfigState *state = &HT_Retention_Get()->config;
+    HT_Config copy;
+    uint32_t seq;
+
+    if (state->loaded)
+        return state;
+
+    // Newest valid copy wins, defaults when there is none
+    HT_Config_Defaults(&state->values);
+    state->seq = 0;
+    state->slot = 1;
+
+    for (uint8_t slot = 0; slot < 2; ++slot) {
+        HT_Config_Defaults(&copy);
+        seq = HT_Config_Load(slot, &copy, NULL, NULL);
+        if (seq != 0 && (state->seq == 0 || (int32_t)(seq - state->seq) > 0)) {
+            state->values = copy;
+            state->seq = seq;
+            state->slot = slot;
+        }
+    }
+
+    state->loaded = 1;
+
+    // No shadow copy yet: seed the store from the legacy file, which is only
+    // removed once its value is safely in a shadow copy
+    if (state->seq == 0) {
+        HT_Config_Defaults(&copy);
+        if (HT_Config_LoadLegacy(&copy) && HT_Config_Set(&copy) == HT_CONFIG_OK) {
+            OsaFremove(HT_CONFIG_LEGACY_FILE);
+            printf("Config: %s migrado\n", HT_CONFIG_LEGACY_FILE);
+        }
+    }
+
+    HT_Retention_Commit();
+
+    printf("Config: copia %lu, intervalo %lu ms\n", state->seq, state->values.interval_ms);
+
+    return state;
+}
+
+const HT_Config *HT_Config_Get(void) {
+    return &HT_Config_State()->values;
+}
+
+// Writes config and topic as the next copy over the older file
+static int HT_Config_Write(HT_ConfigState *state, const HT_Config *config, const char *topic, uint8_t topic_len) {
+    uint8_t buf[HT_CONFIG_MAX_SIZE];
+    uint8_t slot = state->slot ^ 1;
+    uint32_t seq = state->seq + 1;
+    uint16_t size;
+    OSAFILE fp;
+    int ret = HT_CONFIG_ERROR_WRITE;
+
+    state->values = *config;
+
+    // Overwrite the older copy; the newer one stays valid until this one is complete
+    size = HT_Config_Encode(config, topic, topic_len, seq, buf);
+    fp = OsaFopen(config_file[slot], "wb");
+    if (fp != PNULL) {
+        if (OsaFwrite(buf, 1, size, fp) == size) {
+            state->seq = seq;
+            state->slot = slot;
+            ret = HT_CONFIG_OK;
+        }
+        OsaFclose(fp);
+    }
+
+    HT_Retention_Commit();
+
+    return ret;
+}
+
+int HT_Config_Set(const HT_Config *config) {
+    HT_ConfigState *state = HT_Config_State();
+    char topic[HT_CONFIG_TOPIC_MAX + 1];
+
+    if (memcmp(config, &state->values, sizeof(HT_Config)) == 0)
+        return HT_CONFIG_OK;
+
+    return HT_Config_Write(state, config, topic, HT_Config_GetTopic(topic));
+}
+
+uint8_t HT_Config_GetTopic(char *topic) {
+    HT_ConfigState *state = HT_Config_State();
+    char copy_topic[HT_CONFIG_TOPIC_MAX + 1];
+    uint8_t len = 0;
+    HT_Config copy;
+
+    if (state->seq == 0 || HT_Config_Load(state->slot, &copy, copy_topic, &len) != state->seq || len == 0)
+        return 0;
+
+    memcpy(topic, copy_topic, len + 1);
+
+    return len;
+}
+
+int HT_Config_SetTopic(const char *topic, uint8_t len) {
+    HT_ConfigState *state = HT_Config_State();
+    char current[HT_CONFIG_TOPIC_MAX + 1];
+
+    if (len > HT_CONFIG_TOPIC_MAX)
+        return HT_CONFIG_ERROR_TOPIC;
+    for (uint8_t i = 0; i < len; ++i) {
+        if (topic[i] == '+' || topic[i] == '#' || topic[i] < ' ' || topic[i] > '~')
+            return HT_CONFIG_ERROR_TOPIC;
+    }
+
+    if (HT_Config_GetTopic(current) == len && memcmp(current, topic, len) == 0)
+        return HT_CONFIG_OK;
+
+    return HT_Config_Write(state, &state->values, topic, len);
+}
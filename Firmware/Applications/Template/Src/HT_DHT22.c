@@ -2,12 +2,30 @@
 #include "HT_GPIO_Api.h"
 #include "bsp.h"           // For pad_config_t, gpio_pin_config_t, delay_us and GPIO_PinRead
 #include "task.h"          // For vTaskSuspendAll/xTaskResumeAll
+#include "cmsis_os2.h"     // For osSemaphore/osDelay
+#include "timer_qcx212.h"  // For TIMER_GetCount
+#include "clock_qcx212.h"  // For GPR_SetClockSrc/GPR_ClockEnable
 
 // Timeout values in microseconds for the read loop
 #define DHT22_TIMEOUT_RESPONSE_START 80
 #define DHT22_TIMEOUT_RESPONSE_PULSE 100
 #define DHT22_TIMEOUT_DATA_PULSE     100
 
+#define DHT22_GPIO_MASK (1 << DHT22_GPIO_PIN)
+
+#if DHT22_EDGE_CAPTURE_ENABLE == 1
+static volatile uint32_t dht22_edges[DHT22_FRAME_EDGES]; // Timer count at each edge
+static volatile uint8_t dht22_edge_count = 0;
+static volatile uint8_t dht22_wait_rising = 0;           // Polarity of the next expected edge
+static osSemaphoreId_t dht22_frame_sem = NULL;
+
+// Configures the capture timer and GPIO interrupt used by the edge-capture reader.
+static void DHT22_CaptureInit(void);
+#endif
+
+// Decodes 80 pulse durations (low/high pairs) into temperature and humidity.
+static int DHT22_Decode(const uint16_t *cycles, HT_SensorReading *reading);
+
 void DHT22_Init(void) {
     pad_config_t padConfig;
     gpio_pin_config_t config;
@@ -24,11 +42,120 @@ void DHT22_Init(void) {
     // NOTE: An external 4.7k pull-up resistor is MANDATORY for DHT22 operation.
     // The internal pull-up is explicitly disabled to ensure reliance on the correct external component.
     PAD_SetPinPullConfig(DHT22_PAD_ID, PAD_AutoPull);
+
+#if DHT22_EDGE_CAPTURE_ENABLE == 1
+    DHT22_CaptureInit();
+#endif
+}
+
+#if DHT22_EDGE_CAPTURE_ENABLE == 1
+
+// Called by the shared GPIO dispatcher (HT_GPIO_Api.c) when the DHT22 pin flag is set
+static void DHT22_GpioIRQnHandler(void) {
+    uint32_t now = TIMER_GetCount(DHT22_CAPTURE_TIMER_INSTANCE);
+
+    do {
+        dht22_edges[dht22_edge_count++] = now;
+
+        if (dht22_edge_count >= DHT22_FRAME_EDGES) {
+            GPIO_InterruptConfig(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN, GPIO_InterruptDisabled);
+            GPIO_ClearInterruptFlags(DHT22_GPIO_INSTANCE, DHT22_GPIO_MASK);
+            osSemaphoreRelease(dht22_frame_sem);
+            return;
+        }
+
+        // The controller only triggers on one edge, so flip polarity after every edge
+        dht22_wait_rising = !dht22_wait_rising;
+        GPIO_InterruptConfig(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN,
+                             dht22_wait_rising ? GPIO_InterruptRisingEdge : GPIO_InterruptFallingEdge);
+        GPIO_ClearInterruptFlags(DHT22_GPIO_INSTANCE, DHT22_GPIO_MASK);
+
+        // If the line already moved while the polarity was being switched, the edge
+        // would be lost: record it here instead of waiting for the next interrupt.
+        now = TIMER_GetCount(DHT22_CAPTURE_TIMER_INSTANCE);
+    } while ((GPIO_PinRead(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN) ? 1 : 0) == dht22_wait_rising);
+}
+
+static void DHT22_CaptureInit(void) {
+    timer_config_t timerConfig;
+
+    if (dht22_frame_sem != NULL)
+        return;
+
+    if (HT_GPIO_RegisterIRQHandler(DHT22_GPIO_INSTANCE, DHT22_GPIO_MASK, DHT22_GpioIRQnHandler) != 0)
+        return;
+
+    dht22_frame_sem = osSemaphoreNew(1, 0, NULL);
+
+    // Free-running counter on the 26MHz clock, only read and never reloaded
+    GPR_ClockDisable(GPR_TIMER2FuncClk);
+    GPR_SetClockSrc(GPR_TIMER2FuncClk, GPR_TIMER2ClkSel_26M);
+    GPR_ClockEnable(GPR_TIMER2FuncClk);
+
+    TIMER_DriverInit();
+    TIMER_GetDefaultConfig(&timerConfig);
+    timerConfig.reloadOption = TIMER_ReloadDisabled;
+    TIMER_Init(DHT22_CAPTURE_TIMER_INSTANCE, &timerConfig);
+    TIMER_Start(DHT22_CAPTURE_TIMER_INSTANCE);
+}
+
+int DHT22_Read(HT_SensorReading *reading) {
+    uint16_t cycles[DHT22_FRAME_PULSES]; // Array to store pulse durations
+    gpio_pin_config_t config;
+
+    // Capture resources missing: DHT22_Init not called, or no handler slot/semaphore
+    if (dht22_frame_sem == NULL)
+        return DHT22_ERROR;
+
+    // === STEP 1: Send start signal ===
+    config.pinDirection = GPIO_DirectionOutput;
+    config.misc.initOutput = 0;
+    GPIO_PinConfig(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN, &config);
+    HT_GPIO_WritePin(DHT22_GPIO_PIN, DHT22_GPIO_INSTANCE, 0);
+
+    // Hold the line low for > 1ms. Two ticks guarantee at least one full tick
+    // and the scheduler keeps running meanwhile.
+    osDelay(2);
+
+    // === STEP 2: Arm the capture and release the line ===
+    // The pull-up brings the line high; the first edge of interest is the ACK falling edge.
+    osSemaphoreAcquire(dht22_frame_sem, 0);
+    dht22_edge_count = 0;
+    dht22_wait_rising = 0;
+
+    config.pinDirection = GPIO_DirectionInput;
+    config.misc.interruptConfig = GPIO_InterruptFallingEdge;
+    GPIO_ClearInterruptFlags(DHT22_GPIO_INSTANCE, DHT22_GPIO_MASK);
+    GPIO_PinConfig(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN, &config);
+
+    // === STEP 3: Sleep until the ISR has captured the whole frame ===
+    if (osSemaphoreAcquire(dht22_frame_sem, DHT22_FRAME_TIMEOUT_MS) != osOK) {
+        GPIO_InterruptConfig(DHT22_GPIO_INSTANCE, DHT22_GPIO_PIN, GPIO_InterruptDisabled);
+        GPIO_ClearInterruptFlags(DHT22_GPIO_INSTANCE, DHT22_GPIO_MASK);
+
+        // Map the number of edges seen to the same codes the polling reader returns
+        switch (dht22_edge_count) {
+            case 0:  return DHT22_ERROR_TIMEOUT_START;
+            case 1:  return DHT22_ERROR_TIMEOUT_LOW;
+            case 2:  return DHT22_ERROR_TIMEOUT_HIGH;
+            default: return DHT22_ERROR_TIMEOUT_DATA;
+        }
+    }
+
+    // === STEP 4: Convert edge timestamps into pulse durations ===
+    // Edges 0..2 are the sensor response, data bit i spans edges 2+2i..4+2i.
+    for (int i = 0; i < DHT22_FRAME_PULSES; ++i) {
+        uint32_t ticks = dht22_edges[3 + i] - dht22_edges[2 + i]; // Wraps correctly on overflow
+        cycles[i] = (uint16_t)(ticks / DHT22_CAPTURE_TIMER_TICKS_US);
+    }
+
+    return DHT22_Decode(cycles, reading);
 }
 
-int DHT22_Read(float *temperature, float *humidity) {
-    uint8_t data[5] = {0, 0, 0, 0, 0};
-    uint16_t cycles[80]; // Array to store pulse durations
+#else
+
+int DHT22_Read(HT_SensorReading *reading) {
+    uint16_t cycles[DHT22_FRAME_PULSES]; // Array to store pulse durations
     int ret = 0;
     gpio_pin_config_t config;
 
@@ -100,27 +227,64 @@ end_read:
     if (ret != 0) {
         return ret; // Return error code
     }
-    
-    // === STEP 4: Decode pulses from the array into data bytes ===
-    for (int i = 0; i < 40; ++i) {
-        uint16_t lowCycles = cycles[2 * i];
-        uint16_t highCycles = cycles[2 * i + 1];
-        
-        data[i / 8] <<= 1;
-        // The robust way: compare high pulse duration to low pulse duration
-        if (highCycles > lowCycles) {
-            data[i / 8] |= 1;
-        }
-    }
-    
-    // === STEP 5: Verify checksum and calculate final values ===
-    if (data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) {
-        *humidity = ((uint16_t)(data[0] << 8) | data[1]) / 10.0f;
-        uint16_t raw_temp = (uint16_t)(data[2] & 0x7F) << 8 | data[3];
-        *temperature = raw_temp / 10.0f;
-        if (data[2] & 0x80) { *temperature *= -1.0f; }
-        return DHT22_OK; // Success
+
+    return DHT22_Decode(cycles, reading);
+}
+
+#endif
+
+static int DHT22_Decode(const uint16_t *cycles, HT_SensorReading *reading) {
+    DHT22_Frame frame;
+    int ret;
+
+    // === STEP 5: Decode pulses, verify checksum and calculate final values ===
+    ret = DHT22_DecodeFrame(cycles, DHT22_FRAME_PULSES, &frame);
+    if (ret != DHT22_OK) {
+        return ret;
     }
 
-    return DHT22_ERROR_CHECKSUM; // Checksum error
-}
\ No newline at end of file
+    reading->temperature = frame.temperature;
+    reading->humidity = frame.humidity;
+
+    return DHT22_OK; // Success
+}
+
+void DHT22_Power(uint8_t on) {
+#if DHT22_POWER_ENABLE == 1
+    pad_config_t padConfig;
+    gpio_pin_config_t config;
+
+    PAD_GetDefaultConfig(&padConfig);
+    padConfig.mux = PAD_MuxAlt0;
+    PAD_SetPinConfig(DHT22_POWER_PAD_ID, &padConfig);
+
+    config.pinDirection = GPIO_DirectionOutput;
+    config.misc.initOutput = on ? 1 : 0;
+    GPIO_PinConfig(DHT22_POWER_GPIO_INSTANCE, DHT22_POWER_GPIO_PIN, &config);
+    HT_GPIO_WritePin(DHT22_POWER_GPIO_PIN, DHT22_POWER_GPIO_INSTANCE, on ? 1 : 0);
+#else
+    (void)on;
+#endif
+}
+
+static int DHT22_DrvInit(void) {
+    DHT22_Init();
+    // The single-wire protocol has no presence probe: the first read reports a missing sensor
+    return HT_SENSOR_OK;
+}
+
+const HT_SensorDriver DHT22_Driver = {
+    "DHT22",
+#if DHT22_POWER_ENABLE == 1
+    HT_SENSOR_CAP_TEMPERATURE | HT_SENSOR_CAP_HUMIDITY | HT_SENSOR_CAP_POWER,
+#else
+    HT_SENSOR_CAP_TEMPERATURE | HT_SENSOR_CAP_HUMIDITY,
+#endif
+    0,                      // The conversion happens inside DHT22_Read
+    DHT22_MIN_PERIOD_MS,
+    DHT22_WARMUP_MS,
+    DHT22_DrvInit,
+    NULL,
+    DHT22_Read,
+    DHT22_Power
+};
@@ -0,0 +1,57 @@
+#include "HT_DHT22_Decoder.h"
+
+int DHT22_DecodeFrame(const uint16_t *pulses, uint16_t count, DHT22_Frame *frame) {
+    uint32_t baseline = 0;
+    uint32_t threshold;
+    uint8_t *data = frame->raw;
+
+    if (count < DHT22_FRAME_PULSES) {
+        return DHT22_ERROR_TIMEOUT_DATA;
+    }
+
+    // === Low pulse baseline: every bit starts with the same ~50us low ===
+    for (int i = 0; i < DHT22_FRAME_BITS; ++i) {
+        baseline += pulses[2 * i];
+    }
+    baseline /= DHT22_FRAME_BITS;
+
+    if (baseline == 0) {
+        return DHT22_ERROR_FRAME;
+    }
+
+    threshold = (baseline * DHT22_BIT_THRESHOLD_NUM) / DHT22_BIT_THRESHOLD_DEN;
+
+    // === Pulses into bits ===
+    for (int i = 0; i < 5; ++i) {
+        data[i] = 0;
+    }
+
+    for (int i = 0; i < DHT22_FRAME_BITS; ++i) {
+        uint32_t low = pulses[2 * i];
+        uint32_t high = pulses[2 * i + 1];
+
+        // A low pulse far from the baseline, or a high a fraction of a "0"
+        // (~half the baseline), means glitches or lost edges
+        if (low < baseline / 2 || low > baseline * 2 || high < baseline / 8 || high > baseline * 3) {
+            return DHT22_ERROR_FRAME;
+        }
+
+        data[i / 8] <<= 1;
+        if (high > threshold) {
+            data[i / 8] |= 1;
+        }
+    }
+
+    // === Checksum and values ===
+    if (data[4] != ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) {
+        return DHT22_ERROR_CHECKSUM;
+    }
+
+    frame->humidity = (int16_t)((data[0] << 8) | data[1]);
+    frame->temperature = (int16_t)(((data[2] & 0x7F) << 8) | data[3]);
+    if (data[2] & 0x80) {
+        frame->temperature = -frame->temperature;
+    }
+
+    return DHT22_OK;
+}
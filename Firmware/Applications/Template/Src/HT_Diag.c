@@ -0,0 +1,77 @@
+#include "HT_Diag.h"
+#include "HT_Sensor.h"
+#include "adc_qcx212.h"
+#include "hal_adc.h"
+#include "cmsis_os2.h"
+
+#define HT_DIAG_FLAG_VBAT       (1 << 0)
+#define HT_DIAG_FLAG_THERMAL    (1 << 1)
+
+static osEventFlagsId_t diag_flags = NULL;
+static volatile uint32_t diag_vbat_raw;
+static volatile uint32_t diag_thermal_raw;
+
+static void HT_Diag_VbatCallback(uint32_t result) {
+    diag_vbat_raw = result;
+    osEventFlagsSet(diag_flags, HT_DIAG_FLAG_VBAT);
+}
+
+static void HT_Diag_ThermalCallback(uint32_t result) {
+    diag_thermal_raw = result;
+    osEventFlagsSet(diag_flags, HT_DIAG_FLAG_THERMAL);
+}
+
+int HT_Diag_Sample(HT_DiagReading *reading) {
+    adc_config_t adcConfig;
+    uint32_t flags;
+    int32_t temp_centi;
+    int ret = HT_DIAG_OK;
+
+    if (diag_flags == NULL)
+        diag_flags = osEventFlagsNew(NULL);
+
+    osEventFlagsClear(diag_flags, HT_DIAG_FLAG_VBAT | HT_DIAG_FLAG_THERMAL);
+
+    ADC_GetDefaultConfig(&adcConfig);
+    adcConfig.channelConfig.vbatResDiv = HT_DIAG_VBAT_RESDIV;
+    ADC_ChannelInit(ADC_ChannelVbat, ADC_UserAPP, &adcConfig, HT_Diag_VbatCallback);
+
+    ADC_GetDefaultConfig(&adcConfig);
+    adcConfig.channelConfig.thermalInput = ADC_ThermalInputDisable;
+    ADC_ChannelInit(ADC_ChannelThermal, ADC_UserAPP, &adcConfig, HT_Diag_ThermalCallback);
+
+    // Both requests are queued back to back and serviced in one ADC run
+    if (ADC_StartConversion(ADC_ChannelVbat, ADC_UserAPP) != 0 ||
+        ADC_StartConversion(ADC_ChannelThermal, ADC_UserAPP) != 0) {
+        ret = HT_DIAG_ERROR_START;
+    } else {
+        flags = osEventFlagsWait(diag_flags, HT_DIAG_FLAG_VBAT | HT_DIAG_FLAG_THERMAL,
+                                 osFlagsWaitAll, HT_DIAG_TIMEOUT_MS);
+        if (flags & osFlagsError)
+            ret = HT_DIAG_ERROR_TIMEOUT;
+    }
+
+    ADC_ChannelDeInit(ADC_ChannelVbat, ADC_UserAPP);
+    ADC_ChannelDeInit(ADC_ChannelThermal, ADC_UserAPP);
+
+    if (ret != HT_DIAG_OK)
+        return ret;
+
+    reading->vbat_mv = (uint16_t)(HAL_ADC_CalibrateRawCode(diag_vbat_raw) * HT_DIAG_VBAT_DIV_NUM / HT_DIAG_VBAT_DIV_DEN);
+
+    temp_centi = HAL_ADC_ConvertThermalRawCodeToTemperature(diag_thermal_raw);
+    if (temp_centi == 0x7FFFFFFF)
+        return HT_DIAG_ERROR_THERMAL;
+
+    reading->die_temp = (int16_t)(temp_centi / 10);
+
+    return HT_DIAG_OK;
+}
+
+uint8_t HT_Diag_Format(const HT_DiagReading *reading, char *out) {
+    uint8_t len = HT_Sensor_FormatUInt(reading->vbat_mv, out);
+
+    out[len++] = ',';
+
+    return len + HT_Sensor_FormatDeci(reading->die_temp, &out[len]);
+}
@@ -0,0 +1,72 @@
+#include "HT_EventWake.h"
+#include "HT_Sensor.h"
+#include "HT_Retention.h"
+#include "bsp.h"
+#include "slpman_qcx212.h"
+
+#if HT_EVENT_WAKE_PAD > 2
+#error "HT_EVENT_WAKE_PAD must be a configurable wakeup pad (0..2)"
+#endif
+
+static uint8_t event_triggered = 0;
+
+// Events seen while awake, folded into the retention counter at report time
+static volatile uint16_t event_irq_count = 0;
+
+void HT_EventWake_Init(void) {
+#if HT_EVENT_WAKE_ENABLE == 1
+    HT_RetentionData *ret = HT_Retention_Get();
+    padWakeupSettings_t cfg = {0};
+
+#if HT_EVENT_WAKE_PAD == 0
+    cfg.gp0_posedge_en = HT_EVENT_WAKE_RISING;
+    cfg.gp0_negedge_en = HT_EVENT_WAKE_FALLING;
+#elif HT_EVENT_WAKE_PAD == 1
+    cfg.gp1_posedge_en = HT_EVENT_WAKE_RISING;
+    cfg.gp1_negedge_en = HT_EVENT_WAKE_FALLING;
+#else
+    cfg.gp2_posedge_en = HT_EVENT_WAKE_RISING;
+    cfg.gp2_negedge_en = HT_EVENT_WAKE_FALLING;
+#endif
+
+    slpManSetWakeupPad(cfg);
+    NVIC_ClearPendingIRQ((IRQn_Type)(PadWakeup0_IRQn + HT_EVENT_WAKE_PAD));
+    NVIC_EnableIRQ((IRQn_Type)(PadWakeup0_IRQn + HT_EVENT_WAKE_PAD));
+
+    if (slpManGetWakeupSrc() == WAKEUP_FROM_PAD) {
+        event_triggered = 1;
+        ret->event_level = (slpManGetWakeupPinValue() >> HT_EVENT_WAKE_PAD) & 0x1;
+        if (ret->event_count < 0xFFFF)
+            ret->event_count++;
+        HT_Retention_Commit();
+    }
+#endif
+}
+
+uint8_t HT_EventWake_Triggered(void) {
+    return event_triggered;
+}
+
+void HT_EventWake_IntHandler(uint8_t pad) {
+    if (pad == HT_EVENT_WAKE_PAD && event_irq_count < 0xFFFF)
+        event_irq_count++;
+}
+
+uint8_t HT_EventWake_Format(char *out) {
+    HT_RetentionData *ret = HT_Retention_Get();
+    uint8_t len = 0;
+
+    if (event_irq_count) {
+        ret->event_count = (ret->event_count + event_irq_count > 0xFFFF) ? 0xFFFF : ret->event_count + event_irq_count;
+        event_irq_count = 0;
+        HT_Retention_Commit();
+    }
+
+    out[len++] = (char)('0' + HT_EVENT_WAKE_PAD);
+    out[len++] = ',';
+    out[len++] = (char)('0' + ret->event_level);
+    out[len++] = ',';
+    len += HT_Sensor_FormatUInt(ret->event_count, &out[len]);
+
+    return len;
+}
@@ -59,6 +59,42 @@ static void HT_GPIO_IRQnCallback(void) {
 }
 */
 
+static struct {
+    uint32_t instance;
+    uint16_t mask;
+    HT_GPIO_IRQHandler handler;
+} gpio_irq_handlers[HT_GPIO_IRQ_HANDLERS];
+static volatile uint8_t gpio_irq_count = 0;
+
+// Owns PXIC_Gpio_IRQn: each user only sees the interrupts of its own pins.
+static void HT_GPIO_IRQnDispatch(void) {
+    for (uint8_t i = 0; i < gpio_irq_count; i++) {
+        if (GPIO_GetInterruptFlags(gpio_irq_handlers[i].instance) & gpio_irq_handlers[i].mask)
+            gpio_irq_handlers[i].handler();
+    }
+}
+
+int HT_GPIO_RegisterIRQHandler(uint32_t instance, uint16_t mask, HT_GPIO_IRQHandler handler) {
+    uint32_t mask_irq;
+
+    if (gpio_irq_count >= HT_GPIO_IRQ_HANDLERS)
+        return -1;
+
+    mask_irq = SaveAndSetIRQMask();
+    gpio_irq_handlers[gpio_irq_count].instance = instance;
+    gpio_irq_handlers[gpio_irq_count].mask = mask;
+    gpio_irq_handlers[gpio_irq_count].handler = handler;
+    gpio_irq_count++;
+    RestoreIRQMask(mask_irq);
+
+    if (gpio_irq_count == 1) {
+        XIC_SetVector(PXIC_Gpio_IRQn, HT_GPIO_IRQnDispatch);
+        XIC_EnableIRQ(PXIC_Gpio_IRQn);
+    }
+
+    return 0;
+}
+
 void HT_GPIO_WritePin(uint16_t pin, uint32_t instance, uint16_t value) {
     // Write the value in the GPIO pin
     GPIO_PinWrite(instance, 1 << pin, (value ? 1 << pin : 0)); 
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include "HT_Journal.h"
+#include "HT_Retention.h"
+#include "HT_EventWake.h"
+#include "HT_QLog.h"
+#include "osasys.h"
+#include "slpman_qcx212.h"
+
+#define HT_JOURNAL_SPILL_CHUNK  16      // Records copied from the ring per file write
+
+#if HT_QLOG_ENABLE == 1
+#define HT_JOURNAL_FLASH_CAPACITY   HT_QLOG_CAPACITY
+#else
+#define HT_JOURNAL_FLASH_CAPACITY   HT_JOURNAL_MAX_RECORDS
+#endif
+
+// Ring in retention memory, emptied if it did not survive the last hibernate.
+static HT_SampleRing *HT_Journal_Ring(void) {
+    HT_SampleRing *ring = &HT_Retention_Get()->sample_ring;
+
+    if (!HT_Ring_IsValid(ring)) {
+        if (ring->count)
+            printf("Journal: anel corrompido, %d amostras descartadas\n", ring->count);
+        HT_Ring_Reset(ring);
+        HT_Retention_Commit();
+    }
+
+    return ring;
+}
+
+#if HT_QLOG_ENABLE == 1
+// Flash tier on the raw QSPI log
+static HT_QLogState *HT_Journal_Log(void) {
+    HT_QLogState *log = &HT_Retention_Get()->qlog;
+
+    if (!log->valid) {
+        HT_QLog_Init(log);
+        HT_Retention_Commit();
+    }
+
+    return log;
+}
+
+static uint16_t HT_Journal_FlashCount(void) {
+    return HT_QLog_Count(HT_Journal_Log());
+}
+
+// Moves every ring record to the log. The oldest sector is dropped when the log wraps.
+static int HT_Journal_Spill(HT_SampleRing *ring) {
+    HT_QLogState *log = HT_Journal_Log();
+    HT_SampleRecord record;
+    int ret = HT_JOURNAL_OK;
+
+    while (ring->count && ret == HT_JOURNAL_OK) {
+        HT_Ring_Read(ring, 0, &record, 1);
+        if (HT_QLog_Append(log, &record) != HT_QLOG_OK)
+            ret = HT_JOURNAL_ERROR_WRITE;
+        else
+            HT_Ring_Drop(ring, 1);
+    }
+
+    HT_Retention_Commit();
+
+    return ret;
+}
+
+static int HT_Journal_FlashRead(uint16_t first, HT_SampleRecord *records, uint16_t count) {
+    return HT_QLog_Read(HT_Journal_Log(), first, records, count);
+}
+
+static void HT_Journal_FlashClear(void) {
+    HT_QLog_Clear(HT_Journal_Log());
+}
+
+#else
+// Flash tier on a littlefs file
+static OSAFILE HT_Journal_Open(void) {
+    OSAFILE fp = OsaFopen(HT_JOURNAL_FILE, "rb+");
+
+    // No append mode in the OSA file API, create on first use
+    if (fp == PNULL)
+        fp = OsaFopen(HT_JOURNAL_FILE, "wb+");
+
+    return fp;
+}
+
+static uint16_t HT_Journal_FlashCount(void) {
+    OSAFILE fp = OsaFopen(HT_JOURNAL_FILE, "rb");
+    INT32 size;
+
+    if (fp == PNULL)
+        return 0;
+
+    size = OsaFsize(fp);
+    OsaFclose(fp);
+
+    return (size > 0) ? (uint16_t)(size / sizeof(HT_SampleRecord)) : 0;
+}
+
+// Moves every ring record to the flash file in one open.
+static int HT_Journal_Spill(HT_SampleRing *ring) {
+    HT_SampleRecord chunk[HT_JOURNAL_SPILL_CHUNK];
+    OSAFILE fp;
+    INT32 size;
+    uint16_t n;
+    int ret = HT_JOURNAL_OK;
+
+    fp = HT_Journal_Open();
+    if (fp == PNULL)
+        return HT_JOURNAL_ERROR_OPEN;
+
+    size = OsaFsize(fp);
+    if (size < 0) {
+        OsaFclose(fp);
+        return HT_JOURNAL_ERROR_OPEN;
+    }
+
+    if ((uint32_t)size / sizeof(HT_SampleRecord) + ring->count > HT_JOURNAL_MAX_RECORDS) {
+        OsaFclose(fp);
+        return HT_JOURNAL_ERROR_FULL;
+    }
+
+    // Drop a torn tail left by a reset in the middle of a write
+    OsaFseek(fp, size - size % sizeof(HT_SampleRecord), SEEK_SET);
+
+    while (ring->count && ret == HT_JOURNAL_OK) {
+        n = HT_Ring_Read(ring, 0, chunk, HT_JOURNAL_SPILL_CHUNK);
+        if (OsaFwrite(chunk, sizeof(HT_SampleRecord), n, fp) != n)
+            ret = HT_JOURNAL_ERROR_WRITE;
+        else
+            HT_Ring_Drop(ring, n);
+    }
+
+    OsaFclose(fp);
+    HT_Retention_Commit();
+
+    return ret;
+}
+
+static int HT_Journal_FlashRead(uint16_t first, HT_SampleRecord *records, uint16_t count) {
+    OSAFILE fp = OsaFopen(HT_JOURNAL_FILE, "rb");
+    UINT32 read = 0;
+
+    if (fp == PNULL)
+        return HT_JOURNAL_ERROR_OPEN;
+
+    if (OsaFseek(fp, (INT32)first * sizeof(HT_SampleRecord), SEEK_SET) == 0)
+        read = OsaFread(records, sizeof(HT_SampleRecord), count, fp);
+
+    OsaFclose(fp);
+
+    return (int)read;
+}
+
+static void HT_Journal_FlashClear(void) {
+    OsaFremove(HT_JOURNAL_FILE);
+}
+#endif // HT_QLOG_ENABLE
+
+int HT_Journal_Append(const HT_SampleRecord *record) {
+    HT_SampleRing *ring = HT_Journal_Ring();
+    int ret;
+
+    if (HT_Ring_Push(ring, record) != HT_RING_OK) {
+        ret = HT_Journal_Spill(ring);
+        if (ret != HT_JOURNAL_OK)
+            return ret;
+
+        HT_Ring_Push(ring, record);
+    }
+
+    // No commit: the ring stays in retention SRAM through hibernate, and the
+    // flash copy is only refreshed at checkpoints (spill, clear)
+    return HT_JOURNAL_OK;
+}
+
+uint16_t HT_Journal_Count(void) {
+    return HT_Journal_FlashCount() + HT_Journal_Ring()->count;
+}
+
+int HT_Journal_Read(uint16_t first, HT_SampleRecord *records, uint16_t count) {
+    uint16_t flash_count = HT_Journal_FlashCount();
+
+    if (first < flash_count) {
+        if (count > flash_count - first)
+            count = flash_count - first;
+
+        return HT_Journal_FlashRead(first, records, count);
+    }
+
+    return HT_Ring_Read(HT_Journal_Ring(), first - flash_count, records, count);
+}
+
+void HT_Journal_Clear(void) {
+    HT_RetentionData *ret = HT_Retention_Get();
+
+    HT_Journal_FlashClear();
+    HT_Ring_Reset(&ret->sample_ring);
+
+    HT_Retention_Commit();
+}
+
+uint8_t HT_Journal_UploadDue(uint8_t retain) {
+    if (slpManGetWakeupSrc() == WAKEUP_FROM_POR || HT_EventWake_Triggered())
+        return 1;
+
+#if HT_QLOG_ENABLE == 1
+    if (retain)
+        return 0;
+#else
+    (void)retain;
+#endif
+
+    return HT_Journal_FlashCount() >= HT_JOURNAL_FLASH_CAPACITY;
+}
@@ -0,0 +1,115 @@
+#include "HT_Lz.h"
+
+// Longest earlier match for in[pos], nearest one on ties. Returns its length.
+static uint16_t HT_Lz_FindMatch(const uint8_t *in, uint16_t in_len, uint16_t pos, uint16_t *distance) {
+    uint16_t limit = in_len - pos;
+    uint16_t start = (pos > HT_LZ_WINDOW) ? pos - HT_LZ_WINDOW : 0;
+    uint16_t best = 0;
+    uint16_t len;
+
+    if (limit > HT_LZ_MAX_MATCH)
+        limit = HT_LZ_MAX_MATCH;
+
+    for (uint16_t cand = pos; cand-- > start && best < limit; ) {
+        if (in[cand] != in[pos] || in[cand + best] != in[pos + best])
+            continue;
+
+        // Overlapping matches are fine, the decoder copies byte by byte
+        for (len = 1; len < limit && in[cand + len] == in[pos + len]; ++len)
+            ;
+
+        if (len > best) {
+            best = len;
+            *distance = pos - cand;
+        }
+    }
+
+    return best;
+}
+
+int HT_Lz_Compress(const uint8_t *in, uint16_t in_len, uint8_t *out, uint16_t out_max) {
+    uint16_t pos = 0;
+    uint16_t o = HT_LZ_HEADER_SIZE;
+    uint16_t control = 0;
+    uint16_t distance = 0;
+    uint16_t len;
+    uint8_t bit = 8;
+
+    if (out_max < HT_LZ_HEADER_SIZE)
+        return HT_LZ_ERROR_FULL;
+
+    out[0] = HT_LZ_MAGIC;
+    out[1] = (uint8_t)in_len;
+    out[2] = (uint8_t)(in_len >> 8);
+
+    while (pos < in_len) {
+        // Worst case for this item: a new control byte and a match
+        if (o + 3 >= out_max)
+            return HT_LZ_ERROR_FULL;
+
+        if (bit == 8) {
+            control = o++;
+            out[control] = 0;
+            bit = 0;
+        }
+
+        len = HT_Lz_FindMatch(in, in_len, pos, &distance);
+        if (len >= HT_LZ_MIN_MATCH) {
+            out[control] |= 1 << bit;
+            out[o++] = (uint8_t)(distance - 1);
+            out[o++] = (uint8_t)(len - HT_LZ_MIN_MATCH);
+            pos += len;
+        } else {
+            out[o++] = in[pos++];
+        }
+
+        bit++;
+    }
+
+    return o;
+}
+
+int HT_Lz_Decompress(const uint8_t *in, uint16_t in_len, uint8_t *out, uint16_t out_max) {
+    uint16_t total, distance, len;
+    uint16_t i = HT_LZ_HEADER_SIZE;
+    uint16_t o = 0;
+    uint8_t control = 0;
+    uint8_t bit = 8;
+
+    if (in_len < HT_LZ_HEADER_SIZE || in[0] != HT_LZ_MAGIC)
+        return HT_LZ_ERROR_FORMAT;
+
+    total = in[1] | (uint16_t)in[2] << 8;
+    if (total > out_max)
+        return HT_LZ_ERROR_FULL;
+
+    while (o < total) {
+        if (bit == 8) {
+            if (i >= in_len)
+                return HT_LZ_ERROR_FORMAT;
+            control = in[i++];
+            bit = 0;
+        }
+
+        if (control & (1 << bit)) {
+            if (i + 2 > in_len)
+                return HT_LZ_ERROR_FORMAT;
+            distance = in[i++] + 1;
+            len = in[i++] + HT_LZ_MIN_MATCH;
+            if (distance > o || len > total - o)
+                return HT_LZ_ERROR_FORMAT;
+            while (len--) {
+                out[o] = out[o - distance];
+                o++;
+            }
+        } else {
+            if (i >= in_len)
+                return HT_LZ_ERROR_FORMAT;
+            out[o++] = in[i++];
+        }
+
+        bit++;
+    }
+
+    return o;
+}
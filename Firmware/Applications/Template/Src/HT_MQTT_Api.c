@@ -16,6 +16,7 @@
 #include "HT_MQTT_Api.h"
 #include "HT_SenseClima.h"
 #include "HT_MQTT_Tls.h"
+#include "HT_MQTT_Task.h"
 
 extern volatile uint8_t subscribe_callback;
 
@@ -25,6 +26,25 @@ static MQTTPacket_connectData connectData = MQTTPacket_connectData_initializer;
 static MqttClientContext mqtt_client_ctx;
 #endif
 
+// Sends CONNECT with the MQTT 5 properties; a version 4 connection ignores them.
+// cleansession = false only keeps the session in MQTT 5 with a Session Expiry Interval.
+static int HT_MQTT_SendConnect(MQTTClient *mqtt_client) {
+    MQTTProperty connect_props[2];
+    MQTTProperties props = {0, 2, 0, connect_props};
+    MQTTProperty prop;
+    MQTTConnackData connack;
+
+    prop.identifier = MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL;
+    prop.value.integer4 = HT_MQTT_SESSION_EXPIRY;
+    MQTTProperties_add(&props, &prop);
+
+    prop.identifier = MQTTPROPERTY_CODE_RECEIVE_MAXIMUM;
+    prop.value.integer2 = HT_MQTT_RECEIVE_MAXIMUM;
+    MQTTProperties_add(&props, &prop);
+
+    return MQTTV5ConnectWithResults(mqtt_client, &connectData, &props, NULL, &connack);
+}
+
 uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *addr, int32_t port, uint32_t send_timeout, uint32_t rcv_timeout, char *clientID, 
                                         char *username, char *password, uint8_t mqtt_version, uint32_t keep_alive_interval, uint8_t *sendbuf, 
                                         uint32_t sendbuf_size, uint8_t *readbuf, uint32_t readbuf_size) {
@@ -59,13 +79,16 @@ uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *ad
 
     MQTTClientInit(mqtt_client, mqtt_network, MQTT_GENERAL_TIMEOUT, (unsigned char *)sendbuf, sendbuf_size, (unsigned char *)readbuf, readbuf_size);
 
-    if ((MQTTConnect(mqtt_client, &connectData)) != 0) {
+    if ((HT_MQTT_SendConnect(mqtt_client)) != 0) {
         mqtt_client->ping_outstanding = 1;
         return 1;
     } else {
         mqtt_client->ping_outstanding = 0;
     }
 
+    if (HT_MQTT_Task_Start(mqtt_client) != HT_MQTT_TASK_OK)
+        return 1;
+
 #else
 
     NetworkInit(mqtt_network);
@@ -84,7 +107,7 @@ uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *ad
             return 1;
 
         } else {
-            if ((MQTTConnect(mqtt_client, &connectData)) != 0) {
+            if ((HT_MQTT_SendConnect(mqtt_client)) != 0) {
                 mqtt_client->ping_outstanding = 1;
                 return 1;
     
@@ -93,8 +116,9 @@ uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *ad
             }
         }
 
+        // From here on only the MQTT I/O task touches the socket
         if(mqtt_client->ping_outstanding == 0) {
-            if ((MQTTStartRECVTask(mqtt_client)) != SUCCESS){
+            if (HT_MQTT_Task_Start(mqtt_client) != HT_MQTT_TASK_OK){
                 return 1;
             }
         }
@@ -107,16 +131,20 @@ uint8_t HT_MQTT_Connect(MQTTClient *mqtt_client, Network *mqtt_network, char *ad
 
 int HT_MQTT_Publish(MQTTClient *mqtt_client, char *topic, uint8_t *payload, uint32_t len, enum QoS qos, uint8_t retained, uint16_t id, uint8_t dup) {
 
-    MQTTMessage message;
+    HT_MQTT_Command cmd;
 
-    message.qos = qos;
-    message.retained = retained;
-    message.id = id;
-    message.dup = dup;
-    message.payload = payload;
-    message.payloadlen = len;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = HT_MQTT_CMD_PUBLISH;
+    cmd.client = mqtt_client;
+    cmd.topic = topic;
+    cmd.message.qos = qos;
+    cmd.message.retained = retained;
+    cmd.message.id = id;
+    cmd.message.dup = dup;
+    cmd.message.payload = payload;
+    cmd.message.payloadlen = len;
 
-    return MQTTPublish(mqtt_client, topic, &message);
+    return HT_MQTT_Task_Call(&cmd);
 }
 
 void HT_MQTT_SubscribeCallback(MessageData *msg) {
@@ -132,7 +160,26 @@ void HT_MQTT_SubscribeCallback(MessageData *msg) {
 }
 
 void HT_MQTT_Subscribe(MQTTClient *mqtt_client, char *topic, enum QoS qos) {
-    MQTTSubscribe(mqtt_client, (const char *)topic, qos, HT_MQTT_SubscribeCallback);
+    HT_MQTT_Command cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = HT_MQTT_CMD_SUBSCRIBE;
+    cmd.client = mqtt_client;
+    cmd.topic = (const char *)topic;
+    cmd.qos = qos;
+    cmd.handler = HT_MQTT_SubscribeCallback;
+
+    HT_MQTT_Task_Call(&cmd);
+}
+
+int HT_MQTT_Disconnect(MQTTClient *mqtt_client) {
+    HT_MQTT_Command cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = HT_MQTT_CMD_DISCONNECT;
+    cmd.client = mqtt_client;
+
+    return HT_MQTT_Task_Call(&cmd);
 }
 
 /************************ HT Micron Semicondutores S.A *****END OF FILE****/
\ No newline at end of file
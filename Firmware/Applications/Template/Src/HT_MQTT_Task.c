@@ -0,0 +1,313 @@
+#include <string.h>
+#include "HT_MQTT_Task.h"
+#include "HT_MQTT_Api.h"    // For MQTT_TLS_ENABLE
+#include "cmsis_os2.h"
+
+static StaticTask_t mqtt_task_cb, mqtt_watch_cb;
+static uint8_t mqttTaskStack[HT_MQTT_TASK_STACK_SIZE], mqttWatchStack[HT_MQTT_WATCH_STACK_SIZE];
+
+static osThreadId_t mqtt_task_id = NULL;
+static osMessageQueueId_t mqtt_queue = NULL;
+static osSemaphoreId_t mqtt_watch_sem = NULL;   // Arms the watcher
+static osSemaphoreId_t mqtt_watch_done = NULL;  // Released each time the watcher leaves select()
+static volatile uint8_t mqtt_watch_stop = 0;    // Asks the watcher to give up the socket
+static volatile uint8_t mqtt_watch_arm = 0;     // Arm number, tags the readable events
+static osSemaphoreId_t mqtt_call_sem = NULL;    // Completion of HT_MQTT_Task_Call
+static osMutexId_t mqtt_call_mutex = NULL;
+static int mqtt_call_rc;
+
+// Client served by the tasks, set by HT_MQTT_Task_Start
+static MQTTClient *volatile mqtt_client = NULL;
+
+static void HT_MQTT_Task_CallDone(int rc, void *arg) {
+    mqtt_call_rc = rc;
+    osSemaphoreRelease(mqtt_call_sem);
+}
+
+// Sends the batch in as few writes as the buffer and the in-flight window allow.
+// Messages that could not be sent are failed here, the rest complete on their own.
+static int HT_MQTT_Task_PublishBatch(HT_MQTT_Command *cmd) {
+    MQTTBatchMessage *batch = cmd->batch;
+    uint8_t sent = 0;
+    int rc = SUCCESS;
+
+    while (sent < cmd->count) {
+        rc = MQTTPublishBatch(cmd->client, &batch[sent], cmd->count - sent, cmd->disconnect);
+        if (rc == WINDOW_FULL && cmd->client->isconnected) {
+            MQTTProcess(cmd->client, HT_MQTT_TASK_READ_MS);
+            continue;
+        }
+        if (rc < 0)
+            break;
+        sent += rc;
+    }
+
+    for (; sent < cmd->count; ++sent) {
+        if (batch[sent].fp != NULL)
+            batch[sent].fp(FAILURE, batch[sent].context);
+    }
+
+    return (rc < 0) ? FAILURE : SUCCESS;
+}
+
+static int HT_MQTT_Task_Exec(HT_MQTT_Command *cmd) {
+    int rc = SUCCESS;
+
+    switch (cmd->type) {
+    case HT_MQTT_CMD_PUBLISH:
+        rc = MQTTPublish(cmd->client, cmd->topic, &cmd->message);
+        break;
+    case HT_MQTT_CMD_PUBLISH_BATCH:
+        rc = HT_MQTT_Task_PublishBatch(cmd);
+        break;
+    case HT_MQTT_CMD_SUBSCRIBE:
+        rc = MQTTSubscribe(cmd->client, cmd->topic, cmd->qos, cmd->handler);
+        break;
+    case HT_MQTT_CMD_DISCONNECT:
+        rc = cmd->client->isconnected ? MQTTDisconnect(cmd->client) : SUCCESS;
+        break;
+    case HT_MQTT_CMD_READABLE:
+        if (mqtt_client->isconnected) {
+#if MQTT_TLS_ENABLE == 1
+            // Records already decrypted by mbedtls do not show up in select()
+            while (MQTTProcess(mqtt_client, HT_MQTT_TASK_READ_MS) > 0)
+                ;
+#else
+            // lwIP select() also reports data left from a partly read segment
+            MQTTProcess(mqtt_client, HT_MQTT_TASK_READ_MS);
+#endif
+        }
+        break;
+    default:
+        break;
+    }
+
+    return rc;
+}
+
+// QoS1 publish that completes from the PUBACK, so the next command does not wait
+// for the round trip. Returns SUCCESS once sent; the callback is called later.
+static int HT_MQTT_Task_PublishAsync(HT_MQTT_Command *cmd) {
+    int rc;
+
+    // Window full: PUBACKs are read here until a slot frees up
+    while ((rc = MQTTPublishAsync(cmd->client, cmd->topic, &cmd->message, cmd->done, cmd->arg)) == WINDOW_FULL &&
+           cmd->client->isconnected)
+        MQTTProcess(cmd->client, HT_MQTT_TASK_READ_MS);
+
+    return rc;
+}
+
+static void HT_MQTT_Task_Run(HT_MQTT_Command *cmd) {
+    int rc;
+
+    if (cmd->type == HT_MQTT_CMD_PUBLISH && cmd->message.qos == QOS1) {
+        rc = HT_MQTT_Task_PublishAsync(cmd);
+        if (rc == SUCCESS)
+            return;
+    } else {
+        rc = HT_MQTT_Task_Exec(cmd);
+    }
+
+    if (cmd->done != NULL)
+        cmd->done(rc, cmd->arg);
+}
+
+// Time until the keepalive or a publish retry needs attention, in ticks
+static uint32_t HT_MQTT_Task_Timeout(Timer *ping_wait, uint8_t *ping_started) {
+    MQTTClient *c = mqtt_client;
+    int left = -1;
+    int received, retry;
+
+    if (!c->isconnected)
+        return osWaitForever;
+
+    if (c->keepAliveInterval == 0) {
+        // No keepalive
+    } else if (c->ping_outstanding) {
+        if (!*ping_started) {
+            TimerCountdownMS(ping_wait, HT_MQTT_TASK_PING_WAIT_MS);
+            *ping_started = 1;
+        }
+        left = TimerLeftMS(ping_wait);
+    } else {
+        *ping_started = 0;
+        left = TimerLeftMS(&c->last_sent);
+        received = TimerLeftMS(&c->last_received);
+        if (received < left)
+            left = received;
+    }
+
+    retry = MQTTInflightLeftMS(c);
+    if (retry >= 0 && (left < 0 || retry < left))
+        left = retry;
+
+    return (left < 0) ? osWaitForever : pdMS_TO_TICKS(left);
+}
+
+// Waits for the watcher to leave select() without posting, so the socket can be
+// closed or replaced. Runs in the I/O task.
+static void HT_MQTT_Task_StopWatch(uint8_t *watching) {
+    if (!*watching)
+        return;
+
+    mqtt_watch_stop = 1;
+    osSemaphoreAcquire(mqtt_watch_done, osWaitForever);
+    mqtt_watch_stop = 0;
+    *watching = 0;
+}
+
+static void HT_MQTT_TaskThread(void *arg) {
+    HT_MQTT_Command cmd;
+    Timer ping_wait;
+    uint8_t ping_started = 0;
+    uint8_t attached = 0;           // The socket of mqtt_client belongs to this task
+    uint8_t watching = 0;           // The watcher is in select()
+
+    TimerInit(&ping_wait);
+
+    while (1) {
+        if (osMessageQueueGet(mqtt_queue, &cmd, NULL, HT_MQTT_Task_Timeout(&ping_wait, &ping_started)) == osOK) {
+            if (cmd.type == HT_MQTT_CMD_ATTACH) {
+                // Reconnect: the watcher may still be on the previous socket
+                HT_MQTT_Task_StopWatch(&watching);
+                attached = 1;
+            } else if (cmd.type == HT_MQTT_CMD_READABLE) {
+                // Posted just as the watcher was stopped: its socket is gone
+                if (!watching || cmd.count != mqtt_watch_arm)
+                    continue;
+                osSemaphoreAcquire(mqtt_watch_done, osWaitForever);
+                watching = 0;
+            }
+            HT_MQTT_Task_Run(&cmd);
+        } else {
+            // Keepalive or retry due: sends PINGREQ or resends overdue publishes,
+            // and drops the session if PINGRESP never came
+            MQTTProcess(mqtt_client, HT_MQTT_TASK_READ_MS);
+        }
+
+        if (!attached)
+            continue;
+
+        if (!mqtt_client->isconnected) {
+            // Closed here so the next HT_MQTT_Connect starts from a fresh socket
+            HT_MQTT_Task_StopWatch(&watching);
+            mqtt_client->ipstack->disconnect(mqtt_client->ipstack);
+            attached = 0;
+        } else if (!watching) {
+            watching = 1;
+            mqtt_watch_arm++;
+            osSemaphoreRelease(mqtt_watch_sem);
+        }
+    }
+}
+
+static void HT_MQTT_WatchThread(void *arg) {
+    HT_MQTT_Command event;
+    struct timeval tv;
+    fd_set read_set, error_set;
+    int fd, ret;
+
+    memset(&event, 0, sizeof(event));
+    event.type = HT_MQTT_CMD_READABLE;
+
+    while (1) {
+        osSemaphoreAcquire(mqtt_watch_sem, osWaitForever);
+        event.count = mqtt_watch_arm;
+        fd = mqtt_client->ipstack->my_socket;
+
+        do {
+            FD_ZERO(&read_set);
+            FD_ZERO(&error_set);
+            FD_SET(fd, &read_set);
+            FD_SET(fd, &error_set);
+            tv.tv_sec = HT_MQTT_WATCH_POLL_MS / 1000;
+            tv.tv_usec = (HT_MQTT_WATCH_POLL_MS % 1000) * 1000;
+
+            ret = select(fd + 1, &read_set, NULL, &error_set, &tv);
+        } while (ret == 0 && !mqtt_watch_stop);
+
+        // Errors are posted too, the I/O task sees them on its next read. A
+        // full queue is retried so a stop request is not missed meanwhile.
+        while (!mqtt_watch_stop &&
+               osMessageQueuePut(mqtt_queue, &event, 0, pdMS_TO_TICKS(HT_MQTT_WATCH_POLL_MS)) != osOK)
+            ;
+
+        // Done with fd: the I/O task may close it from here on
+        osSemaphoreRelease(mqtt_watch_done);
+    }
+}
+
+static osThreadId_t HT_MQTT_Task_Create(const char *name, osThreadFunc_t func, StaticTask_t *cb, uint8_t *stack, uint32_t stack_size) {
+    osThreadAttr_t task_attr;
+
+    memset(&task_attr, 0, sizeof(task_attr));
+    memset(stack, 0xA5, stack_size);
+    task_attr.name = name;
+    task_attr.stack_mem = stack;
+    task_attr.stack_size = stack_size;
+    task_attr.priority = osPriorityNormal;
+    task_attr.cb_mem = cb;
+    task_attr.cb_size = sizeof(StaticTask_t);
+
+    return osThreadNew(func, NULL, &task_attr);
+}
+
+int HT_MQTT_Task_Start(MQTTClient *client) {
+    HT_MQTT_Command cmd;
+
+    if (mqtt_task_id == NULL) {
+        mqtt_queue = osMessageQueueNew(HT_MQTT_TASK_QUEUE_SIZE, sizeof(HT_MQTT_Command), NULL);
+        mqtt_watch_sem = osSemaphoreNew(1, 0, NULL);
+        mqtt_watch_done = osSemaphoreNew(1, 0, NULL);
+        mqtt_call_sem = osSemaphoreNew(1, 0, NULL);
+        mqtt_call_mutex = osMutexNew(NULL);
+        mqtt_client = client;
+
+        mqtt_task_id = HT_MQTT_Task_Create("mqtt_task", HT_MQTT_TaskThread, &mqtt_task_cb, mqttTaskStack, sizeof(mqttTaskStack));
+        HT_MQTT_Task_Create("mqtt_watch", HT_MQTT_WatchThread, &mqtt_watch_cb, mqttWatchStack, sizeof(mqttWatchStack));
+    }
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = HT_MQTT_CMD_ATTACH;
+    cmd.client = client;
+
+    return HT_MQTT_Task_Post(&cmd);
+}
+
+int HT_MQTT_Task_Post(const HT_MQTT_Command *cmd) {
+    if (mqtt_task_id == NULL)
+        return HT_MQTT_TASK_ERROR_STOPPED;
+
+    if (osMessageQueuePut(mqtt_queue, cmd, 0, 0) != osOK)
+        return HT_MQTT_TASK_ERROR_FULL;
+
+    return HT_MQTT_TASK_OK;
+}
+
+int HT_MQTT_Task_Call(HT_MQTT_Command *cmd) {
+    int rc;
+
+    if (mqtt_task_id == NULL)
+        return FAILURE;
+
+    // A handler running in the I/O task would wait for itself
+    if (osThreadGetId() == mqtt_task_id)
+        return HT_MQTT_Task_Exec(cmd);
+
+    osMutexAcquire(mqtt_call_mutex, osWaitForever);
+
+    cmd->done = HT_MQTT_Task_CallDone;
+    cmd->arg = NULL;
+
+    if (osMessageQueuePut(mqtt_queue, cmd, 0, osWaitForever) == osOK) {
+        osSemaphoreAcquire(mqtt_call_sem, osWaitForever);
+        rc = mqtt_call_rc;
+    } else {
+        rc = FAILURE;
+    }
+
+    osMutexRelease(mqtt_call_mutex);
+
+    return rc;
+}
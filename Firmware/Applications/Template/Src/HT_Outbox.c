@@ -0,0 +1,173 @@
+#include <stddef.h>
+#include <string.h>
+#include "HT_Outbox.h"
+#include "HT_Retention.h"
+#include "HT_SampleRing.h"  // For HT_Ring_Crc16
+#include "osasys.h"
+#include "slpman_qcx212.h"
+
+static OSAFILE HT_Outbox_Open(void) {
+    OSAFILE fp = OsaFopen(HT_OUTBOX_FILE, "rb+");
+
+    if (fp == PNULL)
+        fp = OsaFopen(HT_OUTBOX_FILE, "wb+");
+
+    return fp;
+}
+
+static uint16_t HT_Outbox_Crc(HT_OutboxMessage *msg) {
+    uint16_t saved = msg->crc;
+    uint16_t crc;
+
+    msg->crc = 0;
+    crc = HT_Ring_Crc16(0xFFFF, (const uint8_t *)msg, offsetof(HT_OutboxMessage, payload) + msg->len);
+    msg->crc = saved;
+
+    return crc;
+}
+
+static int HT_Outbox_ReadSlot(OSAFILE fp, uint16_t slot, HT_OutboxMessage *msg) {
+    if (OsaFseek(fp, (INT32)slot * sizeof(HT_OutboxMessage), SEEK_SET) != 0 ||
+        OsaFread(msg, sizeof(HT_OutboxMessage), 1, fp) != 1)
+        return HT_OUTBOX_ERROR_CORRUPT;
+
+    if (msg->len > HT_OUTBOX_PAYLOAD_MAX || msg->crc != HT_Outbox_Crc(msg))
+        return HT_OUTBOX_ERROR_CORRUPT;
+
+    return HT_OUTBOX_OK;
+}
+
+// Queue position, continuing the sequence after the newest slot in the file
+// when the retention area was formatted. Messages queued before are abandoned.
+static HT_OutboxState *HT_Outbox_State(void) {
+    HT_OutboxState *state = &HT_Retention_Get()->outbox;
+    static uint8_t resumed = 0;
+    static HT_OutboxMessage msg;
+    OSAFILE fp;
+
+    if (state->next_seq != 0 && state->first < HT_OUTBOX_SLOTS && state->count <= HT_OUTBOX_SLOTS) {
+        // After a power loss the checkpoint may lag behind numbers already sent
+        if (!resumed && slpManGetWakeupSrc() == WAKEUP_FROM_POR)
+            state->next_seq = state->seq_limit;
+        resumed = 1;
+        return state;
+    }
+
+    resumed = 1;
+    memset(state, 0, sizeof(HT_OutboxState));
+    state->next_seq = 1;
+
+    fp = OsaFopen(HT_OUTBOX_FILE, "rb");
+    if (fp != PNULL) {
+        for (uint16_t slot = 0; slot < HT_OUTBOX_SLOTS; ++slot) {
+            if (HT_Outbox_ReadSlot(fp, slot, &msg) == HT_OUTBOX_OK && (int32_t)(msg.seq - state->next_seq) >= 0)
+                state->next_seq = msg.seq + 1;
+        }
+        OsaFclose(fp);
+    }
+
+    state->seq_limit = state->next_seq;
+    HT_Retention_Commit();
+
+    return state;
+}
+
+uint32_t HT_Outbox_NextSeq(void) {
+    HT_OutboxState *state = HT_Outbox_State();
+
+    // Moved on with half a block left, so the numbers taken in this wake stay
+    // below the limit of the previous checkpoint should this one never be written
+    if ((int32_t)(state->seq_limit - state->next_seq) <= HT_OUTBOX_SEQ_BLOCK / 2) {
+        state->seq_limit = state->next_seq + HT_OUTBOX_SEQ_BLOCK;
+        HT_Retention_Commit();
+    }
+
+    return state->next_seq++;
+}
+
+int HT_Outbox_Push(uint32_t seq, uint8_t topic, const uint8_t *payload, uint16_t len) {
+    HT_OutboxState *state = HT_Outbox_State();
+    static HT_OutboxMessage msg;
+    uint16_t slot;
+    OSAFILE fp;
+    int ret = HT_OUTBOX_OK;
+
+    if (len > HT_OUTBOX_PAYLOAD_MAX)
+        return HT_OUTBOX_ERROR_SIZE;
+
+    memset(&msg, 0, offsetof(HT_OutboxMessage, payload));
+    msg.seq = seq;
+    msg.topic = topic;
+    msg.len = len;
+    memcpy(msg.payload, payload, len);
+    msg.crc = HT_Outbox_Crc(&msg);
+
+    fp = HT_Outbox_Open();
+    if (fp == PNULL)
+        return HT_OUTBOX_ERROR_OPEN;
+
+    // Full: the oldest message makes room
+    if (state->count == HT_OUTBOX_SLOTS) {
+        if (++state->first == HT_OUTBOX_SLOTS)
+            state->first = 0;
+        state->count--;
+        if (state->dropped < 0xFFFF)
+            state->dropped++;
+    }
+
+    slot = state->first + state->count;
+    if (slot >= HT_OUTBOX_SLOTS)
+        slot -= HT_OUTBOX_SLOTS;
+
+    if (OsaFseek(fp, (INT32)slot * sizeof(HT_OutboxMessage), SEEK_SET) != 0 ||
+        OsaFwrite(&msg, sizeof(HT_OutboxMessage), 1, fp) != 1) {
+        ret = HT_OUTBOX_ERROR_WRITE;
+    } else {
+        state->count++;
+    }
+
+    OsaFclose(fp);
+    HT_Retention_Commit();
+
+    return ret;
+}
+
+uint16_t HT_Outbox_Count(void) {
+    return HT_Outbox_State()->count;
+}
+
+int HT_Outbox_Peek(uint16_t index, HT_OutboxMessage *msg) {
+    HT_OutboxState *state = HT_Outbox_State();
+    uint16_t slot;
+    OSAFILE fp;
+    int ret;
+
+    if (index >= state->count)
+        return HT_OUTBOX_ERROR_EMPTY;
+
+    slot = state->first + index;
+    if (slot >= HT_OUTBOX_SLOTS)
+        slot -= HT_OUTBOX_SLOTS;
+
+    fp = OsaFopen(HT_OUTBOX_FILE, "rb");
+    if (fp == PNULL)
+        return HT_OUTBOX_ERROR_OPEN;
+
+    ret = HT_Outbox_ReadSlot(fp, slot, msg);
+    OsaFclose(fp);
+
+    return ret;
+}
+
+void HT_Outbox_Pop(void) {
+    HT_OutboxState *state = HT_Outbox_State();
+
+    if (state->count == 0)
+        return;
+
+    if (++state->first == HT_OUTBOX_SLOTS)
+        state->first = 0;
+    state->count--;
+
+    HT_Retention_Commit();
+}
@@ -0,0 +1,235 @@
+#include <string.h>
+#include "HT_QLog.h"
+#include "mem_map.h"
+#include "flash_qcx212_rt.h"
+
+#define HT_QLOG_MAGIC           0x474F4C51      // "QLOG"
+#define HT_QLOG_COMMITTED       0x0000          // Commit word after programming, erased flash reads 0xFFFF
+#define HT_QLOG_FLAG_TAIL       0x0001          // Cleared (programmed to 0) when the sector starts a new tail
+
+#if HT_QLOG_REGION_OFFSET < FLASH_FOTA_REGION_END || \
+    HT_QLOG_REGION_OFFSET + HT_QLOG_REGION_SIZE > FLASH_MEM_BACKUP_ADDR - FLASH_XIP_ADDR
+#error "HT_QLog region overlaps the FOTA or PMU backup area"
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t erase_count;
+    uint16_t flags;
+    uint16_t commit;
+} HT_QLogHeader;
+
+typedef struct {
+    HT_SampleRecord sample;
+    uint16_t crc;
+    uint8_t reserved[4];
+    uint16_t commit;
+} HT_QLogSlot;
+
+typedef char HT_QLogHeaderSizeCheck[(sizeof(HT_QLogHeader) == HT_QLOG_SLOT_SIZE) ? 1 : -1];
+typedef char HT_QLogSlotSizeCheck[(sizeof(HT_QLogSlot) == HT_QLOG_SLOT_SIZE) ? 1 : -1];
+
+static uint32_t HT_QLog_Addr(uint8_t sector, uint16_t slot) {
+    return HT_QLOG_REGION_OFFSET + (uint32_t)sector * HT_QLOG_SECTOR_SIZE + (uint32_t)slot * HT_QLOG_SLOT_SIZE;
+}
+
+// Physical sector holding sequence number seq, relative to the head.
+static uint8_t HT_QLog_Sector(const HT_QLogState *state, uint32_t seq) {
+    return (uint8_t)((state->head + HT_QLOG_SECTORS - (state->head_seq - seq) % HT_QLOG_SECTORS) % HT_QLOG_SECTORS);
+}
+
+static uint8_t HT_QLog_ReadSlot(uint8_t sector, uint16_t slot, void *data) {
+    return BSP_QSPI_Read_Safe((uint8_t *)data, HT_QLog_Addr(sector, slot), HT_QLOG_SLOT_SIZE) == QSPI_OK;
+}
+
+static uint8_t HT_QLog_IsErased(const uint8_t *data) {
+    for (uint8_t i = 0; i < HT_QLOG_SLOT_SIZE; ++i) {
+        if (data[i] != 0xFF)
+            return 0;
+    }
+
+    return 1;
+}
+
+// Programs a slot body, then its commit word.
+static int HT_QLog_Program(uint32_t addr, void *slot) {
+    uint16_t commit = HT_QLOG_COMMITTED;
+
+    if (BSP_QSPI_Write_Safe((uint8_t *)slot, addr, HT_QLOG_SLOT_SIZE - sizeof(uint16_t)) != QSPI_OK ||
+        BSP_QSPI_Write_Safe((uint8_t *)&commit, addr + HT_QLOG_SLOT_SIZE - sizeof(uint16_t), sizeof(uint16_t)) != QSPI_OK)
+        return HT_QLOG_ERROR_FLASH;
+
+    return HT_QLOG_OK;
+}
+
+// Erases the sector after the head and makes it the new head.
+static int HT_QLog_Rotate(HT_QLogState *state, uint8_t tail) {
+    HT_QLogHeader header;
+    uint8_t next = (state->head + 1) % HT_QLOG_SECTORS;
+    uint32_t erase_count = 0;
+
+    if (HT_QLog_ReadSlot(next, 0, &header) && header.magic == HT_QLOG_MAGIC && header.erase_count != 0xFFFFFFFF)
+        erase_count = header.erase_count;
+
+    if (BSP_QSPI_Erase_Safe(HT_QLog_Addr(next, 0), HT_QLOG_SECTOR_SIZE) != QSPI_OK)
+        return HT_QLOG_ERROR_FLASH;
+
+    memset(&header, 0xFF, sizeof(header));
+    header.magic = HT_QLOG_MAGIC;
+    header.seq = state->head_seq + 1;
+    header.erase_count = erase_count + 1;
+    if (tail)
+        header.flags &= ~HT_QLOG_FLAG_TAIL;
+
+    if (HT_QLog_Program(HT_QLog_Addr(next, 0), &header) != HT_QLOG_OK)
+        return HT_QLOG_ERROR_FLASH;
+
+    state->head = next;
+    state->head_seq++;
+    state->head_slot = 1;
+
+    if (tail) {
+        state->tail_seq = state->head_seq;
+        state->tail_slot = 1;
+        state->dropped = 0;
+    } else if (state->head_seq - state->tail_seq >= HT_QLOG_SECTORS) {
+        // The oldest sector was just erased
+        state->dropped += (HT_QLOG_SECTOR_RECORDS + 1) - state->tail_slot;
+        state->tail_seq = state->head_seq - HT_QLOG_SECTORS + 1;
+        state->tail_slot = 1;
+    }
+
+    return HT_QLOG_OK;
+}
+
+void HT_QLog_Init(HT_QLogState *state) {
+    HT_QLogHeader header;
+    uint8_t slot[HT_QLOG_SLOT_SIZE];
+    uint32_t tail_seq = 0;
+    uint32_t oldest_seq = 0;
+    uint8_t found = 0;
+    uint16_t lo, hi, mid;
+
+    if (state->valid)
+        return;
+
+    memset(state, 0, sizeof(*state));
+
+    // Newest committed header is the head, newest tail flag (or the oldest
+    // surviving sector) is the tail
+    for (uint8_t i = 0; i < HT_QLOG_SECTORS; ++i) {
+        if (!HT_QLog_ReadSlot(i, 0, &header) || header.magic != HT_QLOG_MAGIC || header.commit != HT_QLOG_COMMITTED)
+            continue;
+
+        if (!found || (int32_t)(header.seq - state->head_seq) > 0) {
+            state->head = i;
+            state->head_seq = header.seq;
+        }
+        if (!found || (int32_t)(header.seq - oldest_seq) < 0)
+            oldest_seq = header.seq;
+        if (!(header.flags & HT_QLOG_FLAG_TAIL) && (int32_t)(header.seq - tail_seq) > 0)
+            tail_seq = header.seq;
+        found = 1;
+    }
+
+    if (!found) {
+        // Empty region: nothing pending, the first append opens sector 0
+        state->head = HT_QLOG_SECTORS - 1;
+        state->head_slot = HT_QLOG_SLOTS;
+        state->tail_slot = HT_QLOG_SLOTS;
+        state->valid = 1;
+        return;
+    }
+
+    if ((int32_t)(oldest_seq - tail_seq) > 0)
+        tail_seq = oldest_seq;
+    state->tail_seq = tail_seq;
+    state->tail_slot = 1;
+
+    // Slots are written in order, find the first erased one
+    lo = 1;
+    hi = HT_QLOG_SLOTS;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (HT_QLog_ReadSlot(state->head, mid, slot) && HT_QLog_IsErased(slot))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    state->head_slot = lo;
+    state->valid = 1;
+}
+
+int HT_QLog_Append(HT_QLogState *state, const HT_SampleRecord *record) {
+    HT_QLogSlot slot;
+    int ret;
+
+    if (state->head_slot >= HT_QLOG_SLOTS) {
+        ret = HT_QLog_Rotate(state, 0);
+        if (ret != HT_QLOG_OK)
+            return ret;
+    }
+
+    // A position older than the flash content (retention not saved after the
+    // last append) would program over a used slot: rescan instead
+    if (!HT_QLog_ReadSlot(state->head, state->head_slot, &slot) || !HT_QLog_IsErased((const uint8_t *)&slot)) {
+        state->valid = 0;
+        HT_QLog_Init(state);
+        if (state->head_slot >= HT_QLOG_SLOTS) {
+            ret = HT_QLog_Rotate(state, 0);
+            if (ret != HT_QLOG_OK)
+                return ret;
+        }
+    }
+
+    memset(&slot, 0xFF, sizeof(slot));
+    slot.sample = *record;
+    slot.crc = HT_Ring_Crc16(0xFFFF, (const uint8_t *)record, sizeof(HT_SampleRecord));
+
+    // The slot is used even if programming failed half-way
+    ret = HT_QLog_Program(HT_QLog_Addr(state->head, state->head_slot), &slot);
+    state->head_slot++;
+
+    return ret;
+}
+
+uint16_t HT_QLog_Count(const HT_QLogState *state) {
+    return (uint16_t)((state->head_seq - state->tail_seq) * HT_QLOG_SECTOR_RECORDS + state->head_slot - state->tail_slot);
+}
+
+int HT_QLog_Read(const HT_QLogState *state, uint16_t first, HT_SampleRecord *records, uint16_t count) {
+    HT_QLogSlot slot;
+    uint16_t total = HT_QLog_Count(state);
+    uint32_t pos;
+    uint8_t sector;
+    uint16_t n = 0;
+
+    while (n < count && first + n < total) {
+        // Position counted from the first record slot of the tail sector
+        pos = (uint32_t)state->tail_slot - 1 + first + n;
+        sector = HT_QLog_Sector(state, state->tail_seq + pos / HT_QLOG_SECTOR_RECORDS);
+
+        if (!HT_QLog_ReadSlot(sector, 1 + pos % HT_QLOG_SECTOR_RECORDS, &slot))
+            return HT_QLOG_ERROR_FLASH;
+
+        records[n] = slot.sample;
+        if (slot.commit != HT_QLOG_COMMITTED ||
+            slot.crc != HT_Ring_Crc16(0xFFFF, (const uint8_t *)&slot.sample, sizeof(HT_SampleRecord))) {
+            // Torn write, keep the time of the previous record so the batch stays compact
+            records[n].time = n ? records[n - 1].time : 0;
+            records[n].temperature = HT_SAMPLE_NO_VALUE;
+            records[n].humidity = HT_SAMPLE_NO_VALUE;
+        }
+        n++;
+    }
+
+    return n;
+}
+
+int HT_QLog_Clear(HT_QLogState *state) {
+    if (HT_QLog_Count(state) == 0)
+        return HT_QLOG_OK;
+
+    return HT_QLog_Rotate(state, 1);
+}
@@ -0,0 +1,144 @@
+#include "HT_Report.h"
+#include "HT_SampleRing.h"  // For HT_SAMPLE_NO_VALUE
+
+static uint8_t HT_Report_Exceeds(int16_t value, int16_t sent, int16_t deadband) {
+    int32_t diff;
+
+    if (deadband <= 0 || value == HT_SAMPLE_NO_VALUE)
+        return 0;
+
+    // A value after a missing one is news
+    if (sent == HT_SAMPLE_NO_VALUE)
+        return 1;
+
+    diff = (int32_t)value - sent;
+    if (diff < 0)
+        diff = -diff;
+
+    return diff >= deadband;
+}
+
+// Parses len decimal digits. Returns 0 on a non-digit.
+static uint8_t HT_Report_ParseUInt(const uint8_t *s, uint8_t len, uint32_t *value) {
+    uint32_t v = 0;
+
+    if (len == 0 || len > 9)
+        return 0;
+
+    for (uint8_t i = 0; i < len; ++i) {
+        if (s[i] < '0' || s[i] > '9')
+            return 0;
+        v = v * 10 + (s[i] - '0');
+    }
+
+    *value = v;
+
+    return 1;
+}
+
+// Parses DDHHMMSS into seconds.
+static uint8_t HT_Report_ParseDuration(const uint8_t *s, uint8_t len, uint32_t *seconds) {
+    uint32_t dd, hh, mm, ss;
+
+    if (len != 8 ||
+        !HT_Report_ParseUInt(&s[0], 2, &dd) || !HT_Report_ParseUInt(&s[2], 2, &hh) ||
+        !HT_Report_ParseUInt(&s[4], 2, &mm) || !HT_Report_ParseUInt(&s[6], 2, &ss))
+        return 0;
+
+    *seconds = ((dd * 24 + hh) * 60 + mm) * 60 + ss;
+
+    return 1;
+}
+
+void HT_Report_Defaults(HT_ReportConfig *config) {
+    config->deadband_temp = HT_REPORT_DEADBAND_TEMP;
+    config->deadband_hum = HT_REPORT_DEADBAND_HUM;
+    config->heartbeat_s = HT_REPORT_HEARTBEAT_S;
+}
+
+void HT_Report_Reset(HT_ReportState *state) {
+    state->sent_temp = HT_SAMPLE_NO_VALUE;
+    state->sent_hum = HT_SAMPLE_NO_VALUE;
+    state->sent_time = 0;
+    state->retry_time = 0;
+    state->has_sent = 0;
+    state->failures = 0;
+}
+
+uint8_t HT_Report_Due(const HT_ReportConfig *config, const HT_ReportState *state, int16_t temperature, int16_t humidity, uint32_t now) {
+    if (!state->has_sent)
+        return 1;
+
+    if (now - state->sent_time >= config->heartbeat_s)
+        return 1;
+
+    return HT_Report_Exceeds(temperature, state->sent_temp, config->deadband_temp) ||
+           HT_Report_Exceeds(humidity, state->sent_hum, config->deadband_hum);
+}
+
+void HT_Report_Sent(HT_ReportState *state, int16_t temperature, int16_t humidity, uint32_t now) {
+    state->sent_temp = temperature;
+    state->sent_hum = humidity;
+    state->sent_time = now;
+    state->has_sent = 1;
+    state->failures = 0;
+}
+
+void HT_Report_Failed(HT_ReportState *state, uint32_t now) {
+    uint32_t backoff = HT_REPORT_BACKOFF_MIN_S;
+
+    if (state->failures < UINT8_MAX)
+        state->failures++;
+
+    for (uint8_t i = 1; i < state->failures && backoff < HT_REPORT_BACKOFF_MAX_S; ++i)
+        backoff *= 2;
+    if (backoff > HT_REPORT_BACKOFF_MAX_S)
+        backoff = HT_REPORT_BACKOFF_MAX_S;
+
+    state->retry_time = now + backoff;
+}
+
+uint8_t HT_Report_BackingOff(const HT_ReportState *state, uint32_t now) {
+    return state->failures != 0 && (int32_t)(now - state->retry_time) < 0;
+}
+
+int HT_Report_Configure(HT_ReportConfig *config, const uint8_t *payload, uint8_t len) {
+    HT_ReportConfig cfg = *config;
+    uint8_t pos = 0;
+    uint8_t end;
+    uint32_t value;
+
+    while (pos < len) {
+        // Stop at the terminator some brokers leave in the buffer
+        if (payload[pos] == '\0')
+            break;
+
+        for (end = pos; end < len && payload[end] != ',' && payload[end] != '\0'; ++end)
+            ;
+
+        if (end - pos < 4 || payload[pos + 2] != '=')
+            return HT_REPORT_ERROR_SYNTAX;
+
+        if (payload[pos] == 'h' && payload[pos + 1] == 'b') {
+            if (!HT_Report_ParseDuration(&payload[pos + 3], end - pos - 3, &value) ||
+                value == 0 || value > HT_REPORT_HEARTBEAT_MAX_S)
+                return HT_REPORT_ERROR_SYNTAX;
+            cfg.heartbeat_s = value;
+        } else if (payload[pos] == 'd' && (payload[pos + 1] == 't' || payload[pos + 1] == 'h')) {
+            if (!HT_Report_ParseUInt(&payload[pos + 3], end - pos - 3, &value) || value > INT16_MAX)
+                return HT_REPORT_ERROR_SYNTAX;
+            if (payload[pos + 1] == 't')
+                cfg.deadband_temp = (int16_t)value;
+            else
+                cfg.deadband_hum = (int16_t)value;
+        } else {
+            return HT_REPORT_ERROR_SYNTAX;
+        }
+
+        pos = (end < len && payload[end] == ',') ? end + 1 : end;
+    }
+
+    *config = cfg;
+
+    return HT_REPORT_OK;
+}
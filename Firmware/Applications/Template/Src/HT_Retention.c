@@ -0,0 +1,28 @@
+#include "HT_Retention.h"
+#include "slpman_qcx212.h"
+#include <string.h>
+
+static HT_RetentionData *retention = NULL;
+
+HT_RetentionData *HT_Retention_Get(void) {
+    if (retention != NULL)
+        return retention;
+
+    retention = (HT_RetentionData *)slpManGetUsrNVMem();
+
+    if (retention->magic != HT_RETENTION_MAGIC || retention->version != HT_RETENTION_VERSION ||
+        retention->size != sizeof(HT_RetentionData)) {
+        memset(retention, 0, sizeof(HT_RetentionData));
+        retention->magic = HT_RETENTION_MAGIC;
+        retention->version = HT_RETENTION_VERSION;
+        retention->size = sizeof(HT_RetentionData);
+        HT_Report_Reset(&retention->report);
+        HT_Retention_Commit();
+    }
+
+    return retention;
+}
+
+void HT_Retention_Commit(void) {
+    slpManUpdateUserNVMem();
+}
@@ -0,0 +1,160 @@
+#include "HT_SHT3x.h"
+#include "htnb32lxxx_hal_i2c.h"
+#include "cmsis_os2.h"
+
+extern I2C_HandleTypeDef hi2c1;
+
+// CRC-8, polynomial 0x31, init 0xFF, as specified by Sensirion.
+static uint8_t SHT3x_Crc8(const uint8_t *data, uint8_t len) {
+    uint8_t crc = 0xFF;
+
+    for (uint8_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+
+    return crc;
+}
+
+// The SDK transfer calls (HAL_I2C_Master*_IT) busy-wait on the FIFO and bus
+// flags with no exit, so a missing or hung sensor would stall the acquisition
+// task forever. The same register sequence is issued here with every wait
+// bounded by SHT3X_I2C_TIMEOUT_MS.
+
+// Deadline check against the kernel tick, the scheduler keeps running.
+static uint8_t SHT3x_Expired(uint32_t start) {
+    return (osKernelGetTickCount() - start) * 1000U / osKernelGetTickFreq() >= SHT3X_I2C_TIMEOUT_MS;
+}
+
+// Non-zero on NACK, bus error or lost arbitration.
+static uint8_t SHT3x_BusError(void) {
+    return (hi2c1.reg->ISR & (I2C_ISR_ARBITRATATION_LOST_Msk | I2C_ISR_BUS_ERROR_Msk | I2C_ISR_RX_NACK_Msk)) != 0;
+}
+
+// Leaves the controller ready for the next transfer.
+static int SHT3x_EndTransfer(int ret) {
+    if (ret != HT_SENSOR_OK) {
+        hi2c1.reg->ISR = hi2c1.reg->ISR;
+        hi2c1.reg->SCR |= (I2C_SCR_FLUSH_TX_FIFO_Msk | I2C_SCR_FLUSH_RX_FIFO_Msk);
+    }
+
+    hi2c1.reg->IER = 0;
+    hi2c1.ctrl->status.busy = 0;
+
+    return ret;
+}
+
+static void SHT3x_StartTransfer(uint32_t size, uint32_t read) {
+    hi2c1.reg->IER = (I2C_IER_TRANSFER_DONE_Msk | I2C_IER_ARBITRATATION_LOST_Msk | I2C_IER_DETECT_STOP_Msk |
+                      I2C_IER_BUS_ERROR_Msk | I2C_IER_RX_NACK_Msk);
+    hi2c1.reg->ISR = hi2c1.reg->ISR;
+    hi2c1.reg->MCR = (I2C_MCR_CONTROL_MODE_Msk | I2C_MCR_I2C_EN_Msk);
+    hi2c1.reg->SCR = (((SHT3X_I2C_ADDR << 1) & I2C_SCR_TARGET_SLAVE_ADDR_Msk) | ((size - 1) << I2C_SCR_BYTE_NUM_Pos) |
+                      read | I2C_SCR_START_Msk);
+}
+
+static int SHT3x_SendCommand(uint16_t cmd) {
+    uint8_t buf[2] = {(uint8_t)(cmd >> 8), (uint8_t)cmd};
+    uint32_t start = osKernelGetTickCount();
+
+    SHT3x_StartTransfer(sizeof(buf), 0);
+
+    for (uint8_t i = 0; i < sizeof(buf); ++i) {
+        while ((hi2c1.reg->FSR & I2C_FSR_TX_FIFO_FREE_NUM_Msk) == 0) {
+            if (SHT3x_BusError())
+                return SHT3x_EndTransfer(SHT3X_ERROR_I2C);
+            if (SHT3x_Expired(start))
+                return SHT3x_EndTransfer(SHT3X_ERROR_TIMEOUT);
+        }
+        hi2c1.reg->TDR = buf[i];
+    }
+
+    // Address and data acknowledged once the FIFO drained and the STOP went out
+    while (QCOM_FLD2VAL(I2C_FSR_TX_FIFO_FREE_NUM, hi2c1.reg->FSR) != 0x10 ||
+           (hi2c1.reg->ISR & I2C_ISR_DETECT_STOP_Msk) == 0) {
+        if (SHT3x_BusError())
+            return SHT3x_EndTransfer(SHT3X_ERROR_I2C);
+        if (SHT3x_Expired(start))
+            return SHT3x_EndTransfer(SHT3X_ERROR_TIMEOUT);
+    }
+    hi2c1.reg->ISR = I2C_ISR_DETECT_STOP_Msk;
+
+    return SHT3x_EndTransfer(HT_SENSOR_OK);
+}
+
+// A NACK before the first byte means no answer; a stall after it, a timeout.
+static int SHT3x_Receive(uint8_t *rx, uint8_t size) {
+    uint32_t start = osKernelGetTickCount();
+
+    SHT3x_StartTransfer(size, I2C_SCR_TARGET_RWN_Msk);
+
+    for (uint8_t i = 0; i < size; ++i) {
+        while ((hi2c1.reg->FSR & I2C_FSR_RX_FIFO_DATA_NUM_Msk) == 0) {
+            if (SHT3x_BusError())
+                return SHT3x_EndTransfer(i ? SHT3X_ERROR_TIMEOUT : SHT3X_ERROR_I2C);
+            if (SHT3x_Expired(start))
+                return SHT3x_EndTransfer(SHT3X_ERROR_TIMEOUT);
+        }
+        rx[i] = (uint8_t)hi2c1.reg->RDR;
+    }
+
+    while (hi2c1.reg->STR & I2C_STR_BUSY_Msk) {
+        if (SHT3x_Expired(start))
+            return SHT3x_EndTransfer(SHT3X_ERROR_TIMEOUT);
+    }
+
+    return SHT3x_EndTransfer(HT_SENSOR_OK);
+}
+
+static int SHT3x_Init(void) {
+    HAL_I2C_InitClock(HT_I2C1);
+    HAL_I2C_Initialize(NULL, &hi2c1);
+    HAL_I2C_PowerControl(ARM_POWER_FULL, &hi2c1);
+    HAL_I2C_Control(ARM_I2C_BUS_SPEED, ARM_I2C_BUS_SPEED_FAST, &hi2c1);
+
+    // A soft reset doubles as presence probe: absent sensors NACK the address
+    if (SHT3x_SendCommand(SHT3X_CMD_SOFT_RESET) != HT_SENSOR_OK)
+        return HT_SENSOR_ERROR_ABSENT;
+
+    osDelay(2);
+
+    return HT_SENSOR_OK;
+}
+
+static int SHT3x_Trigger(void) {
+    return SHT3x_SendCommand(SHT3X_CMD_MEASURE_HIGH);
+}
+
+static int SHT3x_Read(HT_SensorReading *reading) {
+    uint8_t rx[6];
+    int32_t raw;
+
+    int ret = SHT3x_Receive(rx, sizeof(rx));
+
+    if (ret != HT_SENSOR_OK)
+        return ret;
+
+    if (SHT3x_Crc8(&rx[0], 2) != rx[2] || SHT3x_Crc8(&rx[3], 2) != rx[5])
+        return SHT3X_ERROR_CRC;
+
+    // T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535, in tenths
+    raw = (rx[0] << 8) | rx[1];
+    reading->temperature = (int16_t)(-450 + (1750 * raw + 32767) / 65535);
+    raw = (rx[3] << 8) | rx[4];
+    reading->humidity = (int16_t)((1000 * raw + 32767) / 65535);
+
+    return HT_SENSOR_OK;
+}
+
+const HT_SensorDriver SHT3x_Driver = {
+    "SHT3x",
+    HT_SENSOR_CAP_TEMPERATURE | HT_SENSOR_CAP_HUMIDITY | HT_SENSOR_CAP_TRIGGERED,
+    SHT3X_CONVERSION_MS,
+    SHT3X_MIN_PERIOD_MS,
+    SHT3X_WARMUP_MS,
+    SHT3x_Init,
+    SHT3x_Trigger,
+    SHT3x_Read,
+    NULL
+};
@@ -0,0 +1,96 @@
+#include "HT_SampleRing.h"
+
+uint16_t HT_Ring_Crc16(uint16_t crc, const uint8_t *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+
+    return crc;
+}
+
+// Only the stored records are covered, so a short ring is checked in a few microseconds.
+static uint16_t HT_Ring_Checksum(const HT_SampleRing *ring) {
+    uint16_t crc = 0xFFFF;
+    uint16_t idx = ring->head;
+
+    crc = HT_Ring_Crc16(crc, (const uint8_t *)&ring->generation, sizeof(ring->generation));
+    crc = HT_Ring_Crc16(crc, (const uint8_t *)&ring->head, sizeof(ring->head));
+    crc = HT_Ring_Crc16(crc, (const uint8_t *)&ring->count, sizeof(ring->count));
+
+    for (uint16_t i = 0; i < ring->count; ++i) {
+        crc = HT_Ring_Crc16(crc, (const uint8_t *)&ring->records[idx], sizeof(HT_SampleRecord));
+        if (++idx == HT_RING_RECORDS)
+            idx = 0;
+    }
+
+    return crc;
+}
+
+static void HT_Ring_Seal(HT_SampleRing *ring) {
+    ring->generation++;
+    ring->crc = HT_Ring_Checksum(ring);
+}
+
+void HT_Ring_Reset(HT_SampleRing *ring) {
+    ring->head = 0;
+    ring->count = 0;
+    ring->reserved = 0;
+    HT_Ring_Seal(ring);
+}
+
+uint8_t HT_Ring_IsValid(const HT_SampleRing *ring) {
+    if (ring->head >= HT_RING_RECORDS || ring->count > HT_RING_RECORDS)
+        return 0;
+
+    return ring->crc == HT_Ring_Checksum(ring);
+}
+
+int HT_Ring_Push(HT_SampleRing *ring, const HT_SampleRecord *record) {
+    uint16_t tail;
+
+    if (ring->count >= HT_RING_RECORDS)
+        return HT_RING_ERROR_FULL;
+
+    tail = ring->head + ring->count;
+    if (tail >= HT_RING_RECORDS)
+        tail -= HT_RING_RECORDS;
+
+    ring->records[tail] = *record;
+    ring->count++;
+    HT_Ring_Seal(ring);
+
+    return HT_RING_OK;
+}
+
+uint16_t HT_Ring_Read(const HT_SampleRing *ring, uint16_t first, HT_SampleRecord *out, uint16_t n) {
+    uint16_t copied = 0;
+    uint16_t idx;
+
+    if (first >= ring->count)
+        return 0;
+
+    idx = ring->head + first;
+    if (idx >= HT_RING_RECORDS)
+        idx -= HT_RING_RECORDS;
+
+    while (copied < n && first + copied < ring->count) {
+        out[copied++] = ring->records[idx];
+        if (++idx == HT_RING_RECORDS)
+            idx = 0;
+    }
+
+    return copied;
+}
+
+void HT_Ring_Drop(HT_SampleRing *ring, uint16_t n) {
+    if (n > ring->count)
+        n = ring->count;
+
+    ring->head += n;
+    if (ring->head >= HT_RING_RECORDS)
+        ring->head -= HT_RING_RECORDS;
+    ring->count -= n;
+    HT_Ring_Seal(ring);
+}
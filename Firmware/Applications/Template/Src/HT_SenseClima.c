@@ -18,28 +18,6 @@
 
 /* Function prototypes  ------------------------------------------------------------------*/
 
-/*!******************************************************************
- * \fn static void HT_YieldThread(void *arg)
- * \brief Thread created as MQTT background.
- *
- * \param[in]  void *arg                    Thread parameter.
- * \param[out] none
- *
- * \retval none.
- *******************************************************************/
-static void HT_YieldThread(void *arg);
-
-/*!******************************************************************
- * \fn static void HT_Yield_Thread(void *arg)
- * \brief Creates a thread that will be the MQTT background.
- *
- * \param[in]  void *arg                    Parameters that will be used in the created thread.
- * \param[out] none
- *
- * \retval none.
- *******************************************************************/
-static void HT_Yield_Thread(void *arg);
-
 /*!******************************************************************
  * \fn static void HT_FSM_MQTTWritePayload(uint8_t *ptr, uint8_t size)
  * \brief Copy the *ptr content to the mqtt_payload.
@@ -76,6 +54,18 @@ static void HT_FSM_LedStatus(HT_Led_Type led, uint16_t state);
  *******************************************************************/
 static HT_ConnectionStatus HT_FSM_MQTTConnect(void);
 
+/*!******************************************************************
+ * \fn static HT_ConnectionStatus HT_FSM_MQTTConnectRetry(void)
+ * \brief Connects to the MQTT Broker, giving up after
+ * HT_MQTT_CONNECT_ATTEMPTS attempts.
+ *
+ * \param[in]  none
+ * \param[out] none
+ *
+ * \retval Connection status.
+ *******************************************************************/
+static HT_ConnectionStatus HT_FSM_MQTTConnectRetry(void);
+
 
 /* ---------------------------------------------------------------------------------------*/
 
@@ -84,7 +74,7 @@ static Network mqttNetwork;
 
 //Buffer that will be published.
 static uint8_t mqtt_payload[128] = {"Undefined Button"};
-static uint8_t mqttSendbuf[HT_MQTT_BUFFER_SIZE] = {0};
+static uint8_t mqttSendbuf[HT_MQTT_SEND_BUFFER_SIZE] = {0};
 static uint8_t mqttReadbuf[HT_MQTT_BUFFER_SIZE] = {0};
 
 static const char clientID[] = {"SIP_HTNB32L-XXX"};
@@ -99,8 +89,80 @@ static char topic[25] = {0};
 static const char topic_temperature[] = {"hana/externo/senseclima/00001/temperature"};
 static const char topic_humidity[] = {"hana/externo/senseclima/00001/humidity"};
 static const char topic_interval[] = {"hana/externo/senseclima/00001/interval"};
+static const char topic_diagnostics[] = {"hana/externo/senseclima/00001/diagnostics"};
+static const char topic_sensorstats[] = {"hana/externo/senseclima/00001/sensorstats"};
+static const char topic_event[] = {"hana/externo/senseclima/00001/event"};
+static const char topic_batch[] = {"hana/externo/senseclima/00001/batch"};
+// Built-in summary topic, replaced by the one set with "st=" for the session (HT_Config_GetTopic)
+static char topic_summary[HT_CONFIG_TOPIC_MAX + 1] = {"hana/externo/senseclima/00001/summary"};
+
+// Journal upload: records read per file access and encoded payload size per
+// message. The payload is sent from batch_payload, not copied to mqttSendbuf.
+#define HT_BATCH_READ_RECORDS   16
+#define HT_BATCH_PAYLOAD_SIZE   1024
+
+// Smaller batches are sent uncompressed: they never shrank in Test/HT_Bench_Lz.c,
+// while larger ones mostly do and a failed attempt only costs CPU time
+#define HT_BATCH_LZ_THRESHOLD   64
+
+static uint8_t batch_payload[HT_BATCH_PAYLOAD_SIZE];
+static uint8_t lz_payload[HT_BATCH_PAYLOAD_SIZE];
+
+// Outbox topic indexes, the order of outbox_topic[]
+#define HT_OUTBOX_TOPIC_TEMPERATURE     0
+#define HT_OUTBOX_TOPIC_HUMIDITY        1
+#define HT_OUTBOX_TOPIC_DIAGNOSTICS     2
+#define HT_OUTBOX_TOPIC_SENSORSTATS     3
+#define HT_OUTBOX_TOPIC_EVENT           4
+#define HT_OUTBOX_TOPIC_SUMMARY         5
+
+static const char *const outbox_topic[] = {
+    topic_temperature, topic_humidity, topic_diagnostics, topic_sensorstats, topic_event, topic_summary
+};
+
+// Reports and replayed messages are published QoS1 with their outbox sequence
+// number as the MQTT 5 user property "seq", the payload left as is. Each one
+// keeps its state until the MQTT I/O task reports the PUBACK.
+#define HT_PUBLISH_PENDING      0
+#define HT_PUBLISH_ACKED        1
+#define HT_PUBLISH_FAILED       2
+
+typedef struct {
+    uint8_t topic;                  // HT_OUTBOX_TOPIC_*
+    uint32_t seq;
+    char seq_str[11];
+    MQTTProperty seq_prop;
+    MQTTProperties props;
+    volatile uint8_t state;         // HT_PUBLISH_*
+} HT_PublishSlot;
+
+// Outbox replay keeps up to MAX_INFLIGHT_MESSAGES publishes waiting for their PUBACK
+#define HT_REPLAY_WINDOW        MAX_INFLIGHT_MESSAGES
+
+static HT_OutboxMessage replay_msg[HT_REPLAY_WINDOW];
+static HT_PublishSlot replay_slot[HT_REPLAY_WINDOW];
+static MQTTBatchMessage replay_batch[HT_REPLAY_WINDOW];    // Messages sent in one write
+
+// Reports of one wake: temperature, humidity, diagnostics, statistics, event and summary
+#define HT_LIVE_MAX             6
+
+static HT_PublishSlot live_slot[HT_LIVE_MAX];
+static MQTTBatchMessage live_batch[HT_LIVE_MAX];
+static uint8_t live_count;
+
+static volatile uint8_t batch_pending;
+static osSemaphoreId_t publish_sem = NULL;
+
+// Summary of a window closed by this wake, published with the reports
+static char wake_summary[HT_AGG_STR_SIZE];
+static uint8_t wake_summary_len;
+
+// Sample taken at wake-up by HT_SampleWake, reported by HT_DhtThread
+static HT_SampleRecord wake_record;
+static int wake_sensor = -1;
 
 //extern uint8_t mqttEpSlpHandler;
+extern uint8_t gRssi;
 
 //FSM state.
 volatile HT_FSM_States state = HT_WAIT_FOR_BUTTON_STATE;
@@ -108,20 +170,17 @@ volatile HT_FSM_States state = HT_WAIT_FOR_BUTTON_STATE;
 //Buffer where the digital twin messages will be stored.
 static uint8_t subscribe_buffer[HT_SUBSCRIBE_BUFF_SIZE] = {0};
 
-static StaticTask_t yield_thread, dht_thread, sleep_thread;
-static uint8_t yieldTaskStack[1024*4], dhtTaskStack[1024*4], sleepTaskStack[1024*2];
-
-osThreadId_t yield_id = NULL;
+static StaticTask_t dht_thread, sleep_thread;
+static uint8_t dhtTaskStack[1024*4], sleepTaskStack[1024*2];
 
 #define TIMER_ID        0
 #define MAX_TIMER_MS     2088000000UL  // 580 horas em milissegundos
-#define DEFAULT_TIMER_MS 30000UL       // 30 segundos
+#define DEFAULT_TIMER_MS HT_CONFIG_INTERVAL_MS  // 30 segundos
 //#define RTC_TIMEOUT_MS  60000  // 10 segundos
 
 uint8_t voteHandle = 0xFF;
 extern uint8_t mqttEpSlpHandler;
 //uint64_t fileContent = 0ULL;
-uint32_t interval_ms = DEFAULT_TIMER_MS;
 char interval_str[10] = {"00000000"};
 
 uint32_t tempo_em_milisegundos(const char *payload) {
@@ -165,34 +224,6 @@ void converter_ms_para_string(uint32_t ms, char *saida_str) {
 }
 
 
-static void HT_FsWrite(void) {
-	OSAFILE fp = PNULL;
-	uint32_t len;
-
-    //fileContent += 1;
-
-	fp = OsaFopen("testFile", "wb");
-	len = OsaFwrite(&interval_ms, sizeof(interval_ms), 1, fp);
-
-	if(len == 1)
-		printf("Write Success\n");
-
-	OsaFclose(fp);
-}
-
-static void HT_FsRead(void) {
-	OSAFILE fp = PNULL;
-	uint32_t len;
-	
-	fp = OsaFopen("testFile", "r");
-	len = OsaFread(&interval_ms, sizeof(interval_ms), 1, fp);
-	
-	if(len == 1)
-    	printf("Read File Success\n");
-
-	OsaFclose(fp);
-}
-
 void beforeHibernateCb(void *pdata, slpManLpState state) {
     printf("[Callback] Antes de Hibernate\n");
 }
@@ -203,14 +234,11 @@ void afterHibernateCb(void *pdata, slpManLpState state) {
 
 void sleepWithMode(slpManSlpState_t mode) {
 
+    HT_Sensor_PowerOff();
     
-    osStatus_t ret = osThreadTerminate(yield_id);
-    printf("\nOs status %d\n", ret);
-
-    if(ret == osOK){
-        printf("\nTask MQTT Susbcribe foi suspensa ...\n");
-        osDelay(1000);
-    } 
+    // Closes the connection instead of leaving the broker to time it out
+    if (mqttClient.isconnected && HT_MQTT_Disconnect(&mqttClient) == SUCCESS)
+        printf("\nMQTT desconectado ...\n");
 
     printf("\n=== Entrando em Modo Sono %d===\n", mode);
 
@@ -235,7 +263,9 @@ void sleepWithMode(slpManSlpState_t mode) {
     //interval_ms = tempo_em_milisegundos("00000100"); //DDHHMMSS
 
     
-    slpManDeepSlpTimerStart(TIMER_ID, interval_ms);
+    // An event wake leaves the periodic timer running so the schedule is not shifted
+    if (!HT_EventWake_Triggered() || !slpManDeepSlpTimerIsRunning(TIMER_ID))
+        slpManDeepSlpTimerStart(TIMER_ID, HT_Config_Get()->interval_ms);
 
     // Espera passiva — o sistema deve entrar em sono automaticamente
     while (1) {
@@ -245,118 +275,463 @@ void sleepWithMode(slpManSlpState_t mode) {
 }
 
 
-static void HT_YieldThread(void *arg) {
-    while (1) {
-        // Wait function for 10ms to check if some message arrived in subscribed topic
-        MQTTYield(&mqttClient, 10);
-    }
+static int HT_AcquireReading(HT_SensorReading *reading) {
+        HT_SensorReading readings[HT_SENSOR_MAX];
+        int sensor_status[HT_SENSOR_MAX];
+        HT_Acq acq[HT_SENSOR_MAX];
+        HT_Retry retry[HT_SENSOR_MAX];
+        uint16_t delay_ms, wait_ms;
+        uint8_t pending = 0;
+        uint8_t event_wake = HT_EventWake_Triggered();
+        uint8_t count = HT_Sensor_Count();
+
+        for (uint8_t i = 0; i < count; i++) {
+            HT_Acq_Reset(&acq[i]);
+            HT_Retry_Reset(&retry[i]);
+            pending |= (1 << i);
+        }
+
+        // Sensors were powered at wake-up, start as soon as the warm-up is over
+        HT_Sensor_WaitReady();
+
+        // Sample every sensor in one batch until each one converged or gave up.
+        // The retry policy picks the wait after each read (backing off on timeouts)
+        // and drops sensors that stopped answering; the longest wait among the
+        // pending sensors is used for the next batch.
+        while (pending) {
+
+            HT_Sensor_SampleAll(pending, readings, sensor_status);
+            wait_ms = 0;
+
+            for (uint8_t i = 0; i < count; i++) {
+                if (!(pending & (1 << i)))
+                    continue;
+
+                printf("\n%s: leitura %d status %d\n", HT_Sensor_Get(i)->name, acq[i].attempts + 1, sensor_status[i]);
+
+                delay_ms = HT_Retry_Next(&retry[i], HT_Sensor_GetStats(i), sensor_status[i], HT_Sensor_Get(i)->min_period_ms);
+                if (delay_ms == HT_RETRY_GIVE_UP) {
+                    printf("\n%s: sem resposta, desistindo\n", HT_Sensor_Get(i)->name);
+                    pending &= ~(1 << i);
+                    continue;
+                }
+
+                // An event wake reports the first good reading instead of waiting to converge
+                if (HT_Acq_AddSample(&acq[i], sensor_status[i] == HT_SENSOR_OK,
+                                     readings[i].temperature, readings[i].humidity) != HT_ACQ_PENDING ||
+                    (event_wake && sensor_status[i] == HT_SENSOR_OK))
+                    pending &= ~(1 << i);
+                else if (delay_ms > wait_ms)
+                    wait_ms = delay_ms;
+            }
+
+            if (pending)
+                osDelay(wait_ms);
+        }
+
+        // The first sensor with a valid result (registry priority order) is reported
+        for (uint8_t i = 0; i < count; i++) {
+            if (HT_Acq_GetResult(&acq[i], &reading->temperature, &reading->humidity)) {
+                printf("\n%s: %d leituras\n", HT_Sensor_Get(i)->name, acq[i].count);
+                return i;
+            }
+        }
+
+        printf("\nSensores com problemas\n");
+
+        return -1;
 }
 
-static void HT_Yield_Thread(void *arg) {
-    osThreadAttr_t task_attr;
+static void HT_JournalReading(int sensor, const HT_SensorReading *reading) {
+        int ret;
 
-    memset(&task_attr,0,sizeof(task_attr));
-    memset(yieldTaskStack, 0xA5,LED_TASK_STACK_SIZE);
-    task_attr.name = "yield_thread";
-    task_attr.stack_mem = yieldTaskStack;
-    task_attr.stack_size = LED_TASK_STACK_SIZE;
-    task_attr.priority = osPriorityNormal;
-    task_attr.cb_mem = &yield_thread;
-    task_attr.cb_size = sizeof(StaticTask_t);
+        wake_record.time = HT_Time_Now();
+        wake_record.temperature = (sensor < 0) ? HT_SAMPLE_NO_VALUE : reading->temperature;
+        wake_record.humidity = (sensor < 0) ? HT_SAMPLE_NO_VALUE : reading->humidity;
 
-    yield_id = osThreadNew(HT_YieldThread, NULL, &task_attr);
+        ret = HT_Journal_Append(&wake_record);
+        if (ret != HT_JOURNAL_OK)
+            printf("\nJournal: erro %d\n", ret);
 }
 
+// Publishes one encoded batch, LZ compressed when that makes it smaller
+static int HT_PublishBatch(uint16_t len) {
+        int lz_len = HT_LZ_ERROR_FULL;
 
-static void HT_DhtThread(void *arg) {
-        float temp, humi;
-        char tempString[10], humString[10];
-        char msg_error[] = "error";
-        int count = 0;
-        int attempt = 0;
+        if (len >= HT_BATCH_LZ_THRESHOLD)
+            lz_len = HT_Lz_Compress(batch_payload, len, lz_payload, len);
 
-        while (1)
-        {
-           
-            int dht_status = DHT22_Read(&temp, &humi);
-            
-            printf("\nExecultando contagem %d\n", attempt + 1);
-            
-            if(attempt > 60){
-                printf("\nDht com problemas\n");
-
-                                while(1){
-
-                    while(!mqttClient.isconnected){
-                        if(HT_FSM_MQTTConnect() == HT_NOT_CONNECTED) {
-                            printf("\n MQTT Connection Error!\n");
-                            osDelay(5000);
-                        }
-                    }
-
-                    bool ok1 = HT_MQTT_Publish(&mqttClient, (char *)topic_temperature, (uint8_t *)msg_error, strlen(msg_error), QOS0, 0, 0, 0);
-                    osDelay(2000);
-                    bool ok2 = HT_MQTT_Publish(&mqttClient, (char *)topic_humidity, (uint8_t *)msg_error, strlen(msg_error), QOS0, 0, 0, 0);
-                    osDelay(2000);
-                    if (!ok1 && !ok2) {
-                        printf("\nValores Publicados...\n");
-                        break;  // Só sai quando ambos tiverem sucesso
-                    }
-                        
-                }
-            
-                
-                printf("\nProcesso para deep sleep\n");
-                sleepWithMode(SLP_HIB_STATE);
+        if (lz_len > 0)
+            return HT_MQTT_Publish(&mqttClient, (char *)topic_batch, lz_payload, lz_len, QOS1, 0, 0, 0);
 
+        return HT_MQTT_Publish(&mqttClient, (char *)topic_batch, batch_payload, len, QOS1, 0, 0, 0);
+}
+
+static int HT_PublishJournal(const HT_BatchExtra *extra) {
+        HT_SampleRecord records[HT_BATCH_READ_RECORDS];
+        HT_BatchEncoder enc;
+        uint16_t total = HT_Journal_Count();
+        uint16_t first = 0;
+        uint16_t interval_s = HT_Config_Get()->interval_ms / 1000;
+        int n, i = 0;
+        int rc = 0;
+
+        // Encode as many samples as fit in one message, starting a new one
+        // (with its own base time) when the encoder runs out of room
+        while (first < total && rc == 0) {
+            n = HT_Journal_Read(first, records, HT_BATCH_READ_RECORDS);
+            if (n <= 0)
+                return -1;
+
+            for (i = 0; i < n && rc == 0; i++) {
+                // Samples taken before the first sync after power-on get their UTC time now
+                records[i].time = HT_Time_Resolve(records[i].time);
+
+                if (first + i == 0)
+                    HT_Batch_Begin(&enc, HT_BATCH_UPLINK_FORMAT, batch_payload, HT_BATCH_PAYLOAD_SIZE,
+                                   records[i].time, interval_s, extra);
+
+                if (HT_Batch_Add(&enc, &records[i]) == HT_BATCH_ERROR_FULL) {
+                    rc = HT_PublishBatch(HT_Batch_End(&enc));
+                    HT_Batch_Begin(&enc, HT_BATCH_UPLINK_FORMAT, batch_payload, HT_BATCH_PAYLOAD_SIZE,
+                                   records[i].time, interval_s, extra);
+                    HT_Batch_Add(&enc, &records[i]);
+                }
             }
-            
-            if(count >= 10) {
-                
-                printf("\ntemp %s*C | hum %s %%\n", tempString, humString);
-
-
-                while(1){
-
-                    while(!mqttClient.isconnected){
-                        if(HT_FSM_MQTTConnect() == HT_NOT_CONNECTED) {
-                            printf("\n MQTT Connection Error!\n");
-                            osDelay(5000);
-                        }
-                    }
-
-                    bool ok1 = HT_MQTT_Publish(&mqttClient, (char *)topic_temperature, (uint8_t *)tempString, strlen(tempString), QOS0, 0, 0, 0);
-                    osDelay(2000);
-                    bool ok2 = HT_MQTT_Publish(&mqttClient, (char *)topic_humidity, (uint8_t *)humString, strlen(humString), QOS0, 0, 0, 0);
-                    osDelay(2000);
-                    if (!ok1 && !ok2) {
-                        printf("\nValores Publicados...\n");
-                        break;  // Só sai quando ambos tiverem sucesso
-                    }
-                        
+
+            first += n;
+        }
+
+        if (total && rc == 0)
+            rc = HT_PublishBatch(HT_Batch_End(&enc));
+
+        if (rc == 0) {
+            printf("\n%d amostras enviadas\n", total);
+            HT_Journal_Clear();
+        }
+
+        return rc;
+}
+
+// Completion of a published message, runs in the MQTT I/O task
+static void HT_PublishDone(int rc, void *arg) {
+        *(volatile uint8_t *)arg = (rc == SUCCESS) ? HT_PUBLISH_ACKED : HT_PUBLISH_FAILED;
+        osSemaphoreRelease(publish_sem);
+}
+
+// The MQTT task is done with the batch array
+static void HT_PublishBatchDone(int rc, void *arg) {
+        batch_pending = 0;
+        osSemaphoreRelease(publish_sem);
+}
+
+// Fills one QoS1 message of a batch, its sequence number carried as a user property
+static void HT_PublishPrepare(MQTTBatchMessage *msg, HT_PublishSlot *slot, uint8_t topic,
+                              uint32_t seq, const void *payload, uint16_t len) {
+        MQTTProperty prop;
+
+        slot->topic = topic;
+        slot->seq = seq;
+        slot->state = HT_PUBLISH_PENDING;
+
+        prop.identifier = MQTTPROPERTY_CODE_USER_PROPERTY;
+        prop.value.data.data = "seq";
+        prop.value.data.len = 3;
+        prop.value.value.data = slot->seq_str;
+        prop.value.value.len = HT_Sensor_FormatUInt(seq, slot->seq_str);
+        memset(&slot->props, 0, sizeof(MQTTProperties));
+        slot->props.max_count = 1;
+        slot->props.array = &slot->seq_prop;
+        MQTTProperties_add(&slot->props, &prop);
+
+        memset(msg, 0, sizeof(MQTTBatchMessage));
+        msg->topicName = outbox_topic[topic];
+        msg->message.qos = QOS1;
+        msg->message.payload = (void *)payload;
+        msg->message.payloadlen = len;
+        msg->message.properties = &slot->props;
+        msg->fp = HT_PublishDone;
+        msg->context = (void *)&slot->state;
+}
+
+// Hands a batch to the MQTT task. On a failed post its messages are marked failed.
+static void HT_PublishPost(MQTTBatchMessage *batch, uint8_t count) {
+        HT_MQTT_Command cmd;
+
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.type = HT_MQTT_CMD_PUBLISH_BATCH;
+        cmd.client = &mqttClient;
+        cmd.batch = batch;
+        cmd.count = count;
+        cmd.done = HT_PublishBatchDone;
+
+        batch_pending = 1;
+        if (HT_MQTT_Task_Post(&cmd) != HT_MQTT_TASK_OK) {
+            batch_pending = 0;
+            while (count--)
+                *(volatile uint8_t *)batch[count].context = HT_PUBLISH_FAILED;
+        }
+}
+
+// Sends the outbox with several messages in flight, the free part of the
+// window going out as one batch. PUBACKs may arrive in any order, but messages
+// are only popped from the head, so after a failure the rest stays queued and
+// is sent again in the next session.
+static int HT_ReplayOutbox(void) {
+        uint16_t count = HT_Outbox_Count();
+        uint16_t sent = 0;          // Messages handed to the MQTT task
+        uint16_t retired = 0;       // Messages completed in outbox order
+        uint8_t batched;
+        uint8_t slot;
+        int ret;
+        int rc = 0;
+
+        while (1) {
+            batched = 0;
+            while (rc == 0 && !batch_pending && sent < count && sent - retired < HT_REPLAY_WINDOW) {
+                slot = sent % HT_REPLAY_WINDOW;
+
+                // Popped messages are no longer counted by the outbox
+                ret = HT_Outbox_Peek(sent - retired, &replay_msg[slot]);
+                if (ret != HT_OUTBOX_OK || replay_msg[slot].topic >= sizeof(outbox_topic) / sizeof(outbox_topic[0])) {
+                    printf("\nOutbox: mensagem descartada (%d)\n", ret);
+                    replay_slot[slot].state = HT_PUBLISH_ACKED;
+                    sent++;
+                    continue;
                 }
 
-                //printf("ret %d", ret);
-                //osDelay(2000);
-                
-                printf("\nProcesso para deep sleep\n");
-                sleepWithMode(SLP_HIB_STATE);
+                HT_PublishPrepare(&replay_batch[batched++], &replay_slot[slot], replay_msg[slot].topic,
+                                  replay_msg[slot].seq, replay_msg[slot].payload, replay_msg[slot].len);
+                sent++;
             }
-            
-            if(dht_status == 0){
-                int temp_int = (int) (temp * 10);
-                int hum_int = (int) (humi * 10);
-                sprintf(tempString, "%d.%d", temp_int/10, temp_int%10);
-                sprintf(humString, "%d.%d", hum_int/10, hum_int%10);
-                printf("\n\nExecultando Dht\n");
-                count++;
+
+            if (batched) {
+                // Failed in order below, so messages acked before are still popped
+                HT_PublishPost(replay_batch, batched);
+                if (!batch_pending)
+                    count = sent;
+            }
+
+            while (retired < sent && replay_slot[retired % HT_REPLAY_WINDOW].state != HT_PUBLISH_PENDING) {
+                if (replay_slot[retired % HT_REPLAY_WINDOW].state == HT_PUBLISH_FAILED)
+                    rc = -1;
+                if (rc == 0)
+                    HT_Outbox_Pop();
+                retired++;
             }
 
-            attempt++; 
-            osDelay(1000);
-     
+            // Buffers still in flight belong to the MQTT task until they complete
+            if (retired == sent && !batch_pending && (rc != 0 || sent == count))
+                break;
+
+            if (retired < sent || batch_pending)
+                osSemaphoreAcquire(publish_sem, osWaitForever);
         }
-        
+
+        return rc;
+}
+
+static void HT_Enqueue(uint32_t seq, uint8_t topic, const char *payload, uint16_t len) {
+        int ret = HT_Outbox_Push(seq, topic, (const uint8_t *)payload, len);
+
+        if (ret != HT_OUTBOX_OK)
+            printf("\nOutbox: erro %d\n", ret);
+}
+
+// Adds a report of this wake, numbered now so a replay keeps its sequence number.
+// It counts as failed until published.
+static void HT_AddReport(uint8_t topic, const char *payload, uint16_t len) {
+        HT_PublishPrepare(&live_batch[live_count], &live_slot[live_count], topic, HT_Outbox_NextSeq(), payload, len);
+        live_slot[live_count].state = HT_PUBLISH_FAILED;
+        live_count++;
+}
+
+// Publishes the reports of this wake in one batch and waits for every PUBACK
+static int HT_PublishReports(void) {
+        uint8_t pending;
+        int rc = 0;
+
+        for (uint8_t i = 0; i < live_count; i++)
+            live_slot[i].state = HT_PUBLISH_PENDING;
+        HT_PublishPost(live_batch, live_count);
+
+        do {
+            pending = batch_pending;
+            for (uint8_t i = 0; i < live_count; i++)
+                pending |= live_slot[i].state == HT_PUBLISH_PENDING;
+            if (pending)
+                osSemaphoreAcquire(publish_sem, osWaitForever);
+        } while (pending);
+
+        for (uint8_t i = 0; i < live_count; i++) {
+            if (live_slot[i].state != HT_PUBLISH_ACKED)
+                rc = -1;
+        }
+
+        return rc;
+}
+
+// Queues the reports left without a PUBACK for the next session. Acked ones
+// never touch the flash.
+static void HT_QueueReports(void) {
+        for (uint8_t i = 0; i < live_count; i++) {
+            if (live_slot[i].state != HT_PUBLISH_ACKED)
+                HT_Enqueue(live_slot[i].seq, live_slot[i].topic,
+                           live_batch[i].message.payload, live_batch[i].message.payloadlen);
+        }
+}
+
+// Folds the wake sample into the summary window, keeping the summary of a window that ended
+static void HT_AggregateReading(void) {
+        static HT_AggState closed;
+        uint32_t window_s = HT_Config_Get()->aggregate_s;
+
+        if (window_s == 0)
+            return;
+
+        if (HT_Agg_Add(&HT_Retention_Get()->aggregate, window_s, wake_record.time,
+                       wake_record.temperature, wake_record.humidity, &closed)) {
+            wake_summary_len = HT_Agg_Format(&closed, HT_Time_Resolve(closed.start), window_s, wake_summary);
+            printf("\nResumo: %s\n", wake_summary);
+        }
+}
+
+void HT_SampleWake(void) {
+        HT_ReportState *report = &HT_Retention_Get()->report;
+        HT_SensorReading reading;
+        uint8_t aggregate = HT_Config_Get()->aggregate_s != 0;
+        uint8_t due;
+
+        printf("%d sensor(es) encontrados\n", HT_Sensor_InitAll());
+        wake_sensor = HT_AcquireReading(&reading);
+        HT_JournalReading(wake_sensor, &reading);
+        HT_AggregateReading();
+
+        // Messages left by a wake that could not connect (or a new summary) also need a session
+        due = HT_Journal_UploadDue(aggregate) || HT_Outbox_Count() || wake_summary_len ||
+              HT_Report_Due(&HT_Config_Get()->report, report, wake_record.temperature, wake_record.humidity, wake_record.time);
+
+        // After a failed session the radio stays off until the backoff runs out,
+        // an event or a power-on still connects at once
+        if (due && (!HT_Report_BackingOff(report, wake_record.time) ||
+                    HT_EventWake_Triggered() || slpManGetWakeupSrc() == WAKEUP_FROM_POR))
+            return;
+
+        // The summary is only in RAM, keep it for the next session
+        if (wake_summary_len)
+            HT_Enqueue(HT_Outbox_NextSeq(), HT_OUTBOX_TOPIC_SUMMARY, wake_summary, wake_summary_len);
+
+        if (due)
+            printf("\nSem conexao, nova tentativa em %ld s\n", (long)(report->retry_time - wake_record.time));
+        else
+            printf("\nSem variacao, amostra registrada (%d pendentes)\n", HT_Journal_Count());
+        sleepWithMode(SLP_HIB_STATE);
+}
+
+static void HT_DhtThread(void *arg) {
+        char tempString[HT_SENSOR_DECI_STR_SIZE], humString[HT_SENSOR_DECI_STR_SIZE];
+        char msg_error[] = "error";
+        HT_DiagReading diag;
+        char diagString[HT_DIAG_STR_SIZE];
+        char statsString[HT_RETRY_STATS_STR_SIZE * HT_SENSOR_MAX];
+        uint16_t stats_len = 0;
+        char eventString[HT_EVENT_STR_SIZE];
+        uint8_t event_wake = HT_EventWake_Triggered();
+        HT_BatchExtra batch_extra = {0};
+        int rc = -1;
+
+        // The radio is attached, take the network time before anything is stamped or sent
+        uint8_t time_synced = HT_Time_Sync() == HT_TIME_OK;
+        wake_record.time = HT_Time_Resolve(wake_record.time);
+
+        if (publish_sem == NULL)
+            publish_sem = osSemaphoreNew(HT_LIVE_MAX + 1, 0, NULL);
+        HT_Config_GetTopic(topic_summary);
+
+        // The reading was taken and journaled by HT_SampleWake
+        if (wake_sensor >= 0) {
+            HT_Sensor_FormatDeci(wake_record.temperature, tempString);
+            HT_Sensor_FormatDeci(wake_record.humidity, humString);
+            printf("\n%s: temp %s*C | hum %s %%\n", HT_Sensor_Get(wake_sensor)->name, tempString, humString);
+        } else {
+            strcpy(tempString, msg_error);
+            strcpy(humString, msg_error);
+        }
+
+        // Failure statistics of every sensor, "name:reads,e0..e7,dead" separated by ';'
+        for (uint8_t i = 0; i < HT_Sensor_Count(); i++) {
+            if (i)
+                statsString[stats_len++] = ';';
+            stats_len += HT_Retry_FormatStats(HT_Sensor_Get(i)->name, HT_Sensor_GetStats(i), &statsString[stats_len]);
+        }
+        statsString[stats_len] = '\0';
+
+        // VBAT and die temperature are taken with the radio attached, so battery sag shows up
+        if (HT_Diag_Sample(&diag) == HT_DIAG_OK) {
+            HT_Diag_Format(&diag, diagString);
+            printf("\nVBAT/Tdie %s\n", diagString);
+            batch_extra.flags |= HT_BATCH_FLAG_VBAT;
+            batch_extra.vbat_mv = diag.vbat_mv;
+        } else {
+            strcpy(diagString, msg_error);
+        }
+
+        if (gRssi != 0xff) {
+            batch_extra.flags |= HT_BATCH_FLAG_RSSI;
+            batch_extra.rssi = gRssi;
+        }
+
+        live_count = 0;
+        HT_AddReport(HT_OUTBOX_TOPIC_TEMPERATURE, tempString, strlen(tempString));
+        HT_AddReport(HT_OUTBOX_TOPIC_HUMIDITY, humString, strlen(humString));
+        HT_AddReport(HT_OUTBOX_TOPIC_DIAGNOSTICS, diagString, strlen(diagString));
+        HT_AddReport(HT_OUTBOX_TOPIC_SENSORSTATS, statsString, stats_len);
+        if (event_wake) {
+            HT_EventWake_Format(eventString);
+            HT_AddReport(HT_OUTBOX_TOPIC_EVENT, eventString, strlen(eventString));
+        }
+        if (wake_summary_len)
+            HT_AddReport(HT_OUTBOX_TOPIC_SUMMARY, wake_summary, wake_summary_len);
+
+        if (HT_FSM_MQTTConnectRetry() == HT_CONNECTED) {
+            // Samples recorded by the sampling-only wakes, current one included. With
+            // aggregation they stay in the journal until a backfill is requested.
+            HT_AggState *agg = &HT_Retention_Get()->aggregate;
+            rc = 0;
+            if (HT_Config_Get()->aggregate_s == 0 || agg->backfill) {
+                rc = HT_PublishJournal(&batch_extra);
+                if (rc == 0 && agg->backfill) {
+                    agg->backfill = 0;
+                    HT_Retention_Commit();
+                }
+            }
+            // Older messages first, so the broker sees each topic in sequence order
+            if (rc == 0)
+                rc = HT_ReplayOutbox();
+            if (rc == 0)
+                rc = HT_PublishReports();
+
+            if (rc == 0) {
+                printf("\nValores Publicados...\n");
+                HT_Report_Sent(&HT_Retention_Get()->report, wake_record.temperature, wake_record.humidity, wake_record.time);
+                HT_Retention_Commit();
+            }
+        }
+
+        // Only what got no PUBACK is written to flash, and the next attempts back off
+        HT_QueueReports();
+        if (rc != 0)
+            HT_Report_Failed(&HT_Retention_Get()->report, wake_record.time);
+
+        if (HT_Outbox_Count())
+            printf("\n%d mensagens na fila para a proxima sessao\n", HT_Outbox_Count());
+
+        // An SNTP request made at the start of the session has had time to answer
+        if (!time_synced)
+            HT_Time_Sync();
+
+        printf("\nProcesso para deep sleep\n");
+        sleepWithMode(SLP_HIB_STATE);
 }
 
 static void HT_Dht_Thread(void *arg) {
@@ -385,7 +760,7 @@ static HT_ConnectionStatus HT_FSM_MQTTConnect(void) {
 
     // Connect to MQTT Broker using client, network and parameters needded. 
     if(HT_MQTT_Connect(&mqttClient, &mqttNetwork, (char *)addr, HT_MQTT_PORT, HT_MQTT_SEND_TIMEOUT, HT_MQTT_RECEIVE_TIMEOUT,
-                (char *)clientID, (char *)username, (char *)password, HT_MQTT_VERSION, HT_MQTT_KEEP_ALIVE_INTERVAL, mqttSendbuf, HT_MQTT_BUFFER_SIZE, mqttReadbuf, HT_MQTT_BUFFER_SIZE)) {
+                (char *)clientID, (char *)username, (char *)password, HT_MQTT_VERSION, HT_MQTT_KEEP_ALIVE_INTERVAL, mqttSendbuf, HT_MQTT_SEND_BUFFER_SIZE, mqttReadbuf, HT_MQTT_BUFFER_SIZE)) {
         return HT_NOT_CONNECTED;   
     }
 
@@ -394,24 +769,71 @@ static HT_ConnectionStatus HT_FSM_MQTTConnect(void) {
     return HT_CONNECTED;
 }
 
+// Gives up after HT_MQTT_CONNECT_ATTEMPTS instead of holding the radio awake
+static HT_ConnectionStatus HT_FSM_MQTTConnectRetry(void) {
+    for (uint8_t i = 0; i < HT_MQTT_CONNECT_ATTEMPTS && !mqttClient.isconnected; i++) {
+        if (i)
+            osDelay(5000);
+        if (HT_FSM_MQTTConnect() == HT_NOT_CONNECTED)
+            printf("\n MQTT Connection Error!\n");
+    }
+
+    return mqttClient.isconnected ? HT_CONNECTED : HT_NOT_CONNECTED;
+}
+
 void HT_FSM_SetSubscribeBuff(uint8_t *buff, uint8_t payload_len) {
     memcpy(subscribe_buffer, buff, payload_len);
 }
 
 void interval_manager(uint8_t *payload, uint8_t payload_len, 
     uint8_t *topic, uint8_t topic_len) {
+        HT_Config config = *HT_Config_Get();
    
         printf("\nmsg:[%s] | topico:[%s]\n", payload, topic);
 
-        if(payload_len > 2){
+        // Aggregation commands: "aw=DDHHMMSS" summary window (all zeros uploads raw
+        // samples), "bf" uploads the raw journal in the next session, "st=<topic>"
+        // summary topic from the next session on ("st=" restores the built-in one)
+        if (payload_len >= 3 && payload[0] == 's' && payload[1] == 't' && payload[2] == '=') {
+            uint8_t len = 0;
+            int ret;
+
+            // Up to the terminator some brokers leave in the buffer
+            while (3 + len < payload_len && payload[3 + len] != '\0')
+                len++;
+            ret = HT_Config_SetTopic((const char *)&payload[3], len);
+            if (ret == HT_CONFIG_ERROR_TOPIC)
+                printf("\nTopico invalido\n");
+            else if (ret != HT_CONFIG_OK)
+                printf("\nConfig: erro de escrita\n");
+            else
+                printf("\nTopico do resumo atualizado\n");
+            return;
+        } else if (payload_len >= 11 && payload[0] == 'a' && payload[1] == 'w' && payload[2] == '=') {
+            config.aggregate_s = tempo_em_milisegundos((const char *)&payload[3]) / 1000;
+            printf("\nJanela de agregacao %lu s\n", config.aggregate_s);
+        } else if (payload_len >= 2 && payload[0] == 'b' && payload[1] == 'f') {
+            HT_Retention_Get()->aggregate.backfill = 1;
+            HT_Retention_Commit();
+            printf("\nBackfill solicitado\n");
+        } else if (payload_len > 3 && payload[2] == '=') {
+            // Reporting policy commands ("dt=5,dh=20,hb=00060000"), see HT_Report.h
+            if (HT_Report_Configure(&config.report, payload, payload_len) == HT_REPORT_OK) {
+                printf("\nPolitica atualizada: dt %d dh %d hb %lu s\n", config.report.deadband_temp, config.report.deadband_hum, config.report.heartbeat_s);
+            } else {
+                printf("\nComando invalido\n");
+                return;
+            }
+        } else if(payload_len > 2){
            
-            interval_ms = tempo_em_milisegundos(payload); //DDHHMMSS
-            converter_ms_para_string(interval_ms, interval_str);
+            config.interval_ms = tempo_em_milisegundos((const char *)payload); //DDHHMMSS
+            converter_ms_para_string(config.interval_ms, interval_str);
             printf("\nInterval atualizado [%s]\n", interval_str);
-
-            HT_FsWrite();
-            //HT_FsWrite();
         }
+
+        // Only written when a value actually changed
+        if (HT_Config_Set(&config) != HT_CONFIG_OK)
+            printf("\nConfig: erro de escrita\n");
              
 }
 
@@ -428,45 +850,17 @@ void HT_Fsm(void) {
     }
    */
    
-    while(!mqttClient.isconnected){
-        if(HT_FSM_MQTTConnect() == HT_NOT_CONNECTED) {
-            printf("\n MQTT Connection Error!\n");
-            osDelay(5000);
-        }
-    }
+    // Without a connection the reports are still queued by HT_DhtThread before hibernating
+    if (HT_FSM_MQTTConnectRetry() == HT_CONNECTED) {
+        // Incoming messages are handled by the MQTT I/O task started on connect
+        HT_MQTT_Subscribe(&mqttClient, topic_interval, QOS0);
 
-    HT_MQTT_Subscribe(&mqttClient, topic_interval, QOS0);
-
-    HT_Yield_Thread(NULL);
-    
-    while(1){
-
-        while(!mqttClient.isconnected){
-            if(HT_FSM_MQTTConnect() == HT_NOT_CONNECTED) {
-                printf("\n MQTT Connection Error!\n");
-                osDelay(5000);
-            }
-        }
-        
-        HT_FsRead();
-        printf("File Read: %lu\n", interval_ms);
-        converter_ms_para_string(interval_ms, interval_str);
+        converter_ms_para_string(HT_Config_Get()->interval_ms, interval_str);
         printf("Interval str %s\n\n",interval_str);
-        
-        bool ok1 = HT_MQTT_Publish(&mqttClient, (char *)topic_interval, (uint8_t *)("on"), strlen(("on")), QOS0, 0, 0, 0);
-        osDelay(2000);
-        
-        if (!ok1) {
+
+        if (!HT_MQTT_Publish(&mqttClient, (char *)topic_interval, (uint8_t *)("on"), strlen(("on")), QOS0, 0, 0, 0))
             printf("\nValores Publicados...\n");
-            break;  // Só sai quando ambos tiverem sucesso
-        }
-            
     }
-                
-        
-
-    printf("\nIniciando DHT !!!\n");
-    DHT22_Init();
 
     HT_Dht_Thread(NULL);
     
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include "HT_Sensor.h"
+#include "HT_DHT22.h"
+#include "HT_SHT3x.h"
+#include "HT_Retention.h"
+#include "cmsis_os2.h"
+#include "slpman_qcx212.h"
+#include "hibtimer_qcx212.h"
+
+#define HT_SENSOR_8HZ_TICK_MS   125     // Period of the continuous hibernate counter
+
+// Registered drivers, in reporting priority order
+static const HT_SensorDriver *const sensor_table[] = {
+#if SHT3X_ENABLE == 1
+    &SHT3x_Driver,
+#endif
+    &DHT22_Driver,
+};
+
+static const HT_SensorDriver *sensors[HT_SENSOR_MAX];
+static uint8_t sensor_slot[HT_SENSOR_MAX];     // Registry index of each available sensor
+static uint8_t sensor_count = 0;
+
+uint8_t HT_Sensor_InitAll(void) {
+    sensor_count = 0;
+
+    for (uint8_t i = 0; i < sizeof(sensor_table) / sizeof(sensor_table[0]); ++i) {
+        const HT_SensorDriver *drv = sensor_table[i];
+
+        if (drv->init && drv->init() != HT_SENSOR_OK) {
+            printf("Sensor %s not found\n", drv->name);
+            continue;
+        }
+
+        if (sensor_count < HT_SENSOR_MAX && i < HT_SENSOR_MAX) {
+            sensor_slot[sensor_count] = i;
+            sensors[sensor_count++] = drv;
+        }
+    }
+
+    return sensor_count;
+}
+
+uint8_t HT_Sensor_Count(void) {
+    return sensor_count;
+}
+
+const HT_SensorDriver *HT_Sensor_Get(uint8_t idx) {
+    return (idx < sensor_count) ? sensors[idx] : NULL;
+}
+
+void HT_Sensor_SampleAll(uint8_t mask, HT_SensorReading *readings, int *status) {
+    uint16_t wait_ms = 0;
+
+    // Start every conversion first so they run concurrently
+    for (uint8_t i = 0; i < sensor_count; ++i) {
+        if (!(mask & (1 << i)))
+            continue;
+
+        status[i] = HT_SENSOR_OK;
+        if ((sensors[i]->caps & HT_SENSOR_CAP_TRIGGERED) && sensors[i]->trigger) {
+            status[i] = sensors[i]->trigger();
+            if (status[i] == HT_SENSOR_OK && sensors[i]->conversion_ms > wait_ms)
+                wait_ms = sensors[i]->conversion_ms;
+        }
+    }
+
+    if (wait_ms)
+        osDelay(wait_ms);
+
+    for (uint8_t i = 0; i < sensor_count; ++i) {
+        if (!(mask & (1 << i)) || status[i] != HT_SENSOR_OK)
+            continue;
+
+        status[i] = sensors[i]->read(&readings[i]);
+    }
+}
+
+uint16_t HT_Sensor_MinPeriod(uint8_t mask) {
+    uint16_t period = 0;
+
+    for (uint8_t i = 0; i < sensor_count; ++i) {
+        if ((mask & (1 << i)) && sensors[i]->min_period_ms > period)
+            period = sensors[i]->min_period_ms;
+    }
+
+    return period;
+}
+
+HT_SensorStats *HT_Sensor_GetStats(uint8_t idx) {
+    if (idx >= sensor_count)
+        return NULL;
+
+    return &HT_Retention_Get()->sensor_stats[sensor_slot[idx]];
+}
+
+void HT_Sensor_PowerOn(void) {
+    HT_RetentionData *ret = HT_Retention_Get();
+    uint8_t switched = 0;
+
+    for (uint8_t i = 0; i < sizeof(sensor_table) / sizeof(sensor_table[0]); ++i) {
+        if ((sensor_table[i]->caps & HT_SENSOR_CAP_POWER) && sensor_table[i]->power) {
+            sensor_table[i]->power(1);
+            switched = 1;
+        }
+    }
+
+    // Without a switched supply the sensors only lose power on a power-on reset,
+    // so the warm-up started before hibernate still counts. Retention SRAM keeps
+    // this through hibernate and a power-on reset starts over anyway, so it is
+    // not worth a flash commit.
+    if (switched || !ret->sensor_powered || slpManGetWakeupSrc() == WAKEUP_FROM_POR) {
+        ret->sensor_power_on = timerlist_hib_get_8HZcounter();
+        ret->sensor_powered = 1;
+    }
+}
+
+void HT_Sensor_PowerOff(void) {
+    HT_RetentionData *ret = HT_Retention_Get();
+
+    for (uint8_t i = 0; i < sizeof(sensor_table) / sizeof(sensor_table[0]); ++i) {
+        if ((sensor_table[i]->caps & HT_SENSOR_CAP_POWER) && sensor_table[i]->power) {
+            sensor_table[i]->power(0);
+            ret->sensor_powered = 0;
+        }
+    }
+}
+
+void HT_Sensor_WaitReady(void) {
+    HT_RetentionData *ret = HT_Retention_Get();
+    uint32_t warmup_ms = 0;
+    uint32_t elapsed_ms;
+
+    for (uint8_t i = 0; i < sizeof(sensor_table) / sizeof(sensor_table[0]); ++i) {
+        if (sensor_table[i]->warmup_ms > warmup_ms)
+            warmup_ms = sensor_table[i]->warmup_ms;
+    }
+
+    elapsed_ms = (timerlist_hib_get_8HZcounter() - ret->sensor_power_on) * HT_SENSOR_8HZ_TICK_MS;
+
+    if (elapsed_ms < warmup_ms) {
+        printf("Aguardando estabilizacao dos sensores: %lu ms\n", warmup_ms - elapsed_ms);
+        osDelay(warmup_ms - elapsed_ms);
+    }
+}
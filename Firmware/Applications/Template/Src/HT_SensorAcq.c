@@ -0,0 +1,93 @@
+#include "HT_SensorAcq.h"
+
+// Spread (max - min) of the last n values.
+static int16_t HT_Acq_Spread(const int16_t *values, uint8_t count, uint8_t n) {
+    int16_t min = values[count - n];
+    int16_t max = min;
+
+    for (uint8_t i = count - n + 1; i < count; ++i) {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+    }
+
+    return max - min;
+}
+
+// Median or trimmed mean of n values, without modifying the source.
+static int16_t HT_Acq_Reduce(const int16_t *values, uint8_t n) {
+    int16_t sorted[HT_ACQ_MAX_SAMPLES];
+
+    // Insertion sort, n is at most HT_ACQ_MAX_SAMPLES
+    for (uint8_t i = 0; i < n; ++i) {
+        int16_t v = values[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+#if HT_ACQ_REDUCE_MEDIAN == 1
+    if (n & 1)
+        return sorted[n / 2];
+
+    return (int16_t)((sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+#else
+    int32_t sum = 0;
+    uint8_t first = (n > 2) ? 1 : 0;
+    uint8_t last = (n > 2) ? n - 1 : n;
+
+    for (uint8_t i = first; i < last; ++i)
+        sum += sorted[i];
+
+    return (int16_t)(sum / (last - first));
+#endif
+}
+
+void HT_Acq_Reset(HT_Acq *acq) {
+    acq->count = 0;
+    acq->attempts = 0;
+}
+
+HT_AcqStatus HT_Acq_AddSample(HT_Acq *acq, uint8_t ok, int16_t temperature, int16_t humidity) {
+    acq->attempts++;
+
+    if (ok) {
+        acq->temperature[acq->count] = temperature;
+        acq->humidity[acq->count] = humidity;
+        acq->count++;
+
+        if (acq->count >= HT_ACQ_WINDOW &&
+            HT_Acq_Spread(acq->temperature, acq->count, HT_ACQ_WINDOW) <= HT_ACQ_TEMP_TOLERANCE &&
+            HT_Acq_Spread(acq->humidity, acq->count, HT_ACQ_WINDOW) <= HT_ACQ_HUM_TOLERANCE) {
+            return HT_ACQ_CONVERGED;
+        }
+
+        if (acq->count >= HT_ACQ_MAX_SAMPLES)
+            return HT_ACQ_SATURATED;
+    }
+
+    if (acq->attempts >= HT_ACQ_MAX_ATTEMPTS)
+        return acq->count ? HT_ACQ_SATURATED : HT_ACQ_FAILED;
+
+    return HT_ACQ_PENDING;
+}
+
+uint8_t HT_Acq_GetResult(const HT_Acq *acq, int16_t *temperature, int16_t *humidity) {
+    uint8_t first = 0;
+
+    if (acq->count == 0)
+        return 0;
+
+    if (acq->count >= HT_ACQ_WINDOW &&
+        HT_Acq_Spread(acq->temperature, acq->count, HT_ACQ_WINDOW) <= HT_ACQ_TEMP_TOLERANCE &&
+        HT_Acq_Spread(acq->humidity, acq->count, HT_ACQ_WINDOW) <= HT_ACQ_HUM_TOLERANCE) {
+        first = acq->count - HT_ACQ_WINDOW;
+    }
+
+    *temperature = HT_Acq_Reduce(&acq->temperature[first], acq->count - first);
+    *humidity = HT_Acq_Reduce(&acq->humidity[first], acq->count - first);
+
+    return 1;
+}
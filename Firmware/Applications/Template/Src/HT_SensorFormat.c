@@ -0,0 +1,41 @@
+#include "HT_Sensor.h"
+
+// Kept apart from HT_Sensor.c so it builds on a development host (Test/).
+
+uint8_t HT_Sensor_FormatUInt(uint32_t value, char *out) {
+    char digits[10];
+    uint8_t len = 0;
+    uint8_t n = 0;
+
+    // Least significant digit first
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    while (n)
+        out[len++] = digits[--n];
+
+    out[len] = '\0';
+
+    return len;
+}
+
+uint8_t HT_Sensor_FormatDeci(int16_t value, char *out) {
+    uint8_t len = 0;
+    uint32_t magnitude;
+
+    if (value < 0) {
+        out[len++] = '-';
+        magnitude = (uint32_t)(-(int32_t)value);
+    } else {
+        magnitude = (uint32_t)value;
+    }
+
+    len += HT_Sensor_FormatUInt(magnitude / 10, &out[len]);
+    out[len++] = '.';
+    out[len++] = (char)('0' + magnitude % 10);
+    out[len] = '\0';
+
+    return len;
+}
@@ -0,0 +1,64 @@
+#include "HT_SensorRetry.h"
+
+#define HT_RETRY_NAME_MAX   16      // Longest sensor name copied into the statistics string
+
+static void HT_Retry_Count(uint16_t *counter) {
+    if (*counter < 0xFFFF)
+        (*counter)++;
+}
+
+void HT_Retry_Reset(HT_Retry *retry) {
+    retry->no_response = 0;
+    retry->timeouts = 0;
+}
+
+uint16_t HT_Retry_Next(HT_Retry *retry, HT_SensorStats *stats, int status, uint16_t min_period_ms) {
+    uint32_t delay = min_period_ms;
+
+    if (stats) {
+        HT_Retry_Count(&stats->reads);
+        if (status < 0)
+            HT_Retry_Count(&stats->errors[(-status < HT_SENSOR_ERROR_SLOTS) ? -status : 0]);
+    }
+
+    if (status == HT_SENSOR_ERROR_NO_RESPONSE) {
+        retry->timeouts = 0;
+        if (++retry->no_response >= HT_RETRY_DEAD_LIMIT) {
+            if (stats)
+                HT_Retry_Count(&stats->dead);
+            return HT_RETRY_GIVE_UP;
+        }
+    } else if (status < HT_SENSOR_ERROR_NO_RESPONSE && status >= HT_SENSOR_ERROR_TIMEOUT_LAST) {
+        retry->no_response = 0;
+        if (++retry->timeouts >= HT_RETRY_TIMEOUT_LIMIT)
+            return HT_RETRY_GIVE_UP;
+
+        // min_period, 2x, 4x... capped
+        delay <<= (retry->timeouts - 1);
+        if (delay > HT_RETRY_BACKOFF_MAX_MS)
+            delay = (min_period_ms > HT_RETRY_BACKOFF_MAX_MS) ? min_period_ms : HT_RETRY_BACKOFF_MAX_MS;
+    } else {
+        retry->no_response = 0;
+        retry->timeouts = 0;
+    }
+
+    return (uint16_t)delay;
+}
+
+uint8_t HT_Retry_FormatStats(const char *name, const HT_SensorStats *stats, char *out) {
+    uint8_t len = 0;
+
+    while (*name && len < HT_RETRY_NAME_MAX)
+        out[len++] = *name++;
+    out[len++] = ':';
+
+    len += HT_Sensor_FormatUInt(stats->reads, &out[len]);
+    for (uint8_t i = 0; i < HT_SENSOR_ERROR_SLOTS; ++i) {
+        out[len++] = ',';
+        len += HT_Sensor_FormatUInt(stats->errors[i], &out[len]);
+    }
+    out[len++] = ',';
+    len += HT_Sensor_FormatUInt(stats->dead, &out[len]);
+
+    return len;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include "HT_Time.h"
+#include "HT_Retention.h"
+#include "hibtimer_qcx212.h"
+#include "slpman_qcx212.h"
+#include "ps_lib_api.h"
+#if HT_TIME_SNTP_ENABLE == 1
+#include "sntp.h"
+#endif
+
+static uint8_t time_checked = 0;
+static uint8_t sntp_requested = 0;
+
+// The hibernate counter restarts at power-on, so a mapping restored from flash is stale
+static HT_TimeState *HT_Time_State(void) {
+    HT_TimeState *state = &HT_Retention_Get()->time;
+
+    if (!time_checked) {
+        time_checked = 1;
+        if (slpManGetWakeupSrc() == WAKEUP_FROM_POR && state->synced) {
+            state->synced = 0;
+            HT_Retention_Commit();
+        }
+    }
+
+    return state;
+}
+
+// UTC for an 8Hz counter value, extrapolated from the last sync
+static uint32_t HT_Time_FromTicks(const HT_TimeState *state, uint32_t ticks) {
+    int64_t elapsed = (int32_t)(ticks - state->sync_ticks);
+
+    return state->sync_utc + (int32_t)(elapsed * (1000000 + state->drift_ppm) / (HT_TIME_HZ * 1000000LL));
+}
+
+uint32_t HT_Time_Now(void) {
+    HT_TimeState *state = HT_Time_State();
+    uint32_t ticks = timerlist_hib_get_8HZcounter();
+
+    return state->synced ? HT_Time_FromTicks(state, ticks) : ticks / HT_TIME_HZ;
+}
+
+uint32_t HT_Time_Resolve(uint32_t time) {
+    HT_TimeState *state = HT_Time_State();
+
+    if (time >= HT_TIME_UTC_MIN || !state->synced)
+        return time;
+
+    return HT_Time_FromTicks(state, time * HT_TIME_HZ);
+}
+
+int HT_Time_Sync(void) {
+    HT_TimeState *state = HT_Time_State();
+    OsaUtcTimeTValue utc;
+    uint32_t ticks;
+    int32_t error, elapsed_s, correction;
+
+    if (appGetSystemTimeUtcSync(&utc) != CMS_RET_SUCC || utc.UTCsecs < HT_TIME_UTC_MIN) {
+#if HT_TIME_SNTP_ENABLE == 1
+        // The result lands in the system time, picked up by a later call
+        if (!sntp_requested) {
+            sntp_requested = 1;
+            SntpInit(HT_TIME_SNTP_SERVER, SNTP_DEFAULT_PORT, 0, TRUE);
+        }
+#endif
+        return HT_TIME_ERROR_UNAVAILABLE;
+    }
+
+    ticks = timerlist_hib_get_8HZcounter() - utc.UTCms * HT_TIME_HZ / 1000;
+
+    if (state->synced) {
+        // Error of the extrapolation over the last interval, as a rate correction
+        error = (int32_t)(utc.UTCsecs - HT_Time_FromTicks(state, ticks));
+        elapsed_s = (int32_t)(ticks - state->sync_ticks) / HT_TIME_HZ;
+
+        if (elapsed_s >= HT_TIME_DRIFT_MIN_S) {
+            correction = (int32_t)((int64_t)error * 1000000 / elapsed_s);
+            if (correction > -HT_TIME_DRIFT_MAX_PPM && correction < HT_TIME_DRIFT_MAX_PPM) {
+                // Half of the measured error, so one jittery sync does not swing the rate
+                state->drift_ppm += correction / 2;
+                if (state->drift_ppm > HT_TIME_DRIFT_MAX_PPM)
+                    state->drift_ppm = HT_TIME_DRIFT_MAX_PPM;
+                else if (state->drift_ppm < -HT_TIME_DRIFT_MAX_PPM)
+                    state->drift_ppm = -HT_TIME_DRIFT_MAX_PPM;
+            }
+        } else if (error == 0) {
+            // Too soon to learn anything, keep the older reference for a longer baseline
+            return HT_TIME_OK;
+        }
+
+        printf("\nTempo: erro %ld s em %ld s, deriva %ld ppm\n", error, elapsed_s, state->drift_ppm);
+    }
+
+    state->sync_utc = utc.UTCsecs;
+    state->sync_ticks = ticks;
+    state->synced = 1;
+    HT_Retention_Commit();
+
+    return HT_TIME_OK;
+}
@@ -16,6 +16,7 @@ static uint32_t gCellID = 0;
 static NmAtiSyncRet gNetworkInfo;
 
 uint8_t mqttEpSlpHandler = 0xff;
+uint8_t gRssi = 0xff;       // Last signal quality indication, 0xff until the first one
 
 static volatile uint8_t simReady = 0;
 
@@ -77,6 +78,7 @@ static INT32 registerPSUrcCallback(urcID_t eventID, void *param, uint32_t paramL
         case NB_URC_ID_MM_SIGQ:
         {
             rssi = *(UINT8 *)param;
+            gRssi = rssi;
             HT_TRACE(UNILOG_MQTT, mqttAppTask81, P_INFO, 1, "RSSI signal=%d", rssi);
             break;
         }
@@ -134,6 +136,15 @@ static void HT_MQTTExampleTask(void *arg){
 
     HAL_USART_InitPrint(&huart1, GPR_UART1ClkSel_26M, uart_cntrl, 115200);
     printf("HTNB32L-XXX-Template SenseClima Device!\n");
+
+    // Latch the wakeup pad state before anything else
+    HT_EventWake_Init();
+
+    // Power on, sample, then attach only if a report is due: HT_SampleWake
+    // hibernates again without touching the radio otherwise
+    HT_Sensor_PowerOn();
+    HT_SampleWake();
+
     printf("Trying to connect...\n");
     while(!simReady);
     HT_SetConnectioParameters();
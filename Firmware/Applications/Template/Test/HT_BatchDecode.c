@@ -0,0 +1,289 @@
+#include <string.h>
+#include "HT_BatchDecode.h"
+
+#define CBOR_MAJOR_MASK 0xE0
+#define CBOR_UINT       0x00
+#define CBOR_NINT       0x20
+#define CBOR_TEXT       0x60
+#define CBOR_ARRAY      0x80
+#define CBOR_MAP        0xA0
+#define CBOR_NULL       0xF6
+#define CBOR_ARRAY_INDEF 0x9F
+#define CBOR_BREAK      0xFF
+
+typedef struct {
+    const uint8_t *buf;
+    uint16_t len;
+    uint16_t pos;
+} HT_BatchReader;
+
+static int32_t HT_Batch_UnZigZag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static int HT_Batch_ReadVarint(HT_BatchReader *rd, uint32_t *value) {
+    *value = 0;
+
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+
+        if (rd->pos >= rd->len)
+            return HT_BATCH_ERROR_FORMAT;
+
+        byte = rd->buf[rd->pos++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return HT_BATCH_OK;
+    }
+
+    return HT_BATCH_ERROR_FORMAT;
+}
+
+// Applies a value code to the running value of its channel.
+static int HT_Batch_DecodeValue(uint32_t code, int16_t *prev, int16_t *value) {
+    int32_t next;
+
+    if (code == 0) {
+        *value = HT_SAMPLE_NO_VALUE;
+        return HT_BATCH_OK;
+    }
+
+    next = *prev + HT_Batch_UnZigZag(code - 1);
+    if (next <= HT_SAMPLE_NO_VALUE || next > INT16_MAX)
+        return HT_BATCH_ERROR_FORMAT;
+
+    *prev = *value = (int16_t)next;
+
+    return HT_BATCH_OK;
+}
+
+static int HT_Batch_DecodeDelta(HT_BatchReader *rd, HT_BatchHeader *header,
+                                HT_SampleRecord *records, uint16_t max) {
+    uint8_t flags = rd->buf[rd->pos++] & 0x0F;
+    int16_t prev_temperature = 0, prev_humidity = 0;
+    uint32_t value, prev_time;
+    int count = 0;
+
+    if (flags & ~(HT_BATCH_FLAG_VBAT | HT_BATCH_FLAG_RSSI))
+        return HT_BATCH_ERROR_FORMAT;
+    header->extra.flags = flags;
+
+    if (HT_Batch_ReadVarint(rd, &header->base_time) != HT_BATCH_OK)
+        return HT_BATCH_ERROR_FORMAT;
+    if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK || value > UINT16_MAX)
+        return HT_BATCH_ERROR_FORMAT;
+    header->interval = (uint16_t)value;
+    if (flags & HT_BATCH_FLAG_VBAT) {
+        if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK || value > UINT16_MAX)
+            return HT_BATCH_ERROR_FORMAT;
+        header->extra.vbat_mv = (uint16_t)value;
+    }
+    if (flags & HT_BATCH_FLAG_RSSI) {
+        if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK || value > UINT8_MAX)
+            return HT_BATCH_ERROR_FORMAT;
+        header->extra.rssi = (uint8_t)value;
+    }
+
+    prev_time = header->base_time - header->interval;
+    while (rd->pos < rd->len) {
+        HT_SampleRecord *record = &records[count];
+
+        if (count == max)
+            return HT_BATCH_ERROR_FULL;
+
+        if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK)
+            return HT_BATCH_ERROR_FORMAT;
+        prev_time = record->time = prev_time + header->interval + (uint32_t)HT_Batch_UnZigZag(value);
+
+        if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK ||
+            HT_Batch_DecodeValue(value, &prev_temperature, &record->temperature) != HT_BATCH_OK)
+            return HT_BATCH_ERROR_FORMAT;
+        if (HT_Batch_ReadVarint(rd, &value) != HT_BATCH_OK ||
+            HT_Batch_DecodeValue(value, &prev_humidity, &record->humidity) != HT_BATCH_OK)
+            return HT_BATCH_ERROR_FORMAT;
+
+        count++;
+    }
+
+    return count;
+}
+
+// Reads a CBOR head with a definite argument of at most 32 bits.
+static int HT_Batch_CborHead(HT_BatchReader *rd, uint8_t *major, uint32_t *value) {
+    uint8_t info, n;
+
+    if (rd->pos >= rd->len)
+        return HT_BATCH_ERROR_FORMAT;
+
+    *major = rd->buf[rd->pos] & CBOR_MAJOR_MASK;
+    info = rd->buf[rd->pos++] & 0x1F;
+
+    if (info < 24) {
+        *value = info;
+        return HT_BATCH_OK;
+    }
+    if (info > 26)
+        return HT_BATCH_ERROR_FORMAT;
+
+    n = (uint8_t)(1 << (info - 24));
+    if (rd->len - rd->pos < n)
+        return HT_BATCH_ERROR_FORMAT;
+
+    *value = 0;
+    while (n--)
+        *value = (*value << 8) | rd->buf[rd->pos++];
+
+    return HT_BATCH_OK;
+}
+
+static int HT_Batch_CborUInt(HT_BatchReader *rd, uint32_t max, uint32_t *value) {
+    uint8_t major;
+
+    if (HT_Batch_CborHead(rd, &major, value) != HT_BATCH_OK || major != CBOR_UINT || *value > max)
+        return HT_BATCH_ERROR_FORMAT;
+
+    return HT_BATCH_OK;
+}
+
+static int HT_Batch_CborInt(HT_BatchReader *rd, int64_t *value) {
+    uint8_t major;
+    uint32_t arg;
+
+    if (HT_Batch_CborHead(rd, &major, &arg) != HT_BATCH_OK)
+        return HT_BATCH_ERROR_FORMAT;
+
+    if (major == CBOR_UINT)
+        *value = arg;
+    else if (major == CBOR_NINT)
+        *value = -1 - (int64_t)arg;
+    else
+        return HT_BATCH_ERROR_FORMAT;
+
+    return HT_BATCH_OK;
+}
+
+static int HT_Batch_CborValue(HT_BatchReader *rd, int16_t *value) {
+    int64_t v;
+
+    if (rd->pos < rd->len && rd->buf[rd->pos] == CBOR_NULL) {
+        rd->pos++;
+        *value = HT_SAMPLE_NO_VALUE;
+        return HT_BATCH_OK;
+    }
+
+    if (HT_Batch_CborInt(rd, &v) != HT_BATCH_OK || v <= HT_SAMPLE_NO_VALUE || v > INT16_MAX)
+        return HT_BATCH_ERROR_FORMAT;
+    *value = (int16_t)v;
+
+    return HT_BATCH_OK;
+}
+
+static int HT_Batch_CborSamples(HT_BatchReader *rd, const HT_BatchHeader *header,
+                                HT_SampleRecord *records, uint16_t max) {
+    uint32_t prev_time = header->base_time - header->interval;
+    int count = 0;
+
+    if (rd->pos >= rd->len || rd->buf[rd->pos++] != CBOR_ARRAY_INDEF)
+        return HT_BATCH_ERROR_FORMAT;
+
+    for (;;) {
+        HT_SampleRecord *record = &records[count];
+        uint8_t major;
+        uint32_t n;
+        int64_t deviation;
+
+        if (rd->pos >= rd->len)
+            return HT_BATCH_ERROR_FORMAT;
+        if (rd->buf[rd->pos] == CBOR_BREAK) {
+            rd->pos++;
+            return count;
+        }
+        if (count == max)
+            return HT_BATCH_ERROR_FULL;
+
+        if (HT_Batch_CborHead(rd, &major, &n) != HT_BATCH_OK || major != CBOR_ARRAY || n != 3)
+            return HT_BATCH_ERROR_FORMAT;
+        if (HT_Batch_CborInt(rd, &deviation) != HT_BATCH_OK || deviation < INT32_MIN || deviation > INT32_MAX)
+            return HT_BATCH_ERROR_FORMAT;
+        prev_time = record->time = prev_time + header->interval + (uint32_t)(int32_t)deviation;
+        if (HT_Batch_CborValue(rd, &record->temperature) != HT_BATCH_OK ||
+            HT_Batch_CborValue(rd, &record->humidity) != HT_BATCH_OK)
+            return HT_BATCH_ERROR_FORMAT;
+
+        count++;
+    }
+}
+
+static int HT_Batch_DecodeCbor(HT_BatchReader *rd, HT_BatchHeader *header,
+                               HT_SampleRecord *records, uint16_t max) {
+    uint8_t major, seen = 0;
+    uint32_t pairs, n, value;
+    int count = HT_BATCH_ERROR_FORMAT;
+
+    if (HT_Batch_CborHead(rd, &major, &pairs) != HT_BATCH_OK || major != CBOR_MAP)
+        return HT_BATCH_ERROR_FORMAT;
+
+    // Keys are accepted in any order, the samples need t0 and dt first
+    while (pairs--) {
+        const char *key;
+
+        if (HT_Batch_CborHead(rd, &major, &n) != HT_BATCH_OK || major != CBOR_TEXT || (uint32_t)(rd->len - rd->pos) < n)
+            return HT_BATCH_ERROR_FORMAT;
+        key = (const char *)&rd->buf[rd->pos];
+        rd->pos += n;
+
+        if (n == 2 && memcmp(key, "t0", 2) == 0 && !(seen & 0x01)) {
+            if (HT_Batch_CborUInt(rd, UINT32_MAX, &header->base_time) != HT_BATCH_OK)
+                return HT_BATCH_ERROR_FORMAT;
+            seen |= 0x01;
+        } else if (n == 2 && memcmp(key, "dt", 2) == 0 && !(seen & 0x02)) {
+            if (HT_Batch_CborUInt(rd, UINT16_MAX, &value) != HT_BATCH_OK)
+                return HT_BATCH_ERROR_FORMAT;
+            header->interval = (uint16_t)value;
+            seen |= 0x02;
+        } else if (n == 4 && memcmp(key, "vbat", 4) == 0 && !(header->extra.flags & HT_BATCH_FLAG_VBAT)) {
+            if (HT_Batch_CborUInt(rd, UINT16_MAX, &value) != HT_BATCH_OK)
+                return HT_BATCH_ERROR_FORMAT;
+            header->extra.vbat_mv = (uint16_t)value;
+            header->extra.flags |= HT_BATCH_FLAG_VBAT;
+        } else if (n == 4 && memcmp(key, "rssi", 4) == 0 && !(header->extra.flags & HT_BATCH_FLAG_RSSI)) {
+            if (HT_Batch_CborUInt(rd, UINT8_MAX, &value) != HT_BATCH_OK)
+                return HT_BATCH_ERROR_FORMAT;
+            header->extra.rssi = (uint8_t)value;
+            header->extra.flags |= HT_BATCH_FLAG_RSSI;
+        } else if (n == 1 && key[0] == 's' && seen == 0x03) {
+            count = HT_Batch_CborSamples(rd, header, records, max);
+            if (count < 0)
+                return count;
+            seen |= 0x04;
+        } else {
+            return HT_BATCH_ERROR_FORMAT;
+        }
+    }
+
+    if (seen != 0x07 || rd->pos != rd->len)
+        return HT_BATCH_ERROR_FORMAT;
+
+    return count;
+}
+
+int HT_Batch_Decode(const uint8_t *buf, uint16_t len, HT_BatchHeader *header,
+                    HT_SampleRecord *records, uint16_t max) {
+    HT_BatchReader rd = { buf, len, 0 };
+
+    memset(header, 0, sizeof(*header));
+    if (len == 0)
+        return HT_BATCH_ERROR_FORMAT;
+
+    if ((buf[0] & 0xF0) == HT_BATCH_VERSION) {
+        header->format = HT_BATCH_FORMAT_DELTA;
+        return HT_Batch_DecodeDelta(&rd, header, records, max);
+    }
+
+    if ((buf[0] & CBOR_MAJOR_MASK) == CBOR_MAP) {
+        header->format = HT_BATCH_FORMAT_CBOR;
+        return HT_Batch_DecodeCbor(&rd, header, records, max);
+    }
+
+    return HT_BATCH_ERROR_FORMAT;
+}
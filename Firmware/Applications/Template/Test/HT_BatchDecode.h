@@ -0,0 +1,23 @@
+#ifndef __HT_BATCHDECODE_H__
+#define __HT_BATCHDECODE_H__
+
+#include <stdint.h>
+#include "HT_BatchCodec.h"
+
+// Reference decoder for the batch formats of HT_BatchCodec.h, as a backend
+// would implement it. Host side only: the device never decodes batches.
+
+typedef struct {
+    uint8_t format;         // HT_BATCH_FORMAT_*
+    uint32_t base_time;
+    uint16_t interval;
+    HT_BatchExtra extra;    // Fields not flagged are 0
+} HT_BatchHeader;
+
+// Decodes a DELTA or CBOR batch, telling them apart by the first byte.
+// Returns the number of samples written to records, HT_BATCH_ERROR_FULL when
+// there are more than max, or HT_BATCH_ERROR_FORMAT for a malformed payload.
+int HT_Batch_Decode(const uint8_t *buf, uint16_t len, HT_BatchHeader *header,
+                    HT_SampleRecord *records, uint16_t max);
+
+#endif // __HT_BATCHDECODE_H__
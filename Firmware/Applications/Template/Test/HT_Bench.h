@@ -0,0 +1,31 @@
+#ifndef __HT_BENCH_H__
+#define __HT_BENCH_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Host benchmarks. Timings are taken on the build machine and are only useful
+// to compare variants within one run; sizes and flash operation counts do not
+// depend on the host.
+
+// Monotonic time in ns.
+uint64_t HT_Bench_Ns(void);
+
+// CPU cycle counter where the host has one (x86 TSC), 0 otherwise.
+uint64_t HT_Bench_Cycles(void);
+
+// Prints one timing line: ns and cycles per item over items processed.
+void HT_Bench_Report(const char *name, uint64_t items, uint64_t ns, uint64_t cycles);
+
+// Keeps the compiler from dropping a computed result.
+extern volatile uint32_t ht_bench_sink;
+
+// Benchmarks, one per module group
+void HT_Bench_Decoder(void);
+void HT_Bench_Format(void);
+void HT_Bench_Batch(void);
+void HT_Bench_QLog(void);
+void HT_Bench_Lz(void);
+
+#endif // __HT_BENCH_H__
@@ -0,0 +1,102 @@
+#include "HT_Bench.h"
+#include "HT_BatchCodec.h"
+#include "HT_BatchDecode.h"
+#include "HT_ClimateGen.h"
+#include "HT_Sensor.h"
+
+#define BENCH_SAMPLES       288     // One day at 5 minutes
+#define BENCH_INTERVAL      300
+#define BENCH_PAYLOAD_SIZE  1024    // HT_BATCH_PAYLOAD_SIZE in HT_SenseClima.c
+#define BENCH_ROUNDS        200
+
+static HT_SampleRecord records[BENCH_SAMPLES];
+static HT_SampleRecord decoded[BENCH_SAMPLES];
+static uint8_t payload[BENCH_PAYLOAD_SIZE];
+
+// Text lines of the journal upload before HT_BatchCodec: "time,temp,hum\n",
+// a missing value left empty.
+static uint32_t HT_Bench_TextDay(void) {
+    char *out = (char *)payload;
+    uint32_t total = 0;
+    uint16_t len = 0;
+
+    for (int i = 0; i < BENCH_SAMPLES; ++i) {
+        // Flush when the next line may not fit, as the text upload did
+        if (len > BENCH_PAYLOAD_SIZE - 28) {
+            total += len;
+            len = 0;
+        }
+        len += HT_Sensor_FormatUInt(records[i].time, &out[len]);
+        out[len++] = ',';
+        if (records[i].temperature != HT_SAMPLE_NO_VALUE)
+            len += HT_Sensor_FormatDeci(records[i].temperature, &out[len]);
+        out[len++] = ',';
+        if (records[i].humidity != HT_SAMPLE_NO_VALUE)
+            len += HT_Sensor_FormatDeci(records[i].humidity, &out[len]);
+        out[len++] = '\n';
+    }
+
+    return total + len;
+}
+
+// Encodes the day into as many messages as needed, each one decoded back to
+// check the round trip. Returns the total payload bytes, 0 on a mismatch.
+static uint32_t HT_Bench_BatchDay(uint8_t format, uint8_t check) {
+    HT_BatchExtra extra = { HT_BATCH_FLAG_VBAT | HT_BATCH_FLAG_RSSI, 3300, 40 };
+    HT_BatchEncoder enc;
+    HT_BatchHeader header;
+    uint32_t total = 0;
+    int i = 0;
+
+    while (i < BENCH_SAMPLES) {
+        int first = i;
+        uint16_t len;
+
+        HT_Batch_Begin(&enc, format, payload, sizeof(payload), records[i].time, BENCH_INTERVAL, &extra);
+        while (i < BENCH_SAMPLES && HT_Batch_Add(&enc, &records[i]) == HT_BATCH_OK)
+            i++;
+        len = HT_Batch_End(&enc);
+        total += len;
+
+        if (check && (HT_Batch_Decode(payload, len, &header, decoded, BENCH_SAMPLES) != i - first ||
+                      memcmp(decoded, &records[first], (size_t)(i - first) * sizeof(HT_SampleRecord)) != 0))
+            return 0;
+    }
+
+    return total;
+}
+
+// Uplink bytes per sample of a day of readings, message headers included, and
+// the encode cost, for the text lines and both batch formats.
+void HT_Bench_Batch(void) {
+    static const char *const formats[] = { "text lines", "delta", "CBOR" };
+    HT_ClimateGenConfig config = { 1760000000, BENCH_INTERVAL, 0, 5, 13 };
+
+    printf("batch encoding, %d samples every %d s, %d-byte messages\n",
+           BENCH_SAMPLES, BENCH_INTERVAL, BENCH_PAYLOAD_SIZE);
+
+    for (int jitter = 0; jitter <= 1; ++jitter) {
+        config.jitter = (uint8_t)jitter;
+        HT_ClimateGen_Fill(&config, records, BENCH_SAMPLES);
+
+        for (int f = 0; f < 3; ++f) {
+            uint32_t bytes = (f == 0) ? HT_Bench_TextDay() : HT_Bench_BatchDay((uint8_t)(f - 1), 1);
+            uint64_t ns, cycles;
+            char name[48];
+
+            ns = HT_Bench_Ns();
+            cycles = HT_Bench_Cycles();
+            for (int r = 0; r < BENCH_ROUNDS; ++r)
+                ht_bench_sink += (f == 0) ? HT_Bench_TextDay() : HT_Bench_BatchDay((uint8_t)(f - 1), 0);
+            cycles = HT_Bench_Cycles() - cycles;
+            ns = HT_Bench_Ns() - ns;
+
+            snprintf(name, sizeof(name), "%s%s", formats[f], jitter ? ", +/-1 s jitter" : "");
+            if (bytes == 0)
+                printf("  %-28s round trip FAILED\n", name);
+            else
+                printf("  %-28s %6.2f bytes/sample\n", name, (double)bytes / BENCH_SAMPLES);
+            HT_Bench_Report("  encode", (uint64_t)BENCH_SAMPLES * BENCH_ROUNDS, ns, cycles);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#include "HT_Bench.h"
+#include "HT_DHT22_Decoder.h"
+
+#define BENCH_FRAMES    64
+#define BENCH_ROUNDS    20000
+
+// Decode throughput over a set of frames with random values and edge jitter,
+// in 26MHz capture timer ticks as the edge capture driver records them.
+void HT_Bench_Decoder(void) {
+    static uint16_t pulses[BENCH_FRAMES][DHT22_FRAME_PULSES];
+    DHT22_Frame frame;
+    uint32_t seed = 1;
+    uint64_t ns, cycles;
+    uint8_t bytes[5];
+
+    for (int f = 0; f < BENCH_FRAMES; ++f) {
+        for (int i = 0; i < 4; ++i) {
+            seed = seed * 1103515245 + 12345;
+            bytes[i] = (uint8_t)(seed >> 16);
+        }
+        bytes[4] = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+
+        for (int i = 0; i < DHT22_FRAME_BITS; ++i) {
+            uint8_t bit = (bytes[i / 8] >> (7 - i % 8)) & 1;
+
+            seed = seed * 1103515245 + 12345;
+            pulses[f][2 * i] = (uint16_t)(50 * 26 + (seed >> 16) % 105 - 52);
+            pulses[f][2 * i + 1] = (uint16_t)((bit ? 70 : 26) * 26 + (seed >> 24) % 53 - 26);
+        }
+    }
+
+    printf("decoder, %d frames x %d rounds\n", BENCH_FRAMES, BENCH_ROUNDS);
+
+    ns = HT_Bench_Ns();
+    cycles = HT_Bench_Cycles();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (int f = 0; f < BENCH_FRAMES; ++f) {
+            if (DHT22_DecodeFrame(pulses[f], DHT22_FRAME_PULSES, &frame) == DHT22_OK)
+                ht_bench_sink += (uint32_t)frame.temperature;
+        }
+    }
+    cycles = HT_Bench_Cycles() - cycles;
+    ns = HT_Bench_Ns() - ns;
+
+    HT_Bench_Report("DHT22_DecodeFrame", (uint64_t)BENCH_ROUNDS * BENCH_FRAMES, ns, cycles);
+}
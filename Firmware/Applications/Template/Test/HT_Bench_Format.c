@@ -0,0 +1,60 @@
+#include "HT_Bench.h"
+#include "HT_Sensor.h"
+
+#define BENCH_VALUES    1024
+#define BENCH_ROUNDS    200
+
+// Cost per formatted sample of the reading path before and after integer
+// tenths. The host has an FPU, so the float variants are cheaper here than
+// with the soft-float library on the target.
+void HT_Bench_Format(void) {
+    static float floats[BENCH_VALUES];
+    static int16_t decis[BENCH_VALUES];
+    char out[16];
+    uint32_t seed = 7;
+    uint64_t ns, cycles;
+    uint64_t items = (uint64_t)BENCH_VALUES * BENCH_ROUNDS;
+
+    for (int i = 0; i < BENCH_VALUES; ++i) {
+        seed = seed * 1103515245 + 12345;
+        decis[i] = (int16_t)((seed >> 16) % 1201 - 400);
+        floats[i] = decis[i] / 10.0f;
+    }
+
+    printf("sample formatting, %d values x %d rounds\n", BENCH_VALUES, BENCH_ROUNDS);
+
+    // Previous path: float reading rounded to tenths, then "%d.%d"
+    ns = HT_Bench_Ns();
+    cycles = HT_Bench_Cycles();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (int i = 0; i < BENCH_VALUES; ++i) {
+            float t = floats[i];
+            int16_t deci = (int16_t)(t * 10.0f + (t < 0 ? -0.5f : 0.5f));
+
+            ht_bench_sink += (uint32_t)snprintf(out, sizeof(out), "%d.%d", deci / 10, deci % 10);
+        }
+    }
+    cycles = HT_Bench_Cycles() - cycles;
+    ns = HT_Bench_Ns() - ns;
+    HT_Bench_Report("float, snprintf \"%d.%d\"", items, ns, cycles);
+
+    ns = HT_Bench_Ns();
+    cycles = HT_Bench_Cycles();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (int i = 0; i < BENCH_VALUES; ++i)
+            ht_bench_sink += (uint32_t)snprintf(out, sizeof(out), "%.1f", (double)floats[i]);
+    }
+    cycles = HT_Bench_Cycles() - cycles;
+    ns = HT_Bench_Ns() - ns;
+    HT_Bench_Report("float, snprintf \"%.1f\"", items, ns, cycles);
+
+    ns = HT_Bench_Ns();
+    cycles = HT_Bench_Cycles();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (int i = 0; i < BENCH_VALUES; ++i)
+            ht_bench_sink += HT_Sensor_FormatDeci(decis[i], out);
+    }
+    cycles = HT_Bench_Cycles() - cycles;
+    ns = HT_Bench_Ns() - ns;
+    HT_Bench_Report("HT_Sensor_FormatDeci", items, ns, cycles);
+}
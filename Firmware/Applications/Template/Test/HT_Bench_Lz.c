@@ -0,0 +1,82 @@
+#include "HT_Bench.h"
+#include "HT_BatchCodec.h"
+#include "HT_ClimateGen.h"
+#include "HT_Lz.h"
+
+// LZ gain on a single batch message against its size, which is what
+// HT_BATCH_LZ_THRESHOLD in HT_SenseClima.c decides on. A session uploads the
+// samples journaled since the last one: full 1024-byte messages for a long
+// backlog, and one short message for the rest or for a short backlog.
+//
+// Each size is the batch of n consecutive samples (0: as many as fit in one
+// message), taken at BENCH_OFFSETS start points over a day of synthetic data
+// so the phase of the daily cycle does not favour one size. A message is sent
+// compressed only when that is smaller, as in HT_PublishBatch.
+
+#define BENCH_SAMPLES       288     // One day at 5 minutes
+#define BENCH_INTERVAL      300
+#define BENCH_PAYLOAD_SIZE  1024    // HT_BATCH_PAYLOAD_SIZE in HT_SenseClima.c
+#define BENCH_OFFSETS       24
+
+static const uint16_t sizes[] = { 4, 8, 12, 16, 24, 32, 48, 64, 96, 128, 0 };
+
+static HT_SampleRecord records[2 * BENCH_SAMPLES];
+static uint8_t payload[BENCH_PAYLOAD_SIZE];
+static uint8_t packed[BENCH_PAYLOAD_SIZE];
+
+static void HT_Bench_LzSize(uint8_t format, uint16_t n) {
+    HT_BatchExtra extra = { HT_BATCH_FLAG_VBAT | HT_BATCH_FLAG_RSSI, 3300, 40 };
+    HT_BatchEncoder enc;
+    uint32_t raw = 0, sent = 0, shrunk = 0, samples = 0;
+    uint64_t cycles = 0, ns = 0;
+
+    for (int o = 0; o < BENCH_OFFSETS; ++o) {
+        const HT_SampleRecord *first = &records[o * BENCH_SAMPLES / BENCH_OFFSETS];
+        uint16_t len;
+        uint64_t c, t;
+        int lz_len;
+
+        HT_Batch_Begin(&enc, format, payload, sizeof(payload), first->time, BENCH_INTERVAL, &extra);
+        for (uint16_t i = 0; (n == 0 || i < n) && HT_Batch_Add(&enc, &first[i]) == HT_BATCH_OK; ++i)
+            samples++;
+        len = HT_Batch_End(&enc);
+
+        t = HT_Bench_Ns();
+        c = HT_Bench_Cycles();
+        lz_len = HT_Lz_Compress(payload, len, packed, len);
+        cycles += HT_Bench_Cycles() - c;
+        ns += HT_Bench_Ns() - t;
+
+        raw += len;
+        if (lz_len > 0) {
+            sent += lz_len;
+            shrunk++;
+        } else {
+            sent += len;
+        }
+    }
+
+    printf("  %4u %6.1f %6.1f %5.2f %6.1f %5u%% %8.0f %7.0f\n", samples / BENCH_OFFSETS,
+           (double)raw / BENCH_OFFSETS, (double)sent / BENCH_OFFSETS, (double)raw / sent,
+           (double)(raw - sent) / BENCH_OFFSETS, shrunk * 100 / BENCH_OFFSETS,
+           (double)cycles / BENCH_OFFSETS, (double)ns / BENCH_OFFSETS);
+}
+
+void HT_Bench_Lz(void) {
+    static const char *const formats[] = { "delta", "CBOR" };
+    HT_ClimateGenConfig config = { 1760000000, BENCH_INTERVAL, 0, 5, 29 };
+
+    printf("LZ on one batch message, mean over %d start points\n", BENCH_OFFSETS);
+
+    for (int jitter = 0; jitter <= 1; ++jitter) {
+        config.jitter = (uint8_t)jitter;
+        HT_ClimateGen_Fill(&config, records, 2 * BENCH_SAMPLES);
+
+        for (int f = 0; f < 2; ++f) {
+            printf("  %s%s\n", formats[f], jitter ? ", +/-1 s jitter" : "");
+            printf("  samp  bytes   sent ratio  saved shrunk   cycles      ns\n");
+            for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+                HT_Bench_LzSize((uint8_t)f, sizes[s]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#include <time.h>
+#include "HT_Bench.h"
+
+volatile uint32_t ht_bench_sink;
+
+uint64_t HT_Bench_Ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t HT_Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+void HT_Bench_Report(const char *name, uint64_t items, uint64_t ns, uint64_t cycles) {
+    printf("  %-28s %9.1f ns", name, (double)ns / items);
+    if (cycles)
+        printf(" %9.1f cycles", (double)cycles / items);
+    printf(" %12.0f /s\n", items * 1e9 / (ns ? ns : 1));
+}
+
+int main(void) {
+    HT_Bench_Decoder();
+    HT_Bench_Format();
+    HT_Bench_Batch();
+    HT_Bench_QLog();
+    HT_Bench_Lz();
+
+    return 0;
+}
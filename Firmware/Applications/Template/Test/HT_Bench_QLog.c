@@ -0,0 +1,207 @@
+#include "HT_Bench.h"
+#include "HT_FakeFlash.h"
+#include "HT_QLog.h"
+
+// Journal flash tier: the raw QSPI log against the littlefs file it replaced,
+// for 30 days of 5-minute samples under three upload patterns.
+//
+// The littlefs side is a model, not the library: the SDK only ships liblfs.a
+// (v2.1) for the target. It follows the v2 append path with these assumptions:
+//  - 4KB blocks, 256-byte prog and cache size, the journal file entry in the
+//    root metadata pair, data blocks allocated round-robin over the 82 other
+//    blocks of FLASH_FS_REGION (the lookahead allocator).
+//  - Each spill reopens the file. Its first write extends the CTZ list
+//    (lfs_ctz_extend), which copies the partial last block to a newly erased
+//    block. Every further block crossed costs one more erase.
+//  - Data is programmed in whole prog units, the copy included.
+//  - Each close, and the remove on clear, is one metadata commit of one prog
+//    unit. A full metadata block is compacted into the other block of the
+//    pair: one erase and one prog unit. block_cycles relocation is ignored.
+//
+// Device time is estimated from typical QSPI NOR figures (W25Q/GD25Q class):
+// 45 ms per 4KB sector erase, page program 30 us + 2.5 us per further byte,
+// at most 400 us per 256-byte page.
+
+#define BENCH_DAYS          30
+#define BENCH_PER_DAY       288
+#define BENCH_RECORDS       (BENCH_DAYS * BENCH_PER_DAY)
+
+#define LFS_BLOCK_SIZE      4096
+#define LFS_PROG_SIZE       256
+#define LFS_BLOCKS          84
+#define LFS_DATA_BLOCKS     (LFS_BLOCKS - 2)
+#define LFS_RECORD_SIZE     8       // sizeof(HT_SampleRecord) in the file
+
+#define NOR_ERASE_US        45000
+#define NOR_PROG_FIRST_US   30
+#define NOR_PROG_BYTE_US    2.5
+#define NOR_PAGE_US         400
+#define NOR_PAGE_SIZE       256
+
+typedef struct {
+    const char *name;
+    uint16_t spill;         // Records per flash write (the RAM ring size, 1 without the ring)
+    uint16_t clear;         // Records between uploads that clear the log, 0 for none
+} HT_BenchWorkload;
+
+typedef struct {
+    uint32_t erases;
+    uint32_t programs;
+    uint32_t program_bytes;
+    double device_us;
+} HT_BenchCost;
+
+typedef struct {
+    uint32_t size;          // File size in bytes
+    uint16_t next_block;    // Allocator position
+    uint16_t meta_used;     // Prog units used in the active metadata block
+    uint8_t meta_active;
+    uint32_t data_erases[LFS_DATA_BLOCKS];
+    uint32_t meta_erases[2];
+    HT_BenchCost cost;
+} HT_BenchLfs;
+
+static const HT_BenchWorkload workloads[] = {
+    { "per sample, daily upload", 1, BENCH_PER_DAY },
+    { "96-record ring, daily upload", 96, BENCH_PER_DAY },
+    { "96-record ring, 30-day outage", 96, 0 },
+};
+
+static double HT_Bench_ProgramUs(uint32_t bytes) {
+    double us = 0;
+
+    while (bytes) {
+        uint32_t n = bytes < NOR_PAGE_SIZE ? bytes : NOR_PAGE_SIZE;
+        double page = NOR_PROG_FIRST_US + NOR_PROG_BYTE_US * (n - 1);
+
+        us += page < NOR_PAGE_US ? page : NOR_PAGE_US;
+        bytes -= n;
+    }
+
+    return us;
+}
+
+static void HT_Bench_LfsProgram(HT_BenchLfs *lfs, uint32_t bytes) {
+    bytes = (bytes + LFS_PROG_SIZE - 1) / LFS_PROG_SIZE * LFS_PROG_SIZE;
+    lfs->cost.programs += bytes / LFS_PROG_SIZE;
+    lfs->cost.program_bytes += bytes;
+    lfs->cost.device_us += HT_Bench_ProgramUs(bytes);
+}
+
+static void HT_Bench_LfsEraseData(HT_BenchLfs *lfs) {
+    lfs->data_erases[lfs->next_block]++;
+    lfs->next_block = (uint16_t)((lfs->next_block + 1) % LFS_DATA_BLOCKS);
+    lfs->cost.erases++;
+    lfs->cost.device_us += NOR_ERASE_US;
+}
+
+static void HT_Bench_LfsCommit(HT_BenchLfs *lfs) {
+    if (++lfs->meta_used == LFS_BLOCK_SIZE / LFS_PROG_SIZE) {
+        lfs->meta_active ^= 1;
+        lfs->meta_erases[lfs->meta_active]++;
+        lfs->cost.erases++;
+        lfs->cost.device_us += NOR_ERASE_US;
+        lfs->meta_used = 1;     // The compacted directory
+        HT_Bench_LfsProgram(lfs, LFS_PROG_SIZE);
+    }
+    HT_Bench_LfsProgram(lfs, LFS_PROG_SIZE);
+}
+
+// Open, append n records, close.
+static void HT_Bench_LfsSpill(HT_BenchLfs *lfs, uint16_t n) {
+    uint32_t off = lfs->size % LFS_BLOCK_SIZE;
+    uint32_t bytes = (uint32_t)n * LFS_RECORD_SIZE;
+
+    if (lfs->size == 0 || off != 0) {
+        HT_Bench_LfsEraseData(lfs);
+        HT_Bench_LfsProgram(lfs, off);
+    }
+    for (uint32_t end = off + bytes; end > LFS_BLOCK_SIZE; end -= LFS_BLOCK_SIZE)
+        HT_Bench_LfsEraseData(lfs);
+    HT_Bench_LfsProgram(lfs, bytes);
+    lfs->size += bytes;
+
+    HT_Bench_LfsCommit(lfs);
+}
+
+static void HT_Bench_RunLfs(const HT_BenchWorkload *w, HT_BenchLfs *lfs) {
+    memset(lfs, 0, sizeof(*lfs));
+
+    for (uint32_t i = 0; i < BENCH_RECORDS; i += w->spill) {
+        HT_Bench_LfsSpill(lfs, w->spill);
+        if (w->clear && (i + w->spill) % w->clear == 0) {
+            lfs->size = 0;
+            HT_Bench_LfsCommit(lfs);
+        }
+    }
+}
+
+static double qlog_program_us;
+
+static void HT_Bench_QLogProgram(uint32_t size) {
+    qlog_program_us += HT_Bench_ProgramUs(size);
+}
+
+static void HT_Bench_RunQLog(const HT_BenchWorkload *w, HT_BenchCost *cost) {
+    HT_QLogState state;
+    HT_SampleRecord record = { 0, 215, 550 };
+
+    HT_FakeFlash_Reset();
+    memset(&state, 0, sizeof(state));
+    HT_QLog_Init(&state);
+
+    qlog_program_us = 0;
+    ht_fake_flash_on_program = HT_Bench_QLogProgram;
+    for (uint32_t i = 0; i < BENCH_RECORDS; ++i) {
+        record.time = i * 300;
+        HT_QLog_Append(&state, &record);
+        if (w->clear && (i + 1) % w->clear == 0)
+            HT_QLog_Clear(&state);
+    }
+    ht_fake_flash_on_program = NULL;
+
+    cost->erases = ht_fake_flash_erases;
+    cost->programs = ht_fake_flash_programs;
+    cost->program_bytes = ht_fake_flash_program_bytes;
+    cost->device_us = qlog_program_us + (double)ht_fake_flash_erases * NOR_ERASE_US;
+}
+
+static void HT_Bench_PrintCost(const char *name, const HT_BenchCost *cost) {
+    printf("    %-8s %6u erases %7u programs %8u bytes, device %7.1f ms/day, %6.0f appends/s\n",
+           name, cost->erases, cost->programs, cost->program_bytes,
+           cost->device_us / 1000.0 / BENCH_DAYS, BENCH_RECORDS * 1e6 / cost->device_us);
+}
+
+void HT_Bench_QLog(void) {
+    printf("journal flash tier, %d days of %d samples\n", BENCH_DAYS, BENCH_PER_DAY);
+
+    for (unsigned w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w) {
+        static HT_BenchLfs lfs;
+        HT_BenchCost qlog = { 0, 0, 0, 0 };
+        uint32_t lo = UINT32_MAX, hi = 0;
+        uint64_t ns;
+
+        printf("  %s\n", workloads[w].name);
+
+        ns = HT_Bench_Ns();
+        HT_Bench_RunQLog(&workloads[w], &qlog);
+        ns = HT_Bench_Ns() - ns;
+        HT_Bench_PrintCost("qlog", &qlog);
+        HT_Bench_Report("  qlog append on the host", BENCH_RECORDS, ns, 0);
+        printf("      erases per sector:");
+        for (int i = 0; i < HT_QLOG_SECTORS; ++i)
+            printf(" %u", ht_fake_flash_sector_erases[i]);
+        printf("\n");
+
+        HT_Bench_RunLfs(&workloads[w], &lfs);
+        HT_Bench_PrintCost("littlefs", &lfs.cost);
+        for (int i = 0; i < LFS_DATA_BLOCKS; ++i) {
+            if (lfs.data_erases[i] < lo)
+                lo = lfs.data_erases[i];
+            if (lfs.data_erases[i] > hi)
+                hi = lfs.data_erases[i];
+        }
+        printf("      erases per sector: metadata pair %u %u, data blocks %u..%u\n",
+               lfs.meta_erases[0], lfs.meta_erases[1], lo, hi);
+    }
+}
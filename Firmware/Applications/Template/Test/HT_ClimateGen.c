@@ -0,0 +1,38 @@
+#include <math.h>
+#include "HT_ClimateGen.h"
+
+#define CLIMATE_DAY_S       86400.0
+
+static uint32_t HT_ClimateGen_Random(uint32_t *state) {
+    // xorshift32
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+void HT_ClimateGen_Fill(const HT_ClimateGenConfig *config, HT_SampleRecord *records, uint16_t count) {
+    uint32_t state = config->seed;
+
+    for (uint16_t i = 0; i < count; ++i) {
+        uint32_t t = config->base_time + (uint32_t)i * config->interval;
+        double phase = 2.0 * M_PI * (t % 86400) / CLIMATE_DAY_S;
+        int32_t noise_t = (int32_t)(HT_ClimateGen_Random(&state) % 3) - 1;
+        int32_t noise_h = (int32_t)(HT_ClimateGen_Random(&state) % 3) - 1;
+
+        if (config->jitter)
+            t += (uint32_t)((int32_t)(HT_ClimateGen_Random(&state) % (2u * config->jitter + 1)) - config->jitter);
+
+        records[i].time = t;
+        records[i].temperature = (int16_t)(lround(215.0 - 40.0 * cos(phase)) + noise_t);
+        records[i].humidity = (int16_t)(lround(550.0 + 80.0 * cos(phase)) + noise_h);
+
+        if (config->missing && HT_ClimateGen_Random(&state) % 1000 < config->missing) {
+            if (HT_ClimateGen_Random(&state) & 1)
+                records[i].temperature = HT_SAMPLE_NO_VALUE;
+            else
+                records[i].humidity = HT_SAMPLE_NO_VALUE;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef __HT_CLIMATEGEN_H__
+#define __HT_CLIMATEGEN_H__
+
+#include <stdint.h>
+#include "HT_SampleRing.h"
+
+// Synthetic indoor climate series for the host tests and benchmarks: a daily
+// sine on temperature and humidity in opposite phase plus +/-0.1 sensor noise,
+// quantized to the 0.1 resolution of the DHT22. Deterministic for a given seed.
+
+typedef struct {
+    uint32_t base_time;     // Time of the first sample
+    uint16_t interval;      // Nominal sampling period in s
+    uint8_t jitter;         // Wake-up jitter, timestamps move by up to +/-jitter s
+    uint16_t missing;       // Samples per 1000 with a channel missing
+    uint32_t seed;          // Non-zero
+} HT_ClimateGenConfig;
+
+// Fills count records.
+void HT_ClimateGen_Fill(const HT_ClimateGenConfig *config, HT_SampleRecord *records, uint16_t count);
+
+#endif // __HT_CLIMATEGEN_H__
@@ -0,0 +1,77 @@
+#include <string.h>
+#include "HT_FakeFlash.h"
+#include "HT_QLog.h"
+#include "flash_qcx212_rt.h"
+
+// NOR flash model of the QLog region: programming can only clear bits and
+// erasing sets a whole sector back to 0xFF.
+
+uint8_t ht_fake_flash[HT_QLOG_REGION_SIZE];
+uint32_t ht_fake_flash_erases = 0;
+uint32_t ht_fake_flash_sector_erases[HT_QLOG_SECTORS];
+uint32_t ht_fake_flash_programs = 0;
+uint32_t ht_fake_flash_program_bytes = 0;
+void (*ht_fake_flash_on_program)(uint32_t size) = NULL;
+int32_t ht_fake_flash_write_budget = -1;
+
+static uint8_t *HT_FakeFlash_At(uint32_t addr, uint32_t size) {
+    if (addr < HT_QLOG_REGION_OFFSET || addr + size > HT_QLOG_REGION_OFFSET + HT_QLOG_REGION_SIZE)
+        return NULL;
+
+    return &ht_fake_flash[addr - HT_QLOG_REGION_OFFSET];
+}
+
+void HT_FakeFlash_Reset(void) {
+    memset(ht_fake_flash, 0xFF, sizeof(ht_fake_flash));
+    ht_fake_flash_erases = 0;
+    memset(ht_fake_flash_sector_erases, 0, sizeof(ht_fake_flash_sector_erases));
+    ht_fake_flash_programs = 0;
+    ht_fake_flash_program_bytes = 0;
+    ht_fake_flash_write_budget = -1;
+}
+
+uint8_t BSP_QSPI_Erase_Safe(uint32_t SectorAddress, uint32_t Size) {
+    uint8_t *p = HT_FakeFlash_At(SectorAddress, Size);
+
+    if (!p || Size != HT_QLOG_SECTOR_SIZE || SectorAddress % HT_QLOG_SECTOR_SIZE)
+        return QSPI_ERROR;
+
+    memset(p, 0xFF, Size);
+    ht_fake_flash_erases++;
+    ht_fake_flash_sector_erases[(SectorAddress - HT_QLOG_REGION_OFFSET) / HT_QLOG_SECTOR_SIZE]++;
+
+    return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Write_Safe(uint8_t *pData, uint32_t WriteAddr, uint32_t Size) {
+    uint8_t *p = HT_FakeFlash_At(WriteAddr, Size);
+
+    if (!p)
+        return QSPI_ERROR;
+
+    // Simulated reset: the write never reaches the flash
+    if (ht_fake_flash_write_budget == 0)
+        return QSPI_ERROR;
+    if (ht_fake_flash_write_budget > 0)
+        ht_fake_flash_write_budget--;
+
+    for (uint32_t i = 0; i < Size; ++i)
+        p[i] &= pData[i];
+    ht_fake_flash_programs++;
+    ht_fake_flash_program_bytes += Size;
+    if (ht_fake_flash_on_program)
+        ht_fake_flash_on_program(Size);
+
+    return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Read_Safe(uint8_t *pData, uint32_t WriteAddr, uint32_t Size) {
+    uint8_t *p = HT_FakeFlash_At(WriteAddr, Size);
+
+    if (!p)
+        return QSPI_ERROR;
+
+    memcpy(pData, p, Size);
+
+    return QSPI_OK;
+}
@@ -0,0 +1,20 @@
+#ifndef __HT_FAKEFLASH_H__
+#define __HT_FAKEFLASH_H__
+
+#include <stdint.h>
+#include "HT_QLog.h"
+
+// Host replacement of the QSPI driver calls used by HT_QLog.c.
+
+extern uint8_t ht_fake_flash[];
+extern uint32_t ht_fake_flash_erases;       // Sector erases since the last reset
+extern uint32_t ht_fake_flash_sector_erases[HT_QLOG_SECTORS];   // The same per sector
+extern uint32_t ht_fake_flash_programs;     // Write calls that reached the flash
+extern uint32_t ht_fake_flash_program_bytes;
+extern void (*ht_fake_flash_on_program)(uint32_t size);  // Called per program operation, may be NULL
+extern int32_t ht_fake_flash_write_budget;  // Writes left before they start failing, -1 for no limit
+
+// Erases the whole region and clears the counters.
+void HT_FakeFlash_Reset(void);
+
+#endif // __HT_FAKEFLASH_H__
@@ -0,0 +1,42 @@
+#ifndef __HT_TEST_H__
+#define __HT_TEST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Minimal host test support: a failed check is reported with its location and
+// counted, the suite keeps running so one run shows every failure.
+
+extern unsigned ht_test_checks;
+extern unsigned ht_test_failures;
+
+#define HT_CHECK(cond) do {                                                     \
+        ht_test_checks++;                                                       \
+        if (!(cond)) {                                                          \
+            ht_test_failures++;                                                 \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+        }                                                                       \
+    } while (0)
+
+#define HT_CHECK_EQ(actual, expected) do {                                      \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);         \
+        ht_test_checks++;                                                       \
+        if (a_ != e_) {                                                         \
+            ht_test_failures++;                                                 \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,    \
+                   #actual, a_, e_);                                            \
+        }                                                                       \
+    } while (0)
+
+#define HT_CHECK_STR(actual, expected) HT_CHECK(strcmp((actual), (expected)) == 0)
+
+#define HT_CHECK_MEM(actual, expected, len) HT_CHECK(memcmp((actual), (expected), (len)) == 0)
+
+// Test suites, one per module group
+void HT_Test_Decoder(void);
+void HT_Test_SensorAcq(void);
+void HT_Test_Codec(void);
+void HT_Test_QLog(void);
+
+#endif // __HT_TEST_H__
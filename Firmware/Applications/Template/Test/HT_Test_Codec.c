@@ -0,0 +1,324 @@
+#include "HT_Test.h"
+#include "HT_Lz.h"
+#include "HT_BatchCodec.h"
+#include "HT_BatchDecode.h"
+#include "HT_SampleRing.h"
+#include "HT_Sensor.h"
+#include "HT_Aggregate.h"
+#include "HT_Report.h"
+
+static void HT_Test_Lz(void) {
+    static const uint8_t text[] = "abcabcabcabc";
+    // Three literals, then one overlapping match of 9 at distance 3
+    static const uint8_t packed[] = { HT_LZ_MAGIC, 12, 0, 0x08, 'a', 'b', 'c', 2, 6 };
+    uint8_t in[600], out[700], back[600];
+    uint32_t seed = 1;
+    int len;
+
+    len = HT_Lz_Compress(text, 12, out, sizeof(out));
+    HT_CHECK_EQ(len, sizeof(packed));
+    HT_CHECK_MEM(out, packed, sizeof(packed));
+    HT_CHECK_EQ(HT_Lz_Decompress(packed, sizeof(packed), back, sizeof(back)), 12);
+    HT_CHECK_MEM(back, text, 12);
+
+    // A batch-like payload round trips and shrinks
+    for (int i = 0; i < (int)sizeof(in); ++i)
+        in[i] = (uint8_t)((i % 7 == 0) ? i / 7 : 0x41 + i % 3);
+    len = HT_Lz_Compress(in, sizeof(in), out, sizeof(out));
+    HT_CHECK(len > 0 && len < (int)sizeof(in));
+    HT_CHECK_EQ(HT_Lz_Decompress(out, (uint16_t)len, back, sizeof(back)), sizeof(in));
+    HT_CHECK_MEM(back, in, sizeof(in));
+
+    // Random bytes do not fit a buffer of their own size
+    for (int i = 0; i < (int)sizeof(in); ++i) {
+        seed = seed * 1103515245 + 12345;
+        in[i] = (uint8_t)(seed >> 16);
+    }
+    HT_CHECK_EQ(HT_Lz_Compress(in, sizeof(in), out, sizeof(in)), HT_LZ_ERROR_FULL);
+
+    // Corrupt streams are rejected
+    HT_CHECK_EQ(HT_Lz_Decompress(packed, 2, back, sizeof(back)), HT_LZ_ERROR_FORMAT);
+    HT_CHECK_EQ(HT_Lz_Decompress(packed, sizeof(packed) - 1, back, sizeof(back)), HT_LZ_ERROR_FORMAT);
+    HT_CHECK_EQ(HT_Lz_Decompress(packed, sizeof(packed), back, 11), HT_LZ_ERROR_FULL);
+    memcpy(out, packed, sizeof(packed));
+    out[7] = 5;     // Distance past the start of the output
+    HT_CHECK_EQ(HT_Lz_Decompress(out, sizeof(packed), back, sizeof(back)), HT_LZ_ERROR_FORMAT);
+}
+
+static void HT_Test_Batch(void) {
+    static const HT_SampleRecord samples[] = {
+        { 1000, 215, 600 },
+        { 1061, 213, HT_SAMPLE_NO_VALUE },
+    };
+    static const uint8_t delta[] = {
+        0x10, 0xE8, 0x07, 0x3C,         // Version, t0 1000, dt 60
+        0x00, 0xAF, 0x03, 0xB1, 0x09,   // On time, 21.5, 60.0 from 0
+        0x02, 0x04, 0x00,               // 1s late, -0.2, missing
+    };
+    static const uint8_t cbor[] = {
+        0xA3,
+        0x62, 't', '0', 0x19, 0x03, 0xE8,
+        0x62, 'd', 't', 0x18, 0x3C,
+        0x61, 's', 0x9F,
+        0x83, 0x00, 0x18, 0xD7, 0x19, 0x02, 0x58,
+        0x83, 0x01, 0x18, 0xD5, 0xF6,
+        0xFF,
+    };
+    static const uint8_t extra_header[] = {
+        0xA5, 0x62, 't', '0', 0x00, 0x62, 'd', 't', 0x0A,
+        0x64, 'v', 'b', 'a', 't', 0x19, 0x0C, 0xE4,
+        0x64, 'r', 's', 's', 'i', 0x18, 0x28,
+    };
+    HT_BatchExtra extra = { HT_BATCH_FLAG_VBAT | HT_BATCH_FLAG_RSSI, 3300, 40 };
+    HT_SampleRecord record = { 0, -400, 0 };
+    HT_SampleRecord decoded[4];
+    HT_BatchHeader header;
+    HT_BatchEncoder enc;
+    uint8_t buf[HT_BATCH_HEADER_MAX + 2 * HT_BATCH_SAMPLE_MAX + 1];
+    int ret = HT_BATCH_OK;
+
+    HT_CHECK_EQ(HT_Batch_Begin(&enc, HT_BATCH_FORMAT_DELTA, buf, sizeof(buf), 1000, 60, NULL), HT_BATCH_OK);
+    for (int i = 0; i < 2; ++i)
+        HT_CHECK_EQ(HT_Batch_Add(&enc, &samples[i]), HT_BATCH_OK);
+    HT_CHECK_EQ(HT_Batch_End(&enc), sizeof(delta));
+    HT_CHECK_MEM(buf, delta, sizeof(delta));
+    HT_CHECK_EQ(HT_Batch_Decode(delta, sizeof(delta), &header, decoded, 4), 2);
+    HT_CHECK_MEM(decoded, samples, sizeof(samples));
+
+    HT_CHECK_EQ(HT_Batch_Begin(&enc, HT_BATCH_FORMAT_CBOR, buf, sizeof(buf), 1000, 60, NULL), HT_BATCH_OK);
+    for (int i = 0; i < 2; ++i)
+        HT_CHECK_EQ(HT_Batch_Add(&enc, &samples[i]), HT_BATCH_OK);
+    HT_CHECK_EQ(HT_Batch_End(&enc), sizeof(cbor));
+    HT_CHECK_MEM(buf, cbor, sizeof(cbor));
+    HT_CHECK_EQ(HT_Batch_Decode(cbor, sizeof(cbor), &header, decoded, 4), 2);
+    HT_CHECK_MEM(decoded, samples, sizeof(samples));
+    HT_CHECK_EQ(header.base_time, 1000);
+    HT_CHECK_EQ(header.interval, 60);
+
+    // Truncated, oversized and foreign payloads are rejected
+    HT_CHECK_EQ(HT_Batch_Decode(delta, 6, &header, decoded, 4), HT_BATCH_ERROR_FORMAT);
+    HT_CHECK_EQ(HT_Batch_Decode(cbor, sizeof(cbor) - 1, &header, decoded, 4), HT_BATCH_ERROR_FORMAT);
+    HT_CHECK_EQ(HT_Batch_Decode(delta, sizeof(delta), &header, decoded, 1), HT_BATCH_ERROR_FULL);
+    HT_CHECK_EQ(HT_Batch_Decode(cbor, sizeof(cbor), &header, decoded, 1), HT_BATCH_ERROR_FULL);
+    buf[0] = HT_LZ_MAGIC;
+    HT_CHECK_EQ(HT_Batch_Decode(buf, 1, &header, decoded, 4), HT_BATCH_ERROR_FORMAT);
+
+    HT_CHECK_EQ(HT_Batch_Begin(&enc, HT_BATCH_FORMAT_CBOR, buf, sizeof(buf), 0, 10, &extra), HT_BATCH_OK);
+    HT_CHECK_MEM(buf, extra_header, sizeof(extra_header));
+
+    // Negative CBOR integer: -40.0 is major type 1, argument 399
+    HT_Batch_Add(&enc, &record);
+    HT_CHECK_EQ(buf[sizeof(extra_header) + 5], 0x39);
+    HT_CHECK_EQ(buf[sizeof(extra_header) + 6], 0x01);
+    HT_CHECK_EQ(buf[sizeof(extra_header) + 7], 0x8F);
+
+    // A full batch refuses the sample and stays terminable
+    while (ret == HT_BATCH_OK)
+        ret = HT_Batch_Add(&enc, &record);
+    HT_CHECK_EQ(ret, HT_BATCH_ERROR_FULL);
+    HT_CHECK(HT_Batch_End(&enc) <= sizeof(buf));
+    HT_CHECK_EQ(buf[enc.len - 1], 0xFF);
+
+    HT_CHECK_EQ(HT_Batch_Begin(&enc, HT_BATCH_FORMAT_DELTA, buf, HT_BATCH_HEADER_MAX, 0, 10, NULL), HT_BATCH_ERROR_FULL);
+    HT_CHECK_EQ(HT_Batch_Begin(&enc, 7, buf, sizeof(buf), 0, 10, NULL), HT_BATCH_ERROR_FORMAT);
+}
+
+static uint32_t HT_Test_Random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+// Random batches through the encoder and back: missing values, negative and
+// full-range values, late, early and skipped wakes, with and without extras.
+static void HT_Test_BatchRoundTrip(void) {
+    static HT_SampleRecord records[200], decoded[200];
+    static uint8_t buf[1024];
+    HT_BatchHeader header;
+    HT_BatchEncoder enc;
+    uint32_t state = 0x13579BDF;
+    unsigned mismatches = 0;
+
+    for (int round = 0; round < 200; ++round) {
+        uint8_t format = (round & 1) ? HT_BATCH_FORMAT_CBOR : HT_BATCH_FORMAT_DELTA;
+        HT_BatchExtra extra = { (uint8_t)((round >> 1) & 3), (uint16_t)HT_Test_Random(&state), (uint8_t)HT_Test_Random(&state) };
+        uint16_t interval = (uint16_t)(1 + HT_Test_Random(&state) % 3600);
+        uint32_t base_time = HT_Test_Random(&state), time = base_time - interval;
+        int16_t temperature = 0, humidity = 0;
+        uint16_t size = (uint16_t)(HT_BATCH_HEADER_MAX + HT_BATCH_SAMPLE_MAX + 1 + HT_Test_Random(&state) % 960);
+        int ret = HT_BATCH_OK, count;
+        uint16_t len;
+
+        HT_CHECK_EQ(HT_Batch_Begin(&enc, format, buf, size, base_time, interval, &extra), HT_BATCH_OK);
+        for (int i = 0; i < 200 && ret == HT_BATCH_OK; ++i) {
+            uint32_t r = HT_Test_Random(&state);
+
+            // Mostly on time, some jitter, occasionally a skipped or backwards step
+            if (r % 16 == 0)
+                time += interval * (1 + r % 7) + r % 100;
+            else if (r % 16 == 1)
+                time -= r % 5000;
+            else
+                time += interval + r % 3 - 1;
+
+            // Small random walk, with the odd jump across the whole range
+            r = HT_Test_Random(&state);
+            temperature = (r % 32 == 0) ? (int16_t)(r >> 16) : (int16_t)(temperature + (int16_t)(r % 9) - 4);
+            humidity = (r % 32 == 1) ? (int16_t)(r >> 16) : (int16_t)(humidity + (int16_t)((r >> 8) % 9) - 4);
+            if (temperature == HT_SAMPLE_NO_VALUE)
+                temperature++;
+            if (humidity == HT_SAMPLE_NO_VALUE)
+                humidity++;
+
+            records[i].time = time;
+            records[i].temperature = (r % 10 == 2) ? HT_SAMPLE_NO_VALUE : temperature;
+            records[i].humidity = (r % 10 == 3) ? HT_SAMPLE_NO_VALUE : humidity;
+            ret = HT_Batch_Add(&enc, &records[i]);
+        }
+        len = HT_Batch_End(&enc);
+
+        count = HT_Batch_Decode(buf, len, &header, decoded, 200);
+        HT_CHECK_EQ(count, enc.count);
+        if (count != enc.count || memcmp(decoded, records, count * sizeof(HT_SampleRecord)) != 0 ||
+            header.format != format || header.base_time != base_time ||
+            header.interval != interval || header.extra.flags != extra.flags ||
+            ((extra.flags & HT_BATCH_FLAG_VBAT) && header.extra.vbat_mv != extra.vbat_mv) ||
+            ((extra.flags & HT_BATCH_FLAG_RSSI) && header.extra.rssi != extra.rssi))
+            mismatches++;
+    }
+    HT_CHECK_EQ(mismatches, 0);
+}
+
+static void HT_Test_Format(void) {
+    char out[HT_SENSOR_DECI_STR_SIZE];
+    char num[11];
+
+    HT_CHECK_EQ(HT_Sensor_FormatDeci(278, out), 4);
+    HT_CHECK_STR(out, "27.8");
+    HT_CHECK_EQ(HT_Sensor_FormatDeci(-5, out), 4);
+    HT_CHECK_STR(out, "-0.5");
+    HT_Sensor_FormatDeci(0, out);
+    HT_CHECK_STR(out, "0.0");
+    HT_CHECK_EQ(HT_Sensor_FormatDeci(INT16_MIN, out), 7);
+    HT_CHECK_STR(out, "-3276.8");
+    HT_CHECK_EQ(HT_Sensor_FormatUInt(4294967295u, num), 10);
+    HT_CHECK_STR(num, "4294967295");
+}
+
+static void HT_Test_Ring(void) {
+    static const uint8_t check[] = "123456789";
+    static HT_SampleRing ring;
+    HT_SampleRecord record = { 0, 0, 0 };
+    HT_SampleRecord out[4];
+
+    // CRC-16/CCITT-FALSE check value
+    HT_CHECK_EQ(HT_Ring_Crc16(0xFFFF, check, 9), 0x29B1);
+
+    HT_Ring_Reset(&ring);
+    HT_CHECK(HT_Ring_IsValid(&ring));
+
+    for (int i = 0; i < HT_RING_RECORDS; ++i) {
+        record.time = (uint32_t)i;
+        HT_CHECK_EQ(HT_Ring_Push(&ring, &record), HT_RING_OK);
+    }
+    HT_CHECK_EQ(HT_Ring_Push(&ring, &record), HT_RING_ERROR_FULL);
+
+    // Wrap around the end of the array
+    HT_Ring_Drop(&ring, HT_RING_RECORDS - 2);
+    record.time = 1000;
+    HT_CHECK_EQ(HT_Ring_Push(&ring, &record), HT_RING_OK);
+    HT_CHECK_EQ(HT_Ring_Read(&ring, 0, out, 4), 3);
+    HT_CHECK_EQ(out[0].time, HT_RING_RECORDS - 2);
+    HT_CHECK_EQ(out[1].time, HT_RING_RECORDS - 1);
+    HT_CHECK_EQ(out[2].time, 1000);
+    HT_CHECK(HT_Ring_IsValid(&ring));
+
+    // A lost retention bit is caught
+    ring.records[0].temperature ^= 0x10;
+    HT_CHECK(!HT_Ring_IsValid(&ring));
+}
+
+static void HT_Test_Aggregate(void) {
+    static const int16_t temps[] = { 200, 210, 220 };
+    static const int16_t hums[] = { 500, HT_SAMPLE_NO_VALUE, 520 };
+    HT_AggState state, closed;
+    char out[HT_AGG_STR_SIZE];
+
+    HT_Agg_Reset(&state);
+    for (int i = 0; i < 3; ++i)
+        HT_CHECK_EQ(HT_Agg_Add(&state, 3600, 3700 + 600 * i, temps[i], hums[i], &closed), 0);
+    HT_CHECK_EQ(state.start, 3600);
+
+    HT_CHECK_EQ(HT_Agg_Add(&state, 3600, 7200, -5, HT_SAMPLE_NO_VALUE, &closed), 1);
+    HT_Agg_Format(&closed, closed.start, 3600, out);
+    HT_CHECK_STR(out, "3600,3600,3,20.0,22.0,21.0,0.8,2,50.0,52.0,51.0,1.0");
+
+    // Half away from zero, and a channel without values
+    HT_Agg_Add(&state, 3600, 7300, -6, HT_SAMPLE_NO_VALUE, &closed);
+    HT_CHECK_EQ(HT_Agg_Add(&state, 3600, 10800, 0, 0, &closed), 1);
+    HT_Agg_Format(&closed, closed.start, 3600, out);
+    HT_CHECK_STR(out, "7200,3600,2,-0.6,-0.5,-0.6,0.1,0");
+
+    // Full window of extreme values: n * sum_sq - sum^2 needs the whole int64 range
+    HT_Agg_Reset(&state);
+    for (uint32_t i = 0; i < UINT16_MAX; ++i)
+        HT_Agg_Add(&state, 3600, 3600, (i & 1) ? -32767 : 32767, 0, &closed);
+    HT_CHECK_EQ(HT_Agg_Add(&state, 3600, 7200, 0, 0, &closed), 1);
+    HT_Agg_Format(&closed, closed.start, 3600, out);
+    HT_CHECK_STR(out, "3600,3600,65535,-3276.7,3276.7,0.0,3276.7,65535,0.0,0.0,0.0,0.0");
+
+    // A clock step backwards closes the window too
+    HT_CHECK_EQ(HT_Agg_Add(&state, 3600, 100, 0, 0, &closed), 1);
+    HT_CHECK_EQ(state.start, 0);
+}
+
+static void HT_Test_Report(void) {
+    static const uint8_t cmd[] = "dt=3,hb=00000200";
+    HT_ReportConfig config;
+    HT_ReportState state;
+
+    HT_Report_Defaults(&config);
+    HT_CHECK_EQ(HT_Report_Configure(&config, cmd, sizeof(cmd) - 1), HT_REPORT_OK);
+    HT_CHECK_EQ(config.deadband_temp, 3);
+    HT_CHECK_EQ(config.heartbeat_s, 120);
+    HT_CHECK_EQ(HT_Report_Configure(&config, (const uint8_t *)"dt=x", 4), HT_REPORT_ERROR_SYNTAX);
+
+    // Deadband and heartbeat
+    HT_Report_Reset(&state);
+    HT_CHECK_EQ(HT_Report_Due(&config, &state, 200, 500, 1000), 1);
+    HT_Report_Sent(&state, 200, 500, 1000);
+    HT_CHECK_EQ(HT_Report_Due(&config, &state, 202, 510, 1060), 0);
+    HT_CHECK_EQ(HT_Report_Due(&config, &state, 197, 500, 1060), 1);
+    HT_CHECK_EQ(HT_Report_Due(&config, &state, HT_SAMPLE_NO_VALUE, 500, 1060), 0);
+    HT_CHECK_EQ(HT_Report_Due(&config, &state, 200, 500, 1120), 1);
+
+    // Backoff doubles from the minimum up to the maximum, a success ends it
+    HT_CHECK_EQ(HT_Report_BackingOff(&state, 1000), 0);
+    HT_Report_Failed(&state, 1000);
+    HT_CHECK_EQ(HT_Report_BackingOff(&state, 1000 + HT_REPORT_BACKOFF_MIN_S - 1), 1);
+    HT_CHECK_EQ(HT_Report_BackingOff(&state, 1000 + HT_REPORT_BACKOFF_MIN_S), 0);
+    HT_Report_Failed(&state, 2000);
+    HT_CHECK_EQ(state.retry_time, 2000 + 2 * HT_REPORT_BACKOFF_MIN_S);
+    for (int i = 0; i < 300; ++i)
+        HT_Report_Failed(&state, 3000);
+    HT_CHECK_EQ(state.failures, UINT8_MAX);
+    HT_CHECK_EQ(state.retry_time, 3000 + HT_REPORT_BACKOFF_MAX_S);
+    HT_Report_Sent(&state, 200, 500, 4000);
+    HT_CHECK_EQ(HT_Report_BackingOff(&state, 4000), 0);
+
+    // Still postponed across a wrap of the seconds counter
+    HT_Report_Failed(&state, UINT32_MAX - 10);
+    HT_CHECK_EQ(HT_Report_BackingOff(&state, 5), 1);
+}
+
+void HT_Test_Codec(void) {
+    HT_Test_Lz();
+    HT_Test_Batch();
+    HT_Test_BatchRoundTrip();
+    HT_Test_Format();
+    HT_Test_Ring();
+    HT_Test_Aggregate();
+    HT_Test_Report();
+}
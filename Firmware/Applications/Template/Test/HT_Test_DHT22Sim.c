@@ -0,0 +1,151 @@
+#include "HT_Test.h"
+#include "HT_DHT22.h"
+#include "HT_DHT22_Sim.h"
+
+// Runs the DHT22 driver against the waveform simulator. The same file is built
+// once per acquisition mode (DHT22_EDGE_CAPTURE_ENABLE).
+
+unsigned ht_test_checks = 0;
+unsigned ht_test_failures = 0;
+
+static int HT_Test_Read(const HT_SimConfig *config, HT_SensorReading *reading) {
+    reading->temperature = HT_SENSOR_ERROR_ABSENT;
+    reading->humidity = HT_SENSOR_ERROR_ABSENT;
+    HT_Sim_Start(config);
+
+    return DHT22_Read(reading);
+}
+
+// Widest symmetric sensor timing error, in permille, that still decodes
+static int HT_Test_SkewMargin(void) {
+    HT_SimConfig config;
+    HT_SensorReading reading;
+    int margin = 0;
+
+    for (int skew = 10; skew <= 950; skew += 10) {
+        HT_Sim_Defaults(&config, 231, 487);
+        config.skew_permille = (int16_t)skew;
+        if (HT_Test_Read(&config, &reading) != DHT22_OK)
+            break;
+        config.skew_permille = (int16_t)-skew;
+        if (HT_Test_Read(&config, &reading) != DHT22_OK)
+            break;
+        margin = skew;
+    }
+
+    return margin;
+}
+
+// Slowest pull-up rise, in ns, that still decodes
+static int HT_Test_RiseMargin(void) {
+    HT_SimConfig config;
+    HT_SensorReading reading;
+    int margin = 0;
+
+    for (int rise = 500; rise <= 40000; rise += 500) {
+        HT_Sim_Defaults(&config, 231, 487);
+        config.rise_ns = (uint32_t)rise;
+        if (HT_Test_Read(&config, &reading) != DHT22_OK)
+            break;
+        margin = rise;
+    }
+
+    return margin;
+}
+
+int main(void) {
+    HT_SimConfig config;
+    HT_SensorReading reading;
+    int skew_margin, rise_margin;
+    int ret;
+
+    DHT22_Init();
+
+    // Nominal frames
+    HT_Sim_Defaults(&config, 278, 652);
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.temperature, 278);
+    HT_CHECK_EQ(reading.humidity, 652);
+
+    HT_Sim_Defaults(&config, -101, 999);
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.temperature, -101);
+    HT_CHECK_EQ(reading.humidity, 999);
+
+    // Sensor clock 20% off either way
+    HT_Sim_Defaults(&config, 215, 400);
+    config.skew_permille = 200;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.temperature, 215);
+    config.skew_permille = -200;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.temperature, 215);
+
+    // Slow but in-spec pull-up
+    HT_Sim_Defaults(&config, 215, 400);
+    config.rise_ns = 5000;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.humidity, 400);
+
+    // Sensor missing or unpowered
+    HT_Sim_Defaults(&config, 215, 400);
+    config.no_ack = 1;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_ERROR_TIMEOUT_START);
+    HT_CHECK_EQ(reading.temperature, HT_SENSOR_ERROR_ABSENT);
+
+    // Start pulse too short for this sensor
+    HT_Sim_Defaults(&config, 215, 400);
+    config.start_min_ns = 5000000;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_ERROR_TIMEOUT_START);
+
+    // Corrupted bit
+    HT_Sim_Defaults(&config, 215, 400);
+    config.flip[3] = 0x04;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_ERROR_CHECKSUM);
+    HT_CHECK_EQ(reading.temperature, HT_SENSOR_ERROR_ABSENT);
+
+    // Sensor stops mid-frame
+    HT_Sim_Defaults(&config, 215, 400);
+    config.bits = 20;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_ERROR_TIMEOUT_DATA);
+
+    // Pull-up too weak: "0" highs never reach the threshold
+    HT_Sim_Defaults(&config, 215, 400);
+    config.rise_ns = 40000;
+    ret = HT_Test_Read(&config, &reading);
+    HT_CHECK(ret == DHT22_ERROR_TIMEOUT_DATA || ret == DHT22_ERROR_FRAME);
+
+#if DHT22_EDGE_CAPTURE_ENABLE == 1
+    // Capture timer wrapping during the frame
+    HT_Sim_Defaults(&config, 215, 400);
+    config.timer_start = 0xFFFFFFFFu - 26 * 1500;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(reading.temperature, 215);
+
+    // Interrupt latency within the shortest pulse only shifts every edge alike
+    HT_Sim_Defaults(&config, 215, 400);
+    config.irq_latency_ns = 15000;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_OK);
+    HT_CHECK_EQ(HT_Sim_IrqCount(), DHT22_FRAME_EDGES);
+
+    // Beyond it, edges that passed before the polarity switch are collected by
+    // the handler itself: the frame is rejected instead of the read timing out
+    HT_Sim_Defaults(&config, 215, 400);
+    config.irq_latency_ns = 35000;
+    HT_CHECK_EQ(HT_Test_Read(&config, &reading), DHT22_ERROR_FRAME);
+    HT_CHECK(HT_Sim_IrqCount() < DHT22_FRAME_EDGES);
+#endif
+
+    // Timing margins, for spotting regressions between runs
+    skew_margin = HT_Test_SkewMargin();
+    rise_margin = HT_Test_RiseMargin();
+    HT_CHECK(skew_margin >= 200);
+    HT_CHECK(rise_margin >= 5000);
+    printf("%s: skew margin +-%d.%d%%, rise margin %d.%dus\n",
+           (DHT22_EDGE_CAPTURE_ENABLE == 1) ? "edge capture" : "polling",
+           skew_margin / 10, skew_margin % 10, rise_margin / 1000, rise_margin % 1000 / 100);
+
+    printf("%u checks, %u failed\n", ht_test_checks, ht_test_failures);
+
+    return ht_test_failures ? 1 : 0;
+}
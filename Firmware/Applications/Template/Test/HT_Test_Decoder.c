@@ -0,0 +1,233 @@
+#include "HT_Test.h"
+#include "HT_DHT22_Decoder.h"
+
+// Nominal widths in us: 50 low, 26 high for "0", 70 high for "1"
+#define LOW_US      50
+#define ZERO_US     26
+#define ONE_US      70
+
+#define FUZZ_FRAMES 4000    // Random frames per fault class
+
+// Builds the pulse train of a frame, widths scaled by num/den to mimic other
+// time units (timer ticks, loop counts).
+static void HT_Test_Pulses(const uint8_t *bytes, uint16_t *pulses, uint32_t num, uint32_t den) {
+    for (int i = 0; i < DHT22_FRAME_BITS; ++i) {
+        uint8_t bit = (bytes[i / 8] >> (7 - i % 8)) & 1;
+
+        pulses[2 * i] = (uint16_t)(LOW_US * num / den);
+        pulses[2 * i + 1] = (uint16_t)((bit ? ONE_US : ZERO_US) * num / den);
+    }
+}
+
+static void HT_Test_Frame(const uint8_t *bytes, int16_t temperature, int16_t humidity) {
+    uint16_t pulses[DHT22_FRAME_PULSES];
+    DHT22_Frame frame;
+
+    // Microseconds, then a slow loop count unit
+    HT_Test_Pulses(bytes, pulses, 1, 1);
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_OK);
+    HT_CHECK_EQ(frame.temperature, temperature);
+    HT_CHECK_EQ(frame.humidity, humidity);
+    HT_CHECK_MEM(frame.raw, bytes, 5);
+
+    HT_Test_Pulses(bytes, pulses, 3, 10);
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_OK);
+    HT_CHECK_EQ(frame.temperature, temperature);
+    HT_CHECK_EQ(frame.humidity, humidity);
+}
+
+// Faults injected by the randomized harness, each with the status the decoder
+// should report for it
+typedef enum {
+    FAULT_NONE = 0,     // Skewed sensor clock and edge jitter only
+    FAULT_FLIP,         // One bit read wrong
+    FAULT_SHORT,        // Train cut short: sensor stopped or edges lost
+    FAULT_GLITCH,       // Spike splitting a low pulse, shifting the train
+    FAULT_STRETCH,      // Low pulse held by a late edge
+    FAULT_STUCK,        // Line stuck at one level
+    FAULT_NOISE,        // Random widths
+    FAULT_COUNT
+} HT_Test_Fault;
+
+static const char *const fault_names[FAULT_COUNT] = {
+    "none", "bit flip", "short", "glitch", "stretch", "stuck", "noise"
+};
+
+static const int fault_expected[FAULT_COUNT] = {
+    DHT22_OK, DHT22_ERROR_CHECKSUM, DHT22_ERROR_TIMEOUT_DATA, DHT22_ERROR_FRAME,
+    DHT22_ERROR_FRAME, DHT22_ERROR_FRAME, DHT22_ERROR_FRAME
+};
+
+static uint32_t fuzz_seed = 0x2545F491;
+
+static uint32_t HT_Test_Random(uint32_t range) {
+    // xorshift32, fixed seed so every run sees the same frames
+    fuzz_seed ^= fuzz_seed << 13;
+    fuzz_seed ^= fuzz_seed >> 17;
+    fuzz_seed ^= fuzz_seed << 5;
+
+    return fuzz_seed % range;
+}
+
+// Width in the chosen unit of a nominal width in us, with the sensor clock
+// skew and up to +-8% edge jitter, all in permille
+static uint16_t HT_Test_Width(uint32_t us, uint32_t unit_permille, int32_t skew_permille) {
+    int32_t jitter = (int32_t)HT_Test_Random(161) - 80;
+
+    return (uint16_t)(us * unit_permille / 1000 * (uint32_t)(1000 + skew_permille + jitter) / 1000);
+}
+
+// Random valid frame in a random unit (us, 26MHz timer ticks or loop counts).
+// Returns the pulse count.
+static uint16_t HT_Test_RandomFrame(HT_Test_Fault fault, uint16_t *pulses, uint8_t *bytes) {
+    static const uint32_t units[] = { 1000, 26000, 300 };
+    uint32_t unit = units[HT_Test_Random(3)];
+    int32_t skew = (int32_t)HT_Test_Random(401) - 200;
+    uint16_t humidity = (uint16_t)HT_Test_Random(1001);
+    int16_t temperature = (int16_t)HT_Test_Random(1201) - 400;
+    uint16_t magnitude = (uint16_t)(temperature < 0 ? -temperature : temperature);
+    uint16_t count = DHT22_FRAME_PULSES;
+    uint32_t k;
+
+    bytes[0] = (uint8_t)(humidity >> 8);
+    bytes[1] = (uint8_t)humidity;
+    bytes[2] = (uint8_t)((magnitude >> 8) | (temperature < 0 ? 0x80 : 0));
+    bytes[3] = (uint8_t)magnitude;
+    bytes[4] = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+
+    for (int i = 0; i < DHT22_FRAME_BITS; ++i) {
+        uint8_t bit = (bytes[i / 8] >> (7 - i % 8)) & 1;
+
+        pulses[2 * i] = HT_Test_Width(LOW_US, unit, skew);
+        pulses[2 * i + 1] = HT_Test_Width(bit ? ONE_US : ZERO_US, unit, skew);
+    }
+
+    switch (fault) {
+    case FAULT_FLIP:
+        k = HT_Test_Random(DHT22_FRAME_BITS);
+        pulses[2 * k + 1] = HT_Test_Width(((bytes[k / 8] >> (7 - k % 8)) & 1) ? ZERO_US : ONE_US, unit, skew);
+        break;
+    case FAULT_SHORT:
+        count = (uint16_t)HT_Test_Random(DHT22_FRAME_PULSES);
+        break;
+    case FAULT_GLITCH:
+        // Low pulse k becomes low, spike, low; the last two pulses fall off
+        k = HT_Test_Random(DHT22_FRAME_BITS - 1);
+        memmove(&pulses[2 * k + 2], &pulses[2 * k], (DHT22_FRAME_PULSES - 2 * k - 2) * sizeof(uint16_t));
+        pulses[2 * k + 1] = HT_Test_Width(1 + HT_Test_Random(4), unit, skew);
+        pulses[2 * k] = (uint16_t)(pulses[2 * k + 2] * (1 + HT_Test_Random(98)) / 100);
+        pulses[2 * k + 2] = (uint16_t)(pulses[2 * k + 2] - pulses[2 * k]);
+        break;
+    case FAULT_STRETCH:
+        k = HT_Test_Random(DHT22_FRAME_BITS);
+        pulses[2 * k] = HT_Test_Width(LOW_US * (3 + HT_Test_Random(6)), unit, skew);
+        break;
+    case FAULT_STUCK:
+        k = HT_Test_Random(2) ? 0 : HT_Test_Width(LOW_US, unit, skew);
+        for (int i = 0; i < DHT22_FRAME_PULSES; ++i)
+            pulses[i] = (i % 2) ? 0 : (uint16_t)k;
+        break;
+    case FAULT_NOISE:
+        for (int i = 0; i < DHT22_FRAME_PULSES; ++i)
+            pulses[i] = HT_Test_Width(1 + HT_Test_Random(2 * ONE_US), unit, skew);
+        break;
+    default:
+        break;
+    }
+
+    return count;
+}
+
+// Randomized harness: reports per fault class how often the decoder returns the
+// expected status, and how often a faulty frame is accepted as valid.
+static void HT_Test_DecoderFuzz(void) {
+    uint16_t pulses[DHT22_FRAME_PULSES];
+    uint8_t bytes[5];
+    DHT22_Frame frame;
+    uint32_t exact[FAULT_COUNT], accepted[FAULT_COUNT];
+    uint32_t total_exact = 0;
+    uint16_t count;
+    int ret;
+
+    printf("decoder fuzz, %d frames per class: expected status / accepted\n", FUZZ_FRAMES);
+
+    for (int fault = 0; fault < FAULT_COUNT; ++fault) {
+        exact[fault] = accepted[fault] = 0;
+
+        for (int n = 0; n < FUZZ_FRAMES; ++n) {
+            count = HT_Test_RandomFrame((HT_Test_Fault)fault, pulses, bytes);
+            ret = DHT22_DecodeFrame(pulses, count, &frame);
+            if (ret == DHT22_OK) {
+                accepted[fault]++;
+                // A clean frame must also decode to the values it was built from
+                if (fault == FAULT_NONE && memcmp(frame.raw, bytes, 5) != 0)
+                    ret = DHT22_ERROR;
+            }
+            if (ret == fault_expected[fault])
+                exact[fault]++;
+        }
+
+        total_exact += exact[fault];
+        printf("  %-8s %6.2f%% %6.2f%%\n", fault_names[fault],
+               100.0 * exact[fault] / FUZZ_FRAMES, 100.0 * accepted[fault] / FUZZ_FRAMES);
+    }
+
+    printf("  overall  %6.2f%%\n", 100.0 * total_exact / (FAULT_COUNT * FUZZ_FRAMES));
+
+    // Classes the decoder can always tell apart
+    HT_CHECK_EQ(exact[FAULT_NONE], FUZZ_FRAMES);
+    HT_CHECK_EQ(exact[FAULT_FLIP], FUZZ_FRAMES);
+    HT_CHECK_EQ(exact[FAULT_SHORT], FUZZ_FRAMES);
+    HT_CHECK_EQ(exact[FAULT_STRETCH], FUZZ_FRAMES);
+    HT_CHECK_EQ(exact[FAULT_STUCK], FUZZ_FRAMES);
+
+    // The checksum is 8 bits only, the width checks must keep faulty frames out
+    for (int fault = FAULT_NONE + 1; fault < FAULT_COUNT; ++fault)
+        HT_CHECK_EQ(accepted[fault], 0);
+}
+
+void HT_Test_Decoder(void) {
+    // 65.2 %RH, 35.1 degC
+    static const uint8_t warm[5] = { 0x02, 0x8C, 0x01, 0x5F, 0xEE };
+    // 99.9 %RH, -10.1 degC: sign bit with a positive magnitude
+    static const uint8_t cold[5] = { 0x03, 0xE7, 0x80, 0x65, 0xCF };
+    uint16_t pulses[DHT22_FRAME_PULSES];
+    uint16_t jittered[DHT22_FRAME_PULSES];
+    DHT22_Frame frame;
+    uint8_t bad[5];
+
+    HT_Test_Frame(warm, 351, 652);
+    HT_Test_Frame(cold, -101, 999);
+
+    // Edge jitter of a few us on every pulse still decodes
+    HT_Test_Pulses(warm, pulses, 1, 1);
+    for (int i = 0; i < DHT22_FRAME_PULSES; ++i)
+        jittered[i] = (uint16_t)(pulses[i] + ((i % 3) - 1) * 6);
+    HT_CHECK_EQ(DHT22_DecodeFrame(jittered, DHT22_FRAME_PULSES, &frame), DHT22_OK);
+    HT_CHECK_EQ(frame.temperature, 351);
+
+    // Truncated frame
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES - 1, &frame), DHT22_ERROR_TIMEOUT_DATA);
+
+    // Checksum mismatch
+    memcpy(bad, warm, sizeof(bad));
+    bad[4] ^= 0x01;
+    HT_Test_Pulses(bad, pulses, 1, 1);
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_ERROR_CHECKSUM);
+
+    // Lost edge: a low pulse merged with its neighbours
+    HT_Test_Pulses(warm, pulses, 1, 1);
+    pulses[20] = 4 * LOW_US;
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_ERROR_FRAME);
+
+    // Empty high pulse
+    HT_Test_Pulses(warm, pulses, 1, 1);
+    pulses[41] = 0;
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_ERROR_FRAME);
+
+    // Line stuck low
+    memset(pulses, 0, sizeof(pulses));
+    HT_CHECK_EQ(DHT22_DecodeFrame(pulses, DHT22_FRAME_PULSES, &frame), DHT22_ERROR_FRAME);
+
+    HT_Test_DecoderFuzz();
+}
@@ -0,0 +1,407 @@
+#include "HT_Test.h"
+#include "HT_MQTT_Api.h"
+#include "HT_MQTT_Net.h"
+
+// Runs the Paho client with its in-flight window against the in-memory broker
+// link. The same file is built once per MQTT_TLS_ENABLE value, which changes
+// how the client closes a session.
+
+unsigned ht_test_checks = 0;
+unsigned ht_test_failures = 0;
+
+#define HT_TEST_TOPIC   "hana/externo/senseclima/00001/temperature"
+
+static MQTTClient client;
+static Network network;
+static uint8_t sendbuf[512];
+static uint8_t readbuf[512];
+
+// Outcome per handler context: 0 not called, 1 SUCCESS, -1 FAILURE
+static int results[MAX_BATCH_MESSAGES];
+
+static void HT_Test_Done(int rc, void *context) {
+    results[(intptr_t)context] = (rc == SUCCESS) ? 1 : -1;
+}
+
+// A connected MQTT 3.1.1 client, no keep alive
+static void HT_Test_Connected(uint8_t writev) {
+    HT_Net_Init(&network, writev);
+    MQTTClientInit(&client, &network, 1000, sendbuf, sizeof(sendbuf), readbuf, sizeof(readbuf));
+    client.isconnected = 1;
+    client.keepAliveInterval = 0;
+    memset(results, 0, sizeof(results));
+}
+
+// CONNACK: Receive Maximum 2, Topic Alias Maximum 4
+static const uint8_t connack[] = { 0x20, 9, 0, 0, 6, 33, 0, 2, 34, 0, 4 };
+
+// MQTT 5 CONNECT with Session Expiry Interval and Receive Maximum, as the
+// application sends it, answered with the CONNACK above
+static int HT_Test_Connect5(void) {
+    MQTTPacket_connectData options = MQTTPacket_connectData_initializer;
+    MQTTProperty array[2];
+    MQTTProperties properties = { 0, 2, 0, array };
+    MQTTProperty property;
+    MQTTConnackData data;
+
+    options.MQTTVersion = 5;
+    options.clientID.cstring = "id";
+
+    property.identifier = MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL;
+    property.value.integer4 = 86400;
+    MQTTProperties_add(&properties, &property);
+    property.identifier = MQTTPROPERTY_CODE_RECEIVE_MAXIMUM;
+    property.value.integer2 = MAX_INFLIGHT_MESSAGES;
+    MQTTProperties_add(&properties, &property);
+
+    client.isconnected = 0;
+    HT_Net_Flush();
+    HT_Net_Receive(connack, sizeof(connack));
+
+    return MQTTV5ConnectWithResults(&client, &options, &properties, NULL, &data);
+}
+
+// An MQTT 5 PUBACK with a reason code
+static void HT_Test_Puback5(uint16_t id, uint8_t reason) {
+    uint8_t ack[] = { 0x40, 3, (uint8_t)(id >> 8), (uint8_t)id, reason };
+
+    HT_Net_Receive(ack, sizeof(ack));
+}
+
+static void HT_Test_Message(MQTTMessage *message, enum QoS qos, const char *payload) {
+    memset(message, 0, sizeof(MQTTMessage));
+    message->qos = qos;
+    message->payload = (void *)payload;
+    message->payloadlen = strlen(payload);
+}
+
+// PUBACKs matched in any order, the window full at MAX_INFLIGHT_MESSAGES, and a
+// blocking publish skipping the PUBACKs of the window while it waits for its own
+static void HT_Test_Window(void) {
+    MQTTMessage messages[MAX_INFLIGHT_MESSAGES + 1];
+    MQTTMessage sync;
+
+    HT_Test_Connected(1);
+
+    for (intptr_t i = 0; i < MAX_INFLIGHT_MESSAGES; ++i) {
+        HT_Test_Message(&messages[i], QOS1, "21.5");
+        HT_CHECK_EQ(MQTTPublishAsync(&client, "t", &messages[i], HT_Test_Done, (void *)i), SUCCESS);
+    }
+    HT_Test_Message(&messages[4], QOS1, "21.6");
+    HT_CHECK_EQ(MQTTPublishAsync(&client, "t", &messages[4], HT_Test_Done, (void *)4), WINDOW_FULL);
+    HT_CHECK_EQ(ht_net.publishes, MAX_INFLIGHT_MESSAGES);
+    HT_CHECK_EQ(MQTTInflightLeftMS(&client), MQTT_RETRY_TIMEOUT_MS);
+
+    HT_Net_Puback(messages[2].id);
+    HT_Net_Puback(messages[0].id);
+    MQTTProcess(&client, 10);
+    MQTTProcess(&client, 10);
+    HT_CHECK_EQ(results[2], 1);
+    HT_CHECK_EQ(results[0], 1);
+    HT_CHECK_EQ(results[1], 0);
+
+    // A completed slot takes a new message
+    HT_CHECK_EQ(MQTTPublishAsync(&client, "t", &messages[4], HT_Test_Done, (void *)4), SUCCESS);
+
+    HT_Test_Message(&sync, QOS1, "y");
+    HT_Net_Puback(messages[1].id);
+    HT_Net_Puback((uint16_t)(client.next_packetid + 1));
+    HT_CHECK_EQ(MQTTPublish(&client, "t", &sync), SUCCESS);
+    HT_CHECK_EQ(results[1], 1);
+}
+
+// Unacknowledged publishes are resent with DUP, then failed once the retries
+// ran out; the connection itself stays up
+static void HT_Test_Retry(void) {
+    MQTTMessage messages[2];
+
+    HT_Test_Connected(1);
+
+    for (intptr_t i = 0; i < 2; ++i) {
+        HT_Test_Message(&messages[i], QOS1, "21.5");
+        HT_CHECK_EQ(MQTTPublishAsync(&client, "t", &messages[i], HT_Test_Done, (void *)i), SUCCESS);
+    }
+
+    // Not due yet
+    ht_net_now_ms += MQTT_RETRY_TIMEOUT_MS - 1;
+    MQTTProcess(&client, 0);
+    HT_CHECK_EQ(ht_net.dups, 0);
+
+    ht_net_now_ms += 1;
+    MQTTProcess(&client, 0);
+    HT_CHECK_EQ(ht_net.dups, 2);
+    HT_CHECK(ht_net.last[0] & 0x08);
+    HT_CHECK_EQ(ht_net.last[5] << 8 | ht_net.last[6], messages[1].id);     // After topic "t"
+
+    for (int k = 1; k < MQTT_MAX_RETRIES; ++k) {
+        ht_net_now_ms += MQTT_RETRY_TIMEOUT_MS;
+        MQTTProcess(&client, 0);
+    }
+    HT_CHECK_EQ(ht_net.dups, 2 * MQTT_MAX_RETRIES);
+    HT_CHECK_EQ(results[0], 0);
+
+    ht_net_now_ms += MQTT_RETRY_TIMEOUT_MS;
+    MQTTProcess(&client, 0);
+    HT_CHECK_EQ(ht_net.dups, 2 * MQTT_MAX_RETRIES);
+    HT_CHECK_EQ(results[0], -1);
+    HT_CHECK_EQ(results[1], -1);
+    HT_CHECK_EQ(MQTTInflightLeftMS(&client), -1);
+    HT_CHECK(client.isconnected);
+
+    // A late PUBACK of a failed message is ignored
+    HT_Net_Puback(messages[0].id);
+    MQTTProcess(&client, 10);
+    HT_CHECK_EQ(results[0], -1);
+}
+
+// A batch goes out in one write up to the free part of the window; the
+// DISCONNECT is only appended once every message fit
+static void HT_Test_Batch(void) {
+    MQTTBatchMessage batch[6];
+
+    HT_Test_Connected(1);
+
+    memset(batch, 0, sizeof(batch));
+    for (intptr_t i = 0; i < 6; ++i) {
+        batch[i].topicName = "topic";
+        HT_Test_Message(&batch[i].message, (i == 5) ? QOS0 : QOS1, "abc");
+        batch[i].fp = HT_Test_Done;
+        batch[i].context = (void *)i;
+    }
+
+    HT_CHECK_EQ(MQTTPublishBatch(&client, batch, 6, 1), MAX_INFLIGHT_MESSAGES);
+    HT_CHECK_EQ(ht_net.writes, 1);
+    HT_CHECK_EQ(ht_net.packets, MAX_INFLIGHT_MESSAGES);
+    HT_CHECK(!ht_net.disconnect);
+    HT_CHECK(client.isconnected);
+
+    HT_CHECK_EQ(MQTTPublishBatch(&client, &batch[4], 2, 1), WINDOW_FULL);
+    HT_CHECK_EQ(ht_net.writes, 1);
+
+    for (int i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+        HT_Net_Puback(batch[i].message.id);
+    for (int i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+        MQTTProcess(&client, 10);
+    HT_CHECK_EQ(results[0], 1);
+    HT_CHECK_EQ(results[3], 1);
+
+    // QoS1 then QoS0, the QoS0 one done once written
+    HT_CHECK_EQ(MQTTPublishBatch(&client, &batch[4], 2, 1), 2);
+    HT_CHECK_EQ(ht_net.writes, 2);
+    HT_CHECK_EQ(ht_net.packets, 2);
+    HT_CHECK(ht_net.disconnect);
+    HT_CHECK(!client.isconnected);
+    HT_CHECK_EQ(results[5], 1);
+    HT_CHECK_EQ(results[4], -1);     // Its PUBACK can no longer be read
+}
+
+// Payloads larger than the send buffer go out from the caller's buffer
+static void HT_Test_LargePayload(void) {
+    static char big[2000];
+    MQTTMessage message;
+
+    memset(big, 'z', sizeof(big) - 1);
+    HT_Test_Message(&message, QOS0, big);
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(MQTTPublish(&client, "t", &message), SUCCESS);
+    HT_CHECK_EQ(ht_net.writes, 1);
+    HT_CHECK_EQ(ht_net.packets, 1);
+    HT_CHECK_MEM(&ht_net.last[ht_net.last_len - 4], "zzzz", 4);
+
+    // Header and payload in two writes without writev
+    HT_Test_Connected(0);
+    HT_CHECK_EQ(MQTTPublish(&client, "t", &message), SUCCESS);
+    HT_CHECK_EQ(ht_net.writes, 2);
+}
+
+// CONNECT carries its properties, CONNACK sets the client's limits
+static void HT_Test_ConnectProperties(void) {
+    MQTTProperty array[4];
+    MQTTProperties properties = { 0, 4, 0, array };
+    uint8_t *ptr;
+
+    HT_Test_Connected(1);
+
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+    HT_CHECK(client.isconnected);
+    HT_CHECK_EQ(client.receiveMaximum, 2);
+    HT_CHECK_EQ(client.topicAliasMaximum, 4);
+
+    // Protocol level 5, then 8 bytes of properties after the keep alive
+    HT_CHECK_EQ(ht_net.last[8], 5);
+    HT_CHECK_EQ(ht_net.last[12], 8);
+    HT_CHECK_EQ(ht_net.last[13], MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL);
+    ptr = &ht_net.last[12];
+    HT_CHECK(MQTTProperties_read(&properties, &ptr, &ht_net.last[ht_net.last_len]));
+    HT_CHECK_EQ(properties.count, 2);
+}
+
+// The topic is sent once and then replaced by its alias; Receive Maximum caps
+// the window and a PUBACK reason code of 0x80 or more fails the message
+static void HT_Test_Aliases(void) {
+    MQTTMessage message;
+    uint32_t first;
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+    HT_Test_Message(&message, QOS1, "21.5");
+
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)0), SUCCESS);
+    first = ht_net.last_len;
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)1), SUCCESS);
+    HT_CHECK_EQ(ht_net.last_len, 14);
+    HT_CHECK_EQ(first, ht_net.last_len + strlen(HT_TEST_TOPIC));
+    HT_CHECK(client.topicAliases[0] && strcmp(client.topicAliases[0], HT_TEST_TOPIC) == 0);
+
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)2), WINDOW_FULL);
+
+    HT_Test_Puback5(message.id, 0x87);
+    MQTTProcess(&client, 10);
+    MQTTProcess(&client, 10);
+    HT_CHECK_EQ(results[1], -1);
+    HT_CHECK_EQ(results[0], 0);
+    HT_CHECK_EQ(client.reasonCode, 0x87);
+}
+
+// A server DISCONNECT ends the session and fails what is still in flight
+static void HT_Test_ServerDisconnect(void) {
+    static const uint8_t disconnect[] = { 0xE0, 1, 0x8B };
+    MQTTMessage message;
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+    HT_Test_Message(&message, QOS1, "21.5");
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)0), SUCCESS);
+
+    HT_Net_Receive(disconnect, sizeof(disconnect));
+#if MQTT_TLS_ENABLE == 0
+    HT_CHECK(MQTTProcess(&client, 10) < 0);
+#else
+    // The TLS build leaves closing the session to the caller
+    MQTTProcess(&client, 10);
+    MQTTCloseSession(&client);
+#endif
+    HT_CHECK(!client.isconnected);
+    HT_CHECK_EQ(client.reasonCode, 0x8B);
+    HT_CHECK_EQ(results[0], -1);
+    HT_CHECK(client.topicAliases[0] == NULL);
+}
+
+static void HT_Test_Handler(MessageData *data) {
+    (void)data;
+}
+
+// SUBSCRIBE with subscription options, SUBACK and UNSUBACK with reason codes
+static void HT_Test_Subscribe5(void) {
+    MQTTSubackData data;
+    uint16_t id;
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+
+    id = (uint16_t)(client.next_packetid + 1);
+    {
+        uint8_t suback[] = { 0x90, 4, (uint8_t)(id >> 8), (uint8_t)id, 0, QOS1 };
+        HT_Net_Receive(suback, sizeof(suback));
+    }
+    HT_CHECK_EQ(MQTTSubscribeWithResults(&client, "a/b", QOS1, HT_Test_Handler, &data), SUCCESS);
+    HT_CHECK_EQ(data.grantedQoS, QOS1);
+    HT_CHECK_EQ(ht_net.last[0], 0x82);
+    HT_CHECK_EQ(ht_net.last[4], 0);                                // No properties
+    HT_CHECK_EQ(ht_net.last[ht_net.last_len - 1], QOS1);          // Options byte
+
+    id = (uint16_t)(client.next_packetid + 1);
+    {
+        uint8_t unsuback[] = { 0xB0, 4, (uint8_t)(id >> 8), (uint8_t)id, 0, 0 };
+        HT_Net_Receive(unsuback, sizeof(unsuback));
+    }
+    HT_CHECK_EQ(MQTTUnsubscribe(&client, "a/b"), SUCCESS);
+    HT_CHECK(client.messageHandlers[0].topicFilter == NULL);
+}
+
+// A failed write drops the aliases and the window, so the next session starts
+// again from the full topic
+static void HT_Test_FailedWrite(void) {
+    MQTTMessage message;
+    uint32_t first;
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+    HT_Test_Message(&message, QOS1, "21.5");
+
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)0), SUCCESS);
+    first = ht_net.last_len;
+    HT_CHECK(client.topicAliases[0] && strcmp(client.topicAliases[0], HT_TEST_TOPIC) == 0);
+
+    ht_net.fail_writes = 1;
+    HT_CHECK_EQ(MQTTPublishAsync(&client, "other", &message, HT_Test_Done, (void *)1), FAILURE);
+    HT_CHECK(client.topicAliases[0] == NULL);
+    HT_CHECK(client.topicAliases[1] == NULL);
+    HT_CHECK_EQ(results[0], -1);
+    HT_CHECK_EQ(results[1], 0);     // Reported by the return code
+    for (int i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+        HT_CHECK(client.inflight[i].topicName == NULL);
+
+    ht_net.fail_writes = 0;
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)2), SUCCESS);
+    HT_CHECK_EQ(ht_net.last_len, first);
+}
+
+// The "seq" user property HT_SenseClima.c attaches, after the topic alias,
+// and kept on a DUP resend
+static void HT_Test_UserProperty(void) {
+    static const uint8_t seq[] = { MQTTPROPERTY_CODE_USER_PROPERTY, 0, 3, 's', 'e', 'q', 0, 2, '4', '2' };
+    MQTTProperty array[1];
+    MQTTProperties properties = { 0, 1, 0, array };
+    MQTTProperty property;
+    MQTTMessage message;
+
+    HT_Test_Connected(1);
+    HT_CHECK_EQ(HT_Test_Connect5(), SUCCESS);
+
+    property.identifier = MQTTPROPERTY_CODE_USER_PROPERTY;
+    property.value.data.data = "seq";
+    property.value.data.len = 3;
+    property.value.value.data = "42";
+    property.value.value.len = 2;
+    HT_CHECK_EQ(MQTTProperties_add(&properties, &property), 0);
+
+    HT_Test_Message(&message, QOS1, "21.5");
+    message.properties = &properties;
+
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)0), SUCCESS);
+    HT_CHECK_EQ(MQTTPublishAsync(&client, HT_TEST_TOPIC, &message, HT_Test_Done, (void *)1), SUCCESS);
+
+    // Header, empty topic, packet id, then 13 bytes of properties: alias, seq
+    HT_CHECK_EQ(ht_net.last_len, 14 + sizeof(seq));
+    HT_CHECK_EQ(ht_net.last[6], 3 + sizeof(seq));
+    HT_CHECK_EQ(ht_net.last[7], MQTTPROPERTY_CODE_TOPIC_ALIAS);
+    HT_CHECK_MEM(&ht_net.last[10], seq, sizeof(seq));
+
+    ht_net_now_ms += MQTT_RETRY_TIMEOUT_MS;
+    MQTTProcess(&client, 0);
+    HT_CHECK_EQ(ht_net.dups, 2);
+    HT_CHECK_MEM(&ht_net.last[ht_net.last_len - 4 - sizeof(seq)], seq, sizeof(seq));
+}
+
+int main(void) {
+    printf("MQTT client, TLS %d\n", MQTT_TLS_ENABLE);
+
+    HT_Test_Window();
+    HT_Test_Retry();
+    HT_Test_Batch();
+    HT_Test_LargePayload();
+
+    HT_Test_ConnectProperties();
+    HT_Test_Aliases();
+    HT_Test_ServerDisconnect();
+    HT_Test_Subscribe5();
+    HT_Test_FailedWrite();
+    HT_Test_UserProperty();
+
+    printf("%u checks, %u failed\n", ht_test_checks, ht_test_failures);
+
+    return ht_test_failures ? 1 : 0;
+}
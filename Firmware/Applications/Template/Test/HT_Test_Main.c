@@ -0,0 +1,15 @@
+#include "HT_Test.h"
+
+unsigned ht_test_checks = 0;
+unsigned ht_test_failures = 0;
+
+int main(void) {
+    HT_Test_Decoder();
+    HT_Test_SensorAcq();
+    HT_Test_Codec();
+    HT_Test_QLog();
+
+    printf("%u checks, %u failed\n", ht_test_checks, ht_test_failures);
+
+    return ht_test_failures ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#include "HT_Test.h"
+#include "HT_FakeFlash.h"
+#include "HT_QLog.h"
+
+static HT_SampleRecord HT_Test_Record(uint32_t n) {
+    HT_SampleRecord record = { n, (int16_t)(n % 500), (int16_t)(n % 1000) };
+
+    return record;
+}
+
+static uint8_t HT_Test_Append(HT_QLogState *state, uint32_t first, uint32_t count) {
+    uint8_t ok = 1;
+
+    for (uint32_t n = first; n < first + count; ++n) {
+        HT_SampleRecord record = HT_Test_Record(n);
+
+        ok &= HT_QLog_Append(state, &record) == HT_QLOG_OK;
+    }
+
+    return ok;
+}
+
+// Every pending record, oldest first, must be first, first + 1, ...
+static uint8_t HT_Test_Pending(const HT_QLogState *state, uint32_t first) {
+    HT_SampleRecord records[64];
+    uint16_t total = HT_QLog_Count(state);
+    uint16_t done = 0;
+    int n;
+
+    while (done < total) {
+        n = HT_QLog_Read(state, done, records, 64);
+        if (n <= 0)
+            return 0;
+        for (int i = 0; i < n; ++i) {
+            HT_SampleRecord expected = HT_Test_Record(first + done + i);
+
+            if (memcmp(&records[i], &expected, sizeof(expected)) != 0)
+                return 0;
+        }
+        done += n;
+    }
+
+    return 1;
+}
+
+// Power-on reset: the retention copy of the position is lost
+static void HT_Test_Reboot(HT_QLogState *state) {
+    memset(state, 0, sizeof(*state));
+    HT_QLog_Init(state);
+}
+
+void HT_Test_QLog(void) {
+    HT_QLogState state, stale;
+    HT_SampleRecord record, torn[2];
+
+    HT_FakeFlash_Reset();
+    HT_Test_Reboot(&state);
+    HT_CHECK_EQ(HT_QLog_Count(&state), 0);
+
+    // Spans two sectors, survives a reboot
+    HT_CHECK(HT_Test_Append(&state, 0, 300));
+    HT_CHECK_EQ(HT_QLog_Count(&state), 300);
+    HT_CHECK_EQ(ht_fake_flash_erases, 2);
+    HT_CHECK(HT_Test_Pending(&state, 0));
+    HT_Test_Reboot(&state);
+    HT_CHECK_EQ(HT_QLog_Count(&state), 300);
+    HT_CHECK(HT_Test_Pending(&state, 0));
+
+    // Released records stay released across a reboot
+    HT_CHECK_EQ(HT_QLog_Clear(&state), HT_QLOG_OK);
+    HT_CHECK_EQ(HT_QLog_Count(&state), 0);
+    HT_Test_Reboot(&state);
+    HT_CHECK_EQ(HT_QLog_Count(&state), 0);
+    HT_CHECK(HT_Test_Append(&state, 1000, 10));
+    HT_CHECK(HT_Test_Pending(&state, 1000));
+
+    // A position older than the flash content rescans instead of overwriting
+    stale = state;
+    HT_CHECK(HT_Test_Append(&state, 1010, 5));
+    HT_CHECK(HT_Test_Append(&stale, 1015, 5));
+    HT_CHECK_EQ(HT_QLog_Count(&stale), 20);
+    HT_CHECK(HT_Test_Pending(&stale, 1000));
+    state = stale;
+
+    // Reset between the body and the commit word: the slot reads back empty
+    ht_fake_flash_write_budget = 1;
+    record = HT_Test_Record(1020);
+    HT_CHECK_EQ(HT_QLog_Append(&state, &record), HT_QLOG_ERROR_FLASH);
+    ht_fake_flash_write_budget = -1;
+    HT_Test_Reboot(&state);
+    HT_CHECK_EQ(HT_QLog_Count(&state), 21);
+    HT_CHECK_EQ(HT_QLog_Read(&state, 19, torn, 2), 2);
+    HT_CHECK_EQ(torn[1].time, 1019);
+    HT_CHECK_EQ(torn[1].temperature, HT_SAMPLE_NO_VALUE);
+    HT_CHECK_EQ(torn[1].humidity, HT_SAMPLE_NO_VALUE);
+
+    // Wrap-around keeps at least the capacity and drops the oldest sector
+    HT_FakeFlash_Reset();
+    HT_Test_Reboot(&state);
+    HT_CHECK(HT_Test_Append(&state, 0, HT_QLOG_CAPACITY + 2 * HT_QLOG_SECTOR_RECORDS));
+    HT_CHECK(HT_QLog_Count(&state) >= HT_QLOG_CAPACITY);
+    HT_CHECK_EQ(state.dropped, HT_QLOG_CAPACITY + 2 * HT_QLOG_SECTOR_RECORDS - HT_QLog_Count(&state));
+    HT_CHECK(HT_Test_Pending(&state, state.dropped));
+    HT_Test_Reboot(&state);
+    HT_CHECK(HT_Test_Pending(&state, HT_QLOG_CAPACITY + 2 * HT_QLOG_SECTOR_RECORDS - HT_QLog_Count(&state)));
+
+    // Every sector took its turn, none more than once ahead of the others
+    for (int i = 0; i < HT_QLOG_SECTORS; ++i) {
+        HT_CHECK(ht_fake_flash_sector_erases[i] >= 1);
+        HT_CHECK(ht_fake_flash_sector_erases[i] <= 2);
+    }
+}
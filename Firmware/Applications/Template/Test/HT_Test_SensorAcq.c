@@ -0,0 +1,73 @@
+#include "HT_Test.h"
+#include "HT_SensorAcq.h"
+
+#define FAIL        INT16_MIN   // Marks a failed read in a sequence
+
+typedef struct {
+    const char *name;
+    int16_t reads[HT_ACQ_MAX_ATTEMPTS][2];  // Temperature, humidity
+    uint8_t steps;                  // Reads until the status leaves HT_ACQ_PENDING
+    HT_AcqStatus status;
+    int16_t temperature;            // Expected result, when status is not HT_ACQ_FAILED
+    int16_t humidity;
+} HT_Test_AcqCase;
+
+static const HT_Test_AcqCase acq_cases[] = {
+    { "agree at once",      { { 215, 600 }, { 216, 602 }, { 214, 605 } },
+      3, HT_ACQ_CONVERGED, 215, 602 },
+    { "negative values",    { { -5, 900 }, { -3, 905 }, { -4, 902 } },
+      3, HT_ACQ_CONVERGED, -4, 902 },
+    { "outlier dropped",    { { 300, 600 }, { 215, 600 }, { 216, 601 }, { 215, 603 } },
+      4, HT_ACQ_CONVERGED, 215, 601 },
+    { "failures skipped",   { { FAIL, 0 }, { 200, 500 }, { FAIL, 0 }, { 201, 501 }, { 202, 502 } },
+      5, HT_ACQ_CONVERGED, 201, 501 },
+    { "temp at tolerance",  { { 200, 500 }, { 203, 500 }, { 201, 500 } },
+      3, HT_ACQ_CONVERGED, 201, 500 },
+    { "temp past tolerance", { { 200, 500 }, { 204, 500 }, { 202, 500 }, { 203, 500 } },
+      4, HT_ACQ_CONVERGED, 203, 500 },
+    { "humidity settling",  { { 200, 500 }, { 200, 520 }, { 200, 540 }, { 200, 535 }, { 200, 538 } },
+      5, HT_ACQ_CONVERGED, 200, 538 },
+    // Median of an even count is the mean of the middle pair
+    { "never agrees",       { { 200, 500 }, { 210, 500 }, { 200, 500 }, { 210, 500 }, { 200, 500 }, { 210, 500 } },
+      6, HT_ACQ_SATURATED, 205, 500 },
+    { "attempts run out",   { { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 },
+                              { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { 200, 500 }, { 204, 504 } },
+      10, HT_ACQ_SATURATED, 202, 502 },
+    { "sensor absent",      { { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 },
+                              { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 }, { FAIL, 0 } },
+      10, HT_ACQ_FAILED, 0, 0 },
+};
+
+void HT_Test_SensorAcq(void) {
+    HT_Acq acq;
+    HT_AcqStatus status;
+    int16_t temperature, humidity;
+    uint8_t steps;
+
+    for (unsigned c = 0; c < sizeof(acq_cases) / sizeof(acq_cases[0]); ++c) {
+        const HT_Test_AcqCase *tc = &acq_cases[c];
+
+        HT_Acq_Reset(&acq);
+        status = HT_ACQ_PENDING;
+        for (steps = 0; steps < HT_ACQ_MAX_ATTEMPTS && status == HT_ACQ_PENDING; ++steps) {
+            status = HT_Acq_AddSample(&acq, tc->reads[steps][0] != FAIL,
+                                      tc->reads[steps][0], tc->reads[steps][1]);
+        }
+
+        if (steps != tc->steps || status != tc->status)
+            printf("acquisition case \"%s\":\n", tc->name);
+        HT_CHECK_EQ(steps, tc->steps);
+        HT_CHECK_EQ(status, tc->status);
+
+        if (tc->status == HT_ACQ_FAILED) {
+            HT_CHECK_EQ(HT_Acq_GetResult(&acq, &temperature, &humidity), 0);
+            continue;
+        }
+
+        HT_CHECK_EQ(HT_Acq_GetResult(&acq, &temperature, &humidity), 1);
+        if (temperature != tc->temperature || humidity != tc->humidity)
+            printf("acquisition case \"%s\":\n", tc->name);
+        HT_CHECK_EQ(temperature, tc->temperature);
+        HT_CHECK_EQ(humidity, tc->humidity);
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef __HT_MQTT_API_H__
+#define __HT_MQTT_API_H__
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+#include "MQTTClient.h"
+
+// Host stand-in for the application MQTT helpers (Inc/HT_MQTT_Api.h), of which
+// the client only needs the TLS switch and the trace macro. The Makefile
+// builds the client once per MQTT_TLS_ENABLE value.
+
+#ifndef MQTT_TLS_ENABLE
+#define MQTT_TLS_ENABLE 0
+#endif
+
+#define HT_TRACE(...)
+
+#endif // __HT_MQTT_API_H__
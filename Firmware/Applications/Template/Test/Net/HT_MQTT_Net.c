@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include "HT_MQTT_Net.h"
+#include "HT_MQTT_Api.h"
+
+uint32_t ht_net_now_ms;
+HT_NetStats ht_net;
+
+static uint8_t rx[HT_NET_BUFFER_SIZE];
+static uint32_t rx_len, rx_pos;
+
+// Paho FreeRTOS port
+
+void TimerInit(Timer *timer) {
+    timer->xTicksToWait = 0;
+    timer->xTimeOut.xTimeOnEntering = 0;
+}
+
+void TimerCountdownMS(Timer *timer, unsigned int ms) {
+    timer->xTicksToWait = ms;
+    timer->xTimeOut.xTimeOnEntering = (int32_t)ht_net_now_ms;
+}
+
+void TimerCountdown(Timer *timer, unsigned int s) {
+    TimerCountdownMS(timer, s * 1000);
+}
+
+int TimerLeftMS(Timer *timer) {
+    int32_t left = (int32_t)(timer->xTimeOut.xTimeOnEntering + timer->xTicksToWait - ht_net_now_ms);
+
+    return left < 0 ? 0 : left;
+}
+
+char TimerIsExpired(Timer *timer) {
+    return TimerLeftMS(timer) == 0;
+}
+
+void MutexInit(Mutex *mutex) {
+    mutex->sem = mutex;
+}
+
+int MutexLock(Mutex *mutex) {
+    (void)mutex;
+    return 0;
+}
+
+int MutexUnlock(Mutex *mutex) {
+    (void)mutex;
+    return 0;
+}
+
+void NetworkInit(Network *network) {
+    (void)network;
+}
+
+int NetworkConnect(Network *network, char *addr, int port) {
+    (void)network;
+    (void)addr;
+    (void)port;
+    return 0;
+}
+
+int NetworkSetConnTimeout(Network *network, int send_timeout, int recv_timeout) {
+    (void)network;
+    (void)send_timeout;
+    (void)recv_timeout;
+    return 0;
+}
+
+int ThreadStart(Thread *thread, void (*fn)(void *), void *arg) {
+    (void)thread;
+    (void)fn;
+    (void)arg;
+    return 0;
+}
+
+QueueHandle_t xQueueCreate(uint32_t length, uint32_t item_size) {
+    (void)length;
+    (void)item_size;
+    return NULL;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+    (void)queue;
+    (void)item;
+    (void)wait;
+    return pdPASS;
+}
+
+int sock_get_errno(int socket) {
+    (void)socket;
+    return 0;
+}
+
+// CMSIS-RTOS2, only reached by the client task the tests never start
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr) {
+    (void)func;
+    (void)argument;
+    (void)attr;
+    return NULL;
+}
+
+osStatus_t osDelay(uint32_t ticks) {
+    ht_net_now_ms += ticks;
+    return osOK;
+}
+
+// Broker link
+
+static int HT_Net_Read(Network *network, unsigned char *buf, int len, int timeout_ms) {
+    (void)network;
+
+    // Nothing queued: the read waits out its timeout
+    if (rx_pos + (uint32_t)len > rx_len) {
+        ht_net_now_ms += (uint32_t)timeout_ms;
+        return 0;
+    }
+
+    memcpy(buf, &rx[rx_pos], (size_t)len);
+    rx_pos += (uint32_t)len;
+
+    return len;
+}
+
+static int HT_Net_Write(Network *network, unsigned char *buf, int len, int timeout_ms) {
+    uint32_t pos = 0;
+
+    (void)network;
+    (void)timeout_ms;
+
+    if (ht_net.fail_writes || len > HT_NET_BUFFER_SIZE)
+        return -1;
+
+    memcpy(ht_net.last, buf, (size_t)len);
+    ht_net.last_len = (uint32_t)len;
+    ht_net.writes++;
+    ht_net.packets = 0;
+    ht_net.disconnect = 0;
+
+    while (pos < (uint32_t)len) {
+        uint8_t type = buf[pos] >> 4;
+        uint32_t rem = 0, mult = 1, k = 1;
+
+        do {
+            rem += (buf[pos + k] & 127) * mult;
+            mult *= 128;
+        } while (buf[pos + k++] & 128);
+
+        if (type == DISCONNECT) {
+            ht_net.disconnect = 1;
+        } else {
+            ht_net.packets++;
+            if (type == PUBLISH) {
+                ht_net.publishes++;
+                if (buf[pos] & 0x08)
+                    ht_net.dups++;
+            }
+        }
+        pos += k + rem;
+    }
+
+    return len;
+}
+
+static int HT_Net_Writev(Network *network, struct iovec *iov, int count, int timeout_ms) {
+    static uint8_t buf[HT_NET_BUFFER_SIZE];
+    uint32_t len = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (len + iov[i].iov_len > sizeof(buf))
+            return -1;
+        memcpy(&buf[len], iov[i].iov_base, iov[i].iov_len);
+        len += iov[i].iov_len;
+    }
+
+    return HT_Net_Write(network, buf, (int)len, timeout_ms);
+}
+
+void HT_Net_Init(Network *network, uint8_t writev) {
+    memset(network, 0, sizeof(Network));
+    network->mqttread = HT_Net_Read;
+    network->mqttwrite = HT_Net_Write;
+    network->mqttwritev = writev ? HT_Net_Writev : NULL;
+
+    memset(&ht_net, 0, sizeof(ht_net));
+    HT_Net_Flush();
+}
+
+void HT_Net_Receive(const uint8_t *data, uint16_t len) {
+    if (rx_len + len > sizeof(rx)) {
+        printf("HT_Net_Receive: queue full\n");
+        return;
+    }
+
+    memcpy(&rx[rx_len], data, len);
+    rx_len += len;
+}
+
+void HT_Net_Puback(uint16_t id) {
+    uint8_t ack[4];
+
+    HT_Net_Receive(ack, (uint16_t)MQTTSerialize_ack(ack, sizeof(ack), PUBACK, 0, id));
+}
+
+void HT_Net_Flush(void) {
+    rx_len = rx_pos = 0;
+}
@@ -0,0 +1,44 @@
+#ifndef __HT_MQTT_NET_H__
+#define __HT_MQTT_NET_H__
+
+#include <stdint.h>
+#include "MQTTClient.h"
+
+// In-memory broker link for running the unmodified Paho client
+// (SDK/Thirdparty/MQTT/MQTTClient) off-target.
+//
+// Time is virtual: it moves when the client waits on a read with nothing
+// queued (by the read timeout) or when a test advances ht_net_now_ms. Bytes the
+// broker sends are queued with HT_Net_Receive and read in order. Every network
+// write is parsed into packets and counted; the last one is kept for byte-level
+// checks. Writes fail while fail_writes is set.
+
+#define HT_NET_BUFFER_SIZE      4096
+
+typedef struct {
+    uint32_t writes;            // Network writes, a vectored write counts once
+    uint32_t packets;           // Packets in the last write, DISCONNECT excluded
+    uint32_t publishes;         // PUBLISH packets written
+    uint32_t dups;              // PUBLISH packets written with DUP set
+    uint8_t disconnect;         // The last write ended with a DISCONNECT
+    uint8_t fail_writes;        // Writes fail while set
+    uint8_t last[HT_NET_BUFFER_SIZE];
+    uint32_t last_len;
+} HT_NetStats;
+
+extern uint32_t ht_net_now_ms;
+extern HT_NetStats ht_net;
+
+// Resets the link and hooks it to network, with or without vectored writes.
+void HT_Net_Init(Network *network, uint8_t writev);
+
+// Queues bytes sent by the broker.
+void HT_Net_Receive(const uint8_t *data, uint16_t len);
+
+// Queues an MQTT 3.1.1 PUBACK.
+void HT_Net_Puback(uint16_t id);
+
+// Drops whatever the client has not read yet.
+void HT_Net_Flush(void);
+
+#endif // __HT_MQTT_NET_H__
@@ -0,0 +1,68 @@
+#ifndef __HT_NET_MQTTFREERTOS_H__
+#define __HT_NET_MQTTFREERTOS_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+
+// Host stand-in for the Paho FreeRTOS port (SDK/Thirdparty/MQTT/FreeRTOS):
+// the same Timer, Network and Mutex types, implemented by HT_MQTT_Net.c on a
+// virtual millisecond clock with a single thread.
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void *SemaphoreHandle_t;
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+
+typedef struct {
+    int32_t xTimeOnEntering;
+} TimeOut_t;
+
+#define pdPASS              1
+#define pdMS_TO_TICKS(x)    ((TickType_t)(x))
+
+typedef struct Timer {
+    TickType_t xTicksToWait;
+    TimeOut_t xTimeOut;
+} Timer;
+
+typedef struct Network Network;
+
+struct Network {
+    int my_socket;
+    int (*mqttread)(Network *, unsigned char *, int, int);
+    int (*mqttwrite)(Network *, unsigned char *, int, int);
+    int (*mqttwritev)(Network *, struct iovec *, int, int);
+    int (*disconnect)(Network *);
+};
+
+void TimerInit(Timer *);
+char TimerIsExpired(Timer *);
+void TimerCountdownMS(Timer *, unsigned int);
+void TimerCountdown(Timer *, unsigned int);
+int TimerLeftMS(Timer *);
+
+typedef struct Mutex {
+    SemaphoreHandle_t sem;
+} Mutex;
+
+void MutexInit(Mutex *);
+int MutexLock(Mutex *);
+int MutexUnlock(Mutex *);
+
+typedef struct Thread {
+    TaskHandle_t task;
+} Thread;
+
+int ThreadStart(Thread *, void (*fn)(void *), void *arg);
+
+void NetworkInit(Network *);
+int NetworkConnect(Network *, char *, int);
+int NetworkSetConnTimeout(Network *n, int send_timeout, int recv_timeout);
+
+QueueHandle_t xQueueCreate(uint32_t length, uint32_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+int sock_get_errno(int socket);
+
+#endif // __HT_NET_MQTTFREERTOS_H__
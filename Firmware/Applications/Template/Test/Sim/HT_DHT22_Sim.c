@@ -0,0 +1,437 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "HT_DHT22_Sim.h"
+#include "HT_GPIO_Api.h"
+#include "bsp.h"
+#include "task.h"
+#include "cmsis_os2.h"
+#include "timer_qcx212.h"
+#include "clock_qcx212.h"
+
+#define NS_PER_US           1000LL
+#define NS_PER_TICK         1000000LL   // configTICK_RATE_HZ is 1000
+#define SIM_NEVER           INT64_MAX
+#define SIM_IRQ_STORM       1000        // Handler calls without progress before giving up
+
+// Sensor pulse widths in us
+#define SIM_ACK_LOW_US      80
+#define SIM_ACK_HIGH_US     80
+#define SIM_BIT_LOW_US      50
+#define SIM_BIT_ZERO_US     26
+#define SIM_BIT_ONE_US      70
+
+static HT_SimConfig sim;
+static int64_t now;                     // ns
+
+// Host side of the line
+static uint8_t mcu_output;              // Pin configured as output
+static uint8_t mcu_level;               // Output value
+static int64_t mcu_low_since;           // Start of the current host low pulse
+static int64_t mcu_release;             // End of the last host low pulse
+
+// Sensor side: intervals where the sensor pulls the line low, [start, end)
+static int64_t sensor_low[2 * (1 + 40 + 1)];
+static uint16_t sensor_lows;
+
+// Interrupt controller
+static uint8_t line_level;
+static gpio_interrupt_config_t irq_config;
+static uint8_t irq_flag;
+static uint8_t in_isr;
+static uint16_t irq_mask;
+static HT_GPIO_IRQHandler irq_handler;
+static uint32_t irq_calls;
+
+static uint32_t sem_count;
+
+static int64_t HT_Sim_Skew(int64_t ns) {
+    return ns * (1000 + sim.skew_permille) / 1000;
+}
+
+static uint8_t HT_Sim_SensorLow(int64_t t) {
+    for (uint16_t i = 0; i < sensor_lows; i += 2) {
+        if (t >= sensor_low[i] && t < sensor_low[i + 1])
+            return 1;
+    }
+
+    return 0;
+}
+
+// Last time nobody pulled the line low anymore, up to t
+static int64_t HT_Sim_LastRelease(int64_t t) {
+    int64_t release = mcu_release;
+
+    for (uint16_t i = 1; i < sensor_lows; i += 2) {
+        if (sensor_low[i] <= t && sensor_low[i] > release)
+            release = sensor_low[i];
+    }
+
+    return release;
+}
+
+static uint8_t HT_Sim_Line(int64_t t) {
+    if ((mcu_output && !mcu_level) || HT_Sim_SensorLow(t))
+        return 0;
+
+    // Driven high by the host, or pulled up
+    return mcu_output || t >= HT_Sim_LastRelease(t) + sim.rise_ns;
+}
+
+// Earliest time after t at which the line may change on its own
+static int64_t HT_Sim_NextChange(int64_t t) {
+    int64_t next = SIM_NEVER;
+    int64_t candidate;
+
+    if (mcu_release + sim.rise_ns > t)
+        next = mcu_release + sim.rise_ns;
+
+    for (uint16_t i = 0; i < sensor_lows; ++i) {
+        candidate = sensor_low[i];
+        if (candidate > t && candidate < next)
+            next = candidate;
+        candidate += sim.rise_ns;
+        if ((i & 1) && candidate > t && candidate < next)
+            next = candidate;
+    }
+
+    return next;
+}
+
+// Latches the interrupt flag when the line moved in the armed direction
+static void HT_Sim_Sample(void) {
+    uint8_t level = HT_Sim_Line(now);
+
+    if (level == line_level)
+        return;
+
+    line_level = level;
+    if ((irq_config == GPIO_InterruptRisingEdge && level) || (irq_config == GPIO_InterruptFallingEdge && !level))
+        irq_flag = 1;
+}
+
+static void HT_Sim_Run(int64_t until, uint8_t stop_on_sem);
+
+static void HT_Sim_ServiceIrq(void) {
+    uint32_t storm = 0;
+
+    while (irq_flag && irq_handler && !in_isr) {
+        if (++storm > SIM_IRQ_STORM) {
+            printf("HT_DHT22_Sim: interrupt flag never cleared at %lld ns\n", (long long)now);
+            exit(2);
+        }
+
+        in_isr = 1;
+        HT_Sim_Run(now + sim.irq_latency_ns, 0);
+        irq_calls++;
+        irq_handler();
+        in_isr = 0;
+    }
+}
+
+static void HT_Sim_Run(int64_t until, uint8_t stop_on_sem) {
+    int64_t next;
+
+    for (;;) {
+        next = HT_Sim_NextChange(now);
+        if (next > until)
+            break;
+
+        now = next;
+        HT_Sim_Sample();
+        HT_Sim_ServiceIrq();
+
+        if (stop_on_sem && sem_count)
+            return;
+    }
+
+    // Servicing an interrupt may already have taken us past until
+    if (now < until)
+        now = until;
+}
+
+// Cost of one driver call
+static void HT_Sim_Step(void) {
+    HT_Sim_Run(now + (in_isr ? sim.isr_step_ns : sim.poll_step_ns), 0);
+}
+
+// Scripted response to a start pulse released at t
+static void HT_Sim_Respond(int64_t t) {
+    uint16_t magnitude = (uint16_t)((sim.temperature < 0) ? -sim.temperature : sim.temperature);
+    uint8_t data[5];
+
+    sensor_lows = 0;
+    if (sim.no_ack)
+        return;
+
+    data[0] = (uint8_t)(sim.humidity >> 8);
+    data[1] = (uint8_t)sim.humidity;
+    data[2] = (uint8_t)((magnitude >> 8) | ((sim.temperature < 0) ? 0x80 : 0));
+    data[3] = (uint8_t)magnitude;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    for (int i = 0; i < 5; ++i)
+        data[i] ^= sim.flip[i];
+
+    t += HT_Sim_Skew(sim.response_ns);
+    sensor_low[sensor_lows++] = t;
+    t += HT_Sim_Skew(SIM_ACK_LOW_US * NS_PER_US);
+    sensor_low[sensor_lows++] = t;
+    t += HT_Sim_Skew(SIM_ACK_HIGH_US * NS_PER_US);
+
+    for (int i = 0; i < sim.bits && i < 40; ++i) {
+        uint8_t bit = (data[i / 8] >> (7 - i % 8)) & 1;
+
+        sensor_low[sensor_lows++] = t;
+        t += HT_Sim_Skew(SIM_BIT_LOW_US * NS_PER_US);
+        sensor_low[sensor_lows++] = t;
+        t += HT_Sim_Skew((bit ? SIM_BIT_ONE_US : SIM_BIT_ZERO_US) * NS_PER_US);
+    }
+
+    // End of frame low, a sensor that stopped early just leaves the line high
+    if (sim.bits >= 40) {
+        sensor_low[sensor_lows++] = t;
+        t += HT_Sim_Skew(SIM_BIT_LOW_US * NS_PER_US);
+        sensor_low[sensor_lows++] = t;
+    }
+}
+
+static void HT_Sim_Drive(uint8_t output, uint8_t level) {
+    uint8_t was_low = mcu_output && !mcu_level;
+    uint8_t low = output && !level;
+
+    mcu_output = output;
+    mcu_level = level;
+
+    if (!was_low && low) {
+        mcu_low_since = now;
+    } else if (was_low && !low) {
+        // A push-pull high charges the line at once, only the pull-up is slow
+        mcu_release = output ? now - sim.rise_ns : now;
+        if (now - mcu_low_since >= sim.start_min_ns)
+            HT_Sim_Respond(now);
+    }
+
+    HT_Sim_Sample();
+}
+
+void HT_Sim_Defaults(HT_SimConfig *config, int16_t temperature, int16_t humidity) {
+    config->temperature = temperature;
+    config->humidity = humidity;
+    config->skew_permille = 0;
+    config->no_ack = 0;
+    config->bits = 40;
+    for (int i = 0; i < 5; ++i)
+        config->flip[i] = 0;
+    config->response_ns = 30 * NS_PER_US;
+    config->rise_ns = 0;
+    config->start_min_ns = 800 * NS_PER_US;
+    config->irq_latency_ns = 500;
+    config->isr_step_ns = 100;
+    config->poll_step_ns = 200;
+    config->timer_start = 0;
+}
+
+void HT_Sim_Start(const HT_SimConfig *config) {
+    sim = *config;
+    now = 0;
+    mcu_output = 0;
+    mcu_level = 1;
+    mcu_low_since = 0;
+    mcu_release = -1000000000LL;
+    sensor_lows = 0;
+    line_level = 1;
+    irq_config = GPIO_InterruptDisabled;
+    irq_flag = 0;
+    in_isr = 0;
+    irq_calls = 0;
+    sem_count = 0;
+}
+
+uint64_t HT_Sim_Now(void) {
+    return (uint64_t)now;
+}
+
+uint32_t HT_Sim_IrqCount(void) {
+    return irq_calls;
+}
+
+// === Pad and GPIO driver ===
+
+void PAD_GetDefaultConfig(pad_config_t *config) {
+    config->mux = PAD_MuxAlt0;
+}
+
+void PAD_SetPinConfig(uint32_t pin, const pad_config_t *config) {
+    (void)pin;
+    (void)config;
+}
+
+void PAD_SetPinPullConfig(uint32_t pin, pad_pull_config_t config) {
+    (void)pin;
+    (void)config;
+}
+
+void GPIO_PinConfig(uint32_t port, uint16_t pin, const gpio_pin_config_t *config) {
+    (void)port;
+    (void)pin;
+
+    HT_Sim_Step();
+    if (config->pinDirection == GPIO_DirectionOutput) {
+        HT_Sim_Drive(1, config->misc.initOutput ? 1 : 0);
+    } else {
+        irq_config = config->misc.interruptConfig;
+        HT_Sim_Drive(0, mcu_level);
+    }
+    HT_Sim_ServiceIrq();
+}
+
+void GPIO_InterruptConfig(uint32_t port, uint16_t pin, gpio_interrupt_config_t config) {
+    (void)port;
+    (void)pin;
+
+    HT_Sim_Step();
+    irq_config = config;
+}
+
+void GPIO_PinWrite(uint32_t port, uint16_t pinMask, uint16_t output) {
+    (void)port;
+
+    HT_Sim_Step();
+    if (mcu_output)
+        HT_Sim_Drive(1, (output & pinMask) ? 1 : 0);
+    else
+        mcu_level = (output & pinMask) ? 1 : 0;
+    HT_Sim_ServiceIrq();
+}
+
+uint32_t GPIO_PinRead(uint32_t port, uint16_t pin) {
+    (void)port;
+    (void)pin;
+
+    HT_Sim_Step();
+
+    return line_level;
+}
+
+uint16_t GPIO_GetInterruptFlags(uint32_t port) {
+    (void)port;
+
+    return irq_flag ? irq_mask : 0;
+}
+
+void GPIO_ClearInterruptFlags(uint32_t port, uint16_t mask) {
+    (void)port;
+
+    HT_Sim_Step();
+    if (mask & irq_mask)
+        irq_flag = 0;
+}
+
+void delay_us(uint32_t us) {
+    HT_Sim_Run(now + us * NS_PER_US + sim.poll_step_ns, 0);
+}
+
+int HT_GPIO_RegisterIRQHandler(uint32_t instance, uint16_t mask, HT_GPIO_IRQHandler handler) {
+    (void)instance;
+
+    if (irq_handler != NULL && irq_handler != handler)
+        return -1;
+
+    irq_mask = mask;
+    irq_handler = handler;
+
+    return 0;
+}
+
+void HT_GPIO_WritePin(uint16_t pin, uint32_t instance, uint16_t value) {
+    GPIO_PinWrite(instance, 1 << pin, value << pin);
+}
+
+// === Capture timer and clocks ===
+
+void TIMER_DriverInit(void) {
+}
+
+void TIMER_GetDefaultConfig(timer_config_t *config) {
+    config->reloadOption = TIMER_ReloadOnMatch0;
+    config->initValue = 0;
+}
+
+void TIMER_Init(uint32_t instance, const timer_config_t *config) {
+    (void)instance;
+    (void)config;
+}
+
+void TIMER_Start(uint32_t instance) {
+    (void)instance;
+}
+
+uint32_t TIMER_GetCount(uint32_t instance) {
+    (void)instance;
+
+    HT_Sim_Step();
+
+    return sim.timer_start + (uint32_t)(now * HT_SIM_TIMER_TICKS_US / NS_PER_US);
+}
+
+int32_t GPR_ClockEnable(clock_ID_t id) {
+    (void)id;
+    return 0;
+}
+
+int32_t GPR_ClockDisable(clock_ID_t id) {
+    (void)id;
+    return 0;
+}
+
+int32_t GPR_SetClockSrc(clock_ID_t id, clock_select_t select) {
+    (void)id;
+    (void)select;
+    return 0;
+}
+
+// === RTOS ===
+
+void vTaskSuspendAll(void) {
+}
+
+long xTaskResumeAll(void) {
+    return 0;
+}
+
+osStatus_t osDelay(uint32_t ticks) {
+    HT_Sim_Run(now + (int64_t)ticks * NS_PER_TICK, 0);
+
+    return osOK;
+}
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr) {
+    (void)max_count;
+    (void)attr;
+
+    sem_count = initial_count;
+
+    return (osSemaphoreId_t)&sem_count;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout) {
+    (void)semaphore_id;
+
+    if (!sem_count && timeout)
+        HT_Sim_Run(now + (int64_t)timeout * NS_PER_TICK, 1);
+
+    if (!sem_count)
+        return timeout ? osErrorTimeout : osErrorResource;
+
+    sem_count--;
+
+    return osOK;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id) {
+    (void)semaphore_id;
+
+    HT_Sim_Step();
+    sem_count = 1;
+
+    return osOK;
+}
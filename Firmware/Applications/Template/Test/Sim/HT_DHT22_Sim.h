@@ -0,0 +1,52 @@
+#ifndef __HT_DHT22_SIM_H__
+#define __HT_DHT22_SIM_H__
+
+#include <stdint.h>
+
+// Host simulation of a DHT22 on the data line, for running the unmodified
+// driver (Src/HT_DHT22.c) off-target.
+//
+// Time is virtual and only moves when the driver waits: delay_us, osDelay,
+// semaphore timeouts and a configurable cost for every GPIO access. The line is
+// an open-drain bus with a pull-up: it is low while the MCU or the sensor pulls
+// it down and rises rise_ns after the last release. A host low pulse of at
+// least start_min_ns followed by a release triggers the scripted response:
+//   ACK low 80us, ACK high 80us, then per bit 50us low and 26us ("0") or 70us
+//   ("1") high, and a final 50us low.
+// Edges latch the GPIO interrupt flag of the armed polarity, and the handler
+// registered with HT_GPIO_RegisterIRQHandler runs irq_latency_ns later with
+// every GPIO and timer access inside it taking isr_step_ns, so the capture
+// reader sees the same races it has on the target.
+
+#define HT_SIM_TIMER_TICKS_US   26  // Capture timer rate, 26MHz
+
+typedef struct {
+    int16_t temperature;        // Transmitted values, 0.1 units
+    int16_t humidity;
+    int16_t skew_permille;      // Sensor timing error, +100 makes every pulse 10% longer
+    uint8_t no_ack;             // Sensor never answers
+    uint8_t bits;               // Bits sent before the sensor stops, 40 for a full frame
+    uint8_t flip[5];            // XOR applied to the frame bytes after the checksum
+    uint32_t response_ns;       // Release to ACK delay
+    uint32_t rise_ns;           // Pull-up rise time
+    uint32_t start_min_ns;      // Shortest host start pulse the sensor accepts
+    uint32_t irq_latency_ns;    // Edge to handler entry
+    uint32_t isr_step_ns;       // Cost of a driver call made from the handler
+    uint32_t poll_step_ns;      // Cost of a GPIO access or delay_us call outside it
+    uint32_t timer_start;       // Capture timer value at time 0, to exercise wrap-around
+} HT_SimConfig;
+
+// Nominal sensor sending temperature and humidity, with an ideal line.
+void HT_Sim_Defaults(HT_SimConfig *config, int16_t temperature, int16_t humidity);
+
+// Restarts the simulation at time 0 with config. The registered interrupt
+// handler and the driver's resources are kept, like a reset of the sensor only.
+void HT_Sim_Start(const HT_SimConfig *config);
+
+// Simulated time in ns.
+uint64_t HT_Sim_Now(void);
+
+// Interrupt handler calls since HT_Sim_Start.
+uint32_t HT_Sim_IrqCount(void);
+
+#endif // __HT_DHT22_SIM_H__
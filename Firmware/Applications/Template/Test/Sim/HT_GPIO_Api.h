@@ -0,0 +1,15 @@
+#ifndef __HT_GPIO_API_H__
+#define __HT_GPIO_API_H__
+
+#include <stdint.h>
+#include "bsp.h"
+
+// Host stand-in for the application GPIO helpers (Inc/HT_GPIO_Api.h) the DHT22
+// driver calls, implemented by HT_DHT22_Sim.c.
+
+typedef void (*HT_GPIO_IRQHandler)(void);
+
+int HT_GPIO_RegisterIRQHandler(uint32_t instance, uint16_t mask, HT_GPIO_IRQHandler handler);
+void HT_GPIO_WritePin(uint16_t pin, uint32_t instance, uint16_t value);
+
+#endif // __HT_GPIO_API_H__
@@ -0,0 +1,58 @@
+#ifndef __HT_SIM_BSP_H__
+#define __HT_SIM_BSP_H__
+
+#include <stdint.h>
+
+// Host stand-in for the board support header: the pad and GPIO driver
+// declarations the DHT22 driver uses, implemented by HT_DHT22_Sim.c.
+// Types and prototypes follow pad_qcx212.h, gpio_qcx212.h and bsp.h.
+
+typedef enum _pad_mux {
+    PAD_MuxAlt0 = 0U,
+} pad_mux_t;
+
+typedef enum _pad_pull_config {
+    PAD_InternalPullUp = 0U,
+    PAD_InternalPullDown = 1U,
+    PAD_AutoPull = 2U,
+} pad_pull_config_t;
+
+typedef struct _pad_config {
+    pad_mux_t mux;
+} pad_config_t;
+
+typedef enum _gpio_pin_direction {
+    GPIO_DirectionInput = 0U,
+    GPIO_DirectionOutput = 1U,
+} gpio_pin_direction_t;
+
+typedef enum _gpio_interrupt_config {
+    GPIO_InterruptDisabled = 0U,
+    GPIO_InterruptLowLevel = 1U,
+    GPIO_InterruptHighLevel = 2U,
+    GPIO_InterruptFallingEdge = 3U,
+    GPIO_InterruptRisingEdge = 4U,
+} gpio_interrupt_config_t;
+
+typedef struct _gpio_pin_config {
+    gpio_pin_direction_t pinDirection;
+    union {
+        gpio_interrupt_config_t interruptConfig;
+        uint32_t initOutput;
+    } misc;
+} gpio_pin_config_t;
+
+void PAD_GetDefaultConfig(pad_config_t *config);
+void PAD_SetPinConfig(uint32_t pin, const pad_config_t *config);
+void PAD_SetPinPullConfig(uint32_t pin, pad_pull_config_t config);
+
+void GPIO_PinConfig(uint32_t port, uint16_t pin, const gpio_pin_config_t *config);
+void GPIO_InterruptConfig(uint32_t port, uint16_t pin, gpio_interrupt_config_t config);
+void GPIO_PinWrite(uint32_t port, uint16_t pinMask, uint16_t output);
+uint32_t GPIO_PinRead(uint32_t port, uint16_t pin);
+uint16_t GPIO_GetInterruptFlags(uint32_t port);
+void GPIO_ClearInterruptFlags(uint32_t port, uint16_t mask);
+
+void delay_us(uint32_t us);
+
+#endif // __HT_SIM_BSP_H__
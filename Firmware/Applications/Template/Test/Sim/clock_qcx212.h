@@ -0,0 +1,20 @@
+#ifndef __HT_SIM_CLOCK_QCX212_H__
+#define __HT_SIM_CLOCK_QCX212_H__
+
+#include <stdint.h>
+
+// Host stand-in for clock_qcx212.h, the clock tree has nothing to simulate.
+
+typedef enum {
+    GPR_TIMER2FuncClk = 34U,
+} clock_ID_t;
+
+typedef enum {
+    GPR_TIMER2ClkSel_26M = 1U,
+} clock_select_t;
+
+int32_t GPR_ClockEnable(clock_ID_t id);
+int32_t GPR_ClockDisable(clock_ID_t id);
+int32_t GPR_SetClockSrc(clock_ID_t id, clock_select_t select);
+
+#endif // __HT_SIM_CLOCK_QCX212_H__
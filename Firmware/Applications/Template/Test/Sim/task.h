@@ -0,0 +1,12 @@
+#ifndef __HT_SIM_TASK_H__
+#define __HT_SIM_TASK_H__
+
+#include <stdint.h>
+
+// Host stand-in for the FreeRTOS task API used by the DHT22 polling reader.
+// There is a single thread, so suspending the scheduler does nothing.
+
+void vTaskSuspendAll(void);
+long xTaskResumeAll(void);
+
+#endif // __HT_SIM_TASK_H__
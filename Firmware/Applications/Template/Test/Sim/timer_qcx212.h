@@ -0,0 +1,25 @@
+#ifndef __HT_SIM_TIMER_QCX212_H__
+#define __HT_SIM_TIMER_QCX212_H__
+
+#include <stdint.h>
+
+// Host stand-in for timer_qcx212.h: a free-running counter derived from the
+// simulated time, see HT_DHT22_Sim.h.
+
+typedef enum _timer_reload_option {
+    TIMER_ReloadDisabled = 0U,
+    TIMER_ReloadOnMatch0 = 1U,
+} timer_reload_option_t;
+
+typedef struct _timer_config {
+    timer_reload_option_t reloadOption;
+    uint32_t initValue;
+} timer_config_t;
+
+void TIMER_DriverInit(void);
+void TIMER_GetDefaultConfig(timer_config_t *config);
+void TIMER_Init(uint32_t instance, const timer_config_t *config);
+void TIMER_Start(uint32_t instance);
+uint32_t TIMER_GetCount(uint32_t instance);
+
+#endif // __HT_SIM_TIMER_QCX212_H__
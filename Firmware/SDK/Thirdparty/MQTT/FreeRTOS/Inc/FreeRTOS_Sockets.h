@@ -20,6 +20,7 @@
 #define	FreeRTOS_gethostbyname 			netconn_gethostbyname
 #define FreeRTOS_htons					htons
 #define FreeRTOS_send					send
+#define FreeRTOS_sendv					writev
 
 #define FREERTOS_SO_RCVTIMEO 			SO_RCVTIMEO
 #define FRERRTOS_SO_SNDTIMEO			SO_SNDTIMEO
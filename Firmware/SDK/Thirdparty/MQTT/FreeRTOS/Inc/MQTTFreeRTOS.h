@@ -55,6 +55,7 @@ struct Network
 	xSocket_t my_socket;
 	int (*mqttread) (Network*, unsigned char*, int, int);
 	int (*mqttwrite) (Network*, unsigned char*, int, int);
+	int (*mqttwritev) (Network*, struct iovec*, int, int);	/* optional, the iovec array is consumed */
 	int (*disconnect) (Network*);
 };
 
@@ -82,6 +83,7 @@ int ThreadStart(Thread*, void (*fn)(void*), void* arg);
 
 int FreeRTOS_read(Network*, unsigned char*, int, int);
 int FreeRTOS_write(Network*, unsigned char*, int, int);
+int FreeRTOS_writev(Network*, struct iovec*, int, int);
 int FreeRTOS_disconnect(Network*);
 
 void NetworkInit(Network*);
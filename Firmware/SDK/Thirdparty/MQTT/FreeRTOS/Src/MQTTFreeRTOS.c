@@ -136,6 +136,46 @@ int FreeRTOS_write(Network* n, unsigned char* buffer, int len, int timeout_ms)
 }
 
 
+/* Gathers the buffers into one send, so a payload goes out from where it is stored.
+ * The iovec array is advanced past what was sent. */
+int FreeRTOS_writev(Network* n, struct iovec* iov, int iovcnt, int timeout_ms)
+{
+    TickType_t xTicksToWait = timeout_ms / portTICK_PERIOD_MS; /* convert milliseconds to ticks */
+    TimeOut_t xTimeOut;
+    int sentLen = 0;
+
+    vTaskSetTimeOutState(&xTimeOut); /* Record the time at which this function was entered. */
+    do
+    {
+        int rc = 0;
+
+        FreeRTOS_setsockopt(n->my_socket, 0, FREERTOS_SO_RCVTIMEO, &xTicksToWait, sizeof(xTicksToWait));
+        rc = FreeRTOS_sendv(n->my_socket, iov, iovcnt);
+        if (rc < 0)
+        {
+            sentLen = rc;
+            break;
+        }
+        sentLen += rc;
+
+        /* partial send: skip the buffers that went out */
+        while (iovcnt > 0 && rc >= (int)iov->iov_len)
+        {
+            rc -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (unsigned char*)iov->iov_base + rc;
+            iov->iov_len -= rc;
+        }
+    } while (iovcnt > 0 && xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE);
+
+    return sentLen;
+}
+
+
 int FreeRTOS_disconnect(Network* n)
 {
     int ret;
@@ -192,6 +232,7 @@ void NetworkInit(Network* n) {
     n->my_socket = -1;
     n->mqttread = FreeRTOS_read;
     n->mqttwrite = FreeRTOS_write;
+    n->mqttwritev = FreeRTOS_writev;
     n->disconnect = FreeRTOS_disconnect;
 }
 
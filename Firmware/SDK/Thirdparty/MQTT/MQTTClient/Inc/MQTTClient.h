@@ -56,10 +56,34 @@
 #define MAX_MESSAGE_HANDLERS 5 /* redefinable - how many subscriptions do you want? */
 #endif
 
+#if !defined(MAX_INFLIGHT_MESSAGES)
+#define MAX_INFLIGHT_MESSAGES 4 /* redefinable - QoS1 publishes awaiting their PUBACK */
+#endif
+
+#if !defined(MAX_BATCH_MESSAGES)
+#define MAX_BATCH_MESSAGES 8 /* redefinable - publishes gathered into one MQTTPublishBatch write */
+#endif
+
+#if !defined(MQTT_RETRY_TIMEOUT_MS)
+#define MQTT_RETRY_TIMEOUT_MS 20000 /* redefinable - PUBACK wait before the PUBLISH is resent with DUP */
+#endif
+
+#if !defined(MQTT_MAX_RETRIES)
+#define MQTT_MAX_RETRIES 3
+#endif
+
+#if !defined(MQTT_MAX_TOPIC_ALIASES)
+#define MQTT_MAX_TOPIC_ALIASES 8 /* redefinable - MQTT 5 topic aliases the client assigns to publish topics */
+#endif
+
+#if !defined(MQTT_MAX_PUBLISH_PROPERTIES)
+#define MQTT_MAX_PUBLISH_PROPERTIES 2 /* redefinable - MQTT 5 properties a publish carries besides its topic alias */
+#endif
+
 enum QoS { QOS0, QOS1, QOS2, SUBFAIL=0x80 };
 
 /* all failure return codes must be negative */
-enum returnCode { BUFFER_OVERFLOW = -2, FAILURE = -1, SUCCESS = 0 };
+enum returnCode { WINDOW_FULL = -3, BUFFER_OVERFLOW = -2, FAILURE = -1, SUCCESS = 0 };
 
 /* The Platform specific header must define the Network and Timer structures and functions
  * which operate on them.
@@ -86,6 +110,7 @@ typedef struct MQTTMessage
     unsigned short id;
     void *payload;
     size_t payloadlen;
+    MQTTProperties* properties; /* MQTT 5 publish properties (e.g. user properties), may be NULL; kept with the payload */
 } MQTTMessage;
 
 typedef struct MessageData
@@ -107,6 +132,17 @@ typedef struct MQTTSubackData
 
 typedef void (*messageHandler)(MessageData*);
 
+/* called with SUCCESS once the PUBACK arrived, FAILURE when the retries ran out or the session closed */
+typedef void (*publishHandler)(int rc, void* context);
+
+typedef struct MQTTBatchMessage
+{
+    const char* topicName;
+    MQTTMessage message;
+    publishHandler fp;      /* QoS0: called once written, QoS1: as for MQTTPublishAsync */
+    void* context;
+} MQTTBatchMessage;
+
 typedef struct MQTTClient
 {
     unsigned int next_packetid,
@@ -119,6 +155,11 @@ typedef struct MQTTClient
     char ping_outstanding;
     int isconnected;
     int cleansession;
+    unsigned char MQTTVersion;
+    unsigned char reasonCode;           /* last MQTT 5 reason code received, for diagnostics */
+    unsigned short receiveMaximum;      /* QoS1 publishes the server accepts in flight */
+    unsigned short topicAliasMaximum;   /* topic aliases the server accepts, 0 before MQTT 5 */
+    const char* topicAliases[MQTT_MAX_TOPIC_ALIASES];  /* topic of alias i + 1, NULL when unassigned */
 
     struct MessageHandlers
     {
@@ -128,6 +169,16 @@ typedef struct MQTTClient
 
     void (*defaultMessageHandler) (MessageData*);
 
+    struct InflightMessages
+    {
+        const char* topicName;          /* NULL when the slot is free */
+        MQTTMessage message;
+        publishHandler fp;
+        void* context;
+        Timer timer;                    /* expires when the PUBLISH is due to be resent */
+        unsigned char retries;
+    } inflight[MAX_INFLIGHT_MESSAGES];  /* QoS1 publishes sent by MQTTPublishAsync */
+
     Network* ipstack;
     Timer last_sent, last_received;
 #if defined(MQTT_TASK)
@@ -221,7 +272,25 @@ DLLExport int MQTTConnectWithResults(MQTTClient* client, MQTTPacket_connectData*
  */
 DLLExport int MQTTConnect(MQTTClient* client, MQTTPacket_connectData* options);
 
+/** MQTT 5 Connect - as MQTTConnectWithResults, with the CONNECT properties (e.g. Session Expiry
+ *  Interval, Receive Maximum) when options->MQTTVersion is 5.
+ *  The Receive Maximum and Topic Alias Maximum of the CONNACK are applied to the client: the
+ *  in-flight window is capped at the former, and publishes then use topic aliases, so a topic
+ *  is only sent in full the first time in a connection.
+ *  @param options - connect options
+ *  @param connectProperties - CONNECT properties, may be NULL
+ *  @param willProperties - will properties, may be NULL
+ *  @param data - connack reason code and session present flag returned
+ *  @return success code, or the CONNACK reason code
+ */
+DLLExport int MQTTV5ConnectWithResults(MQTTClient* client, MQTTPacket_connectData* options,
+    MQTTProperties* connectProperties, MQTTProperties* willProperties, MQTTConnackData* data);
+
 /** MQTT Publish - send an MQTT publish packet and wait for all acks to complete for all QoSs
+ *  Only the packet header is serialised into the send buffer, the payload is written from
+ *  message->payload, so it is not limited by the buffer size. This holds for all publishes.
+ *  With MQTT 5 the topic is remembered for its alias, so topic names must stay valid while
+ *  the client is connected. A PUBACK reason code from 0x80 fails the publish.
  *  @param client - the client object to use
  *  @param topic - the topic to publish to
  *  @param message - the message to send
@@ -229,6 +298,44 @@ DLLExport int MQTTConnect(MQTTClient* client, MQTTPacket_connectData* options);
  */
 DLLExport int MQTTPublish(MQTTClient* client, const char*, MQTTMessage*);
 
+/** MQTT Publish Async - send an MQTT QoS1 publish packet without waiting for the PUBACK.
+ *  Up to MAX_INFLIGHT_MESSAGES can be outstanding; PUBACKs are matched by packet id in any
+ *  order while the client reads the socket (MQTTYield, MQTTProcess), and a PUBLISH still
+ *  unacknowledged after MQTT_RETRY_TIMEOUT_MS is resent with DUP set.
+ *  topicName and message->payload must stay valid until the handler was called.
+ *  @param client - the client object to use
+ *  @param topic - the topic to publish to
+ *  @param message - the message to send, its id is set here
+ *  @param handler - called with the outcome, may be NULL
+ *  @param context - passed to the handler
+ *  @return success code, WINDOW_FULL when every slot is in flight; the handler is only
+ *  called when SUCCESS was returned
+ */
+DLLExport int MQTTPublishAsync(MQTTClient* client, const char* topic, MQTTMessage* message,
+        publishHandler handler, void* context);
+
+/** MQTT Publish Batch - serialise the headers of several QoS0/QoS1 publish packets into the
+ *  send buffer and send them with their payloads in a single vectored network write,
+ *  optionally followed by a DISCONNECT.
+ *  QoS1 messages go in flight as with MQTTPublishAsync. Messages are taken in order until
+ *  the send buffer, MAX_BATCH_MESSAGES or the in-flight window is full; the DISCONNECT is
+ *  only added when all of them fit, and fails the QoS1 messages whose PUBACK can no longer
+ *  be read.
+ *  @param client - the client object to use
+ *  @param messages - the messages to send, their ids are set here
+ *  @param count - number of messages
+ *  @param disconnect - append a DISCONNECT packet and close the session
+ *  @return number of messages sent, WINDOW_FULL or BUFFER_OVERFLOW when not even the first
+ *  one fits, or FAILURE; handlers of messages not sent are not called
+ */
+DLLExport int MQTTPublishBatch(MQTTClient* client, MQTTBatchMessage* messages, int count, int disconnect);
+
+/** MQTT Inflight left - time until the next asynchronous publish is due to be resent
+ *  @param client - the client object to use
+ *  @return milliseconds, or -1 when nothing is in flight
+ */
+DLLExport int MQTTInflightLeftMS(MQTTClient* client);
+
 /** MQTT SetMessageHandler - set or remove a per topic message handler
  *  @param client - the client object to use
  *  @param topicFilter - the topic filter set the message handler for
@@ -274,6 +381,14 @@ DLLExport int MQTTDisconnect(MQTTClient* client);
  */
 DLLExport int MQTTYield(MQTTClient* client, int time);
 
+/** MQTT Process - read and handle a single packet, then run the keepalive check.
+ *  For a task that waits for socket readiness itself instead of calling MQTTYield.
+ *  @param client - the client object to use
+ *  @param timeout_ms - how long to wait for the packet
+ *  @return the packet type handled, 0 if none arrived, or a negative failure code
+ */
+DLLExport int MQTTProcess(MQTTClient* client, int timeout_ms);
+
 /** MQTT isConnected
  *  @param client - the client object to use
  *  @return truth value indicating whether the client is connected to the server
@@ -39,6 +39,26 @@ static int HT_MQTT_TLSWrite(Network * network, unsigned char *buffer, int len, i
 	return written;
 }
 
+// Each buffer becomes its own record, the payload is encrypted from where it is stored
+static int HT_MQTT_TLSWritev(Network * network, struct iovec *iov, int iovcnt, int timeout_ms) {
+	int ret = 0;
+	int written = 0;
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len == 0)
+			continue;
+
+		ret = HT_MQTT_TLSWrite(network, iov[i].iov_base, iov[i].iov_len, timeout_ms);
+		if (ret < 0)
+			return ret;
+
+		written += ret;
+	}
+
+	return written;
+}
+
 static int HT_MQTT_TLSRead(Network * network, unsigned char *buffer, int len, int timeout_ms) {
 	int rxLen = 0;
 	int ret_val = -1;
@@ -130,6 +150,7 @@ int32_t HT_MQTT_TLSConnect(MqttClientContext *context, Network *network) {
 	// 5. Setup the network parameters
 	network->mqttread = HT_MQTT_TLSRead;
 	network->mqttwrite = HT_MQTT_TLSWrite;
+	network->mqttwritev = HT_MQTT_TLSWritev;
 	network->disconnect = HT_MQTT_TLSDisconnect;
 
 	// 4. Start the TLS connection
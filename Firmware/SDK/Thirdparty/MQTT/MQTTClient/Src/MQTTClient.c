@@ -232,6 +232,105 @@ static int sendPacket(MQTTClient* c, int length, Timer* timer)
     return rc;
 }
 
+// sends the buffers where they are, in one vectored write when the network supports it
+static int sendPacketv(MQTTClient* c, struct iovec* iov, int iovcnt, Timer* timer)
+{
+    int rc = FAILURE,
+        length = 0,
+        sent = 0,
+        i;
+
+    for (i = 0; i < iovcnt; ++i)
+        length += iov[i].iov_len;
+
+    if (c->ipstack->mqttwritev != NULL)
+        sent = c->ipstack->mqttwritev(c->ipstack, iov, iovcnt, TimerLeftMS(timer));
+    else
+    {
+        for (i = 0; i < iovcnt && sent >= 0 && !TimerIsExpired(timer); ++i)
+        {
+            #ifdef MQTT_RAI_OPTIMIZE
+            rc = c->ipstack->mqttwrite(c->ipstack, iov[i].iov_base, iov[i].iov_len, TimerLeftMS(timer), 0, false);
+            #else
+            rc = c->ipstack->mqttwrite(c->ipstack, iov[i].iov_base, iov[i].iov_len, TimerLeftMS(timer));
+            #endif
+            sent = (rc < 0) ? rc : sent + rc;
+        }
+    }
+    if (sent == length)
+    {
+        TimerCountdown(&c->last_sent, c->keepAliveInterval); // record the fact that we have successfully sent the packet
+        rc = SUCCESS;
+    }
+    else
+        rc = FAILURE;
+    return rc;
+}
+
+// MQTT 5: the alias slot of topicName, or a free one the server accepts; -1 to send the topic in full
+static int topicAlias(MQTTClient* c, const char* topicName)
+{
+    int max = (c->topicAliasMaximum < MQTT_MAX_TOPIC_ALIASES) ? c->topicAliasMaximum : MQTT_MAX_TOPIC_ALIASES;
+    int i;
+
+    for (i = 0; i < max && c->topicAliases[i] != NULL; ++i)
+        if (c->topicAliases[i] == topicName || strcmp(c->topicAliases[i], topicName) == 0)
+            return i;
+    return (i < max) ? i : -1;
+}
+
+static void resetTopicAliases(MQTTClient* c)
+{
+    int i;
+
+    for (i = 0; i < MQTT_MAX_TOPIC_ALIASES; ++i)
+        c->topicAliases[i] = NULL;
+}
+
+// publish header serialised into c->buf at offset, payload left in place
+static int serializePublishv(MQTTClient* c, int offset, const char* topicName, MQTTMessage* message, struct iovec* iov)
+{
+    MQTTString topic = MQTTString_initializer;
+    MQTTProperty alias;
+    MQTTProperty array[MQTT_MAX_PUBLISH_PROPERTIES + 1];
+    MQTTProperties props = {0, MQTT_MAX_PUBLISH_PROPERTIES + 1, 0, array};
+    int len = 0;
+    int i = -1;
+    int j;
+
+    topic.cstring = (char *)topicName;
+    if (c->MQTTVersion < 5)
+        len = MQTTSerialize_publishHeader(c->buf + offset, c->buf_size - offset, message->dup, message->qos, message->retained,
+                  message->id, topic, message->payloadlen);
+    else
+    {
+        if ((i = topicAlias(c, topicName)) >= 0)
+        {
+            alias.identifier = MQTTPROPERTY_CODE_TOPIC_ALIAS;
+            alias.value.integer2 = i + 1;
+            MQTTProperties_add(&props, &alias);
+            if (c->topicAliases[i] != NULL)
+                topic.cstring = "";     // the server already maps the alias to the topic
+        }
+        for (j = 0; message->properties != NULL && j < message->properties->count; ++j)
+            if (MQTTProperties_add(&props, &message->properties->array[j]) != 0)
+                return -1;
+        len = MQTTV5Serialize_publishHeader(c->buf + offset, c->buf_size - offset, message->dup, message->qos, message->retained,
+                  message->id, topic, &props, message->payloadlen);
+    }
+    if (len <= 0)
+        return len;
+
+    if (i >= 0)
+        c->topicAliases[i] = topicName;     // assigned once the header carrying it is built
+
+    iov[0].iov_base = c->buf + offset;
+    iov[0].iov_len = len;
+    iov[1].iov_base = message->payload;
+    iov[1].iov_len = message->payloadlen;
+    return len;
+}
+
 void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeout_ms,
         unsigned char* sendbuf, size_t sendbuf_size, unsigned char* readbuf, size_t readbuf_size)
 {
@@ -240,6 +339,8 @@ void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeou
 
     for (i = 0; i < MAX_MESSAGE_HANDLERS; ++i)
         c->messageHandlers[i].topicFilter = 0;
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+        c->inflight[i].topicName = NULL;
     c->command_timeout_ms = command_timeout_ms;
     c->buf = sendbuf;
     c->buf_size = sendbuf_size;
@@ -248,6 +349,11 @@ void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeou
     c->isconnected = 0;
     c->cleansession = 0;
     c->ping_outstanding = 0;
+    c->MQTTVersion = 4;
+    c->reasonCode = 0;
+    c->receiveMaximum = MAX_INFLIGHT_MESSAGES;
+    c->topicAliasMaximum = 0;
+    resetTopicAliases(c);
     c->defaultMessageHandler = mqttDefMessageArrived;
       c->next_packetid = 1;
     TimerInit(&c->last_sent);
@@ -382,6 +488,120 @@ int deliverMessage(MQTTClient* c, MQTTString* topicName, MQTTMessage* message)
     return rc;
 }
 
+// frees the slot first, so the handler may publish again
+static void completeInflight(MQTTClient* c, int i, int rc)
+{
+    publishHandler fp = c->inflight[i].fp;
+
+    c->inflight[i].topicName = NULL;
+    if (fp != NULL)
+        fp(rc, c->inflight[i].context);
+}
+
+static void ackInflight(MQTTClient* c, unsigned short packetid, int rc)
+{
+    int i;
+
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+    {
+        if (c->inflight[i].topicName != NULL && c->inflight[i].message.id == packetid)
+        {
+            completeInflight(c, i, rc);
+            break;
+        }
+    }
+}
+
+// a free in-flight slot, or -1 when the window or the server's Receive Maximum is full
+static int freeInflight(MQTTClient* c)
+{
+    int slot = -1,
+        used = 0,
+        i;
+
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+    {
+        if (c->inflight[i].topicName != NULL)
+            used++;
+        else if (slot < 0)
+            slot = i;
+    }
+    return (used < c->receiveMaximum) ? slot : -1;
+}
+
+// a failed write leaves the server's state unknown, whether or not the session is closed:
+// aliases are assigned again from scratch and the publishes in flight are failed
+static void sendFailed(MQTTClient* c)
+{
+    int i;
+
+    resetTopicAliases(c);
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+        if (c->inflight[i].topicName != NULL)
+            completeInflight(c, i, FAILURE);
+}
+
+static int sendInflight(MQTTClient* c, int i)
+{
+    Timer timer;
+    struct iovec iov[2];
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, c->command_timeout_ms);
+
+    if (serializePublishv(c, 0, c->inflight[i].topicName, &c->inflight[i].message, iov) <= 0)
+        return FAILURE;
+
+    TimerCountdownMS(&c->inflight[i].timer, MQTT_RETRY_TIMEOUT_MS);
+    return sendPacketv(c, iov, 2, &timer);
+}
+
+// resends the publishes whose PUBACK is overdue, giving up after MQTT_MAX_RETRIES
+static int retransmitInflight(MQTTClient* c)
+{
+    int i;
+
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+    {
+        if (c->inflight[i].topicName == NULL || !TimerIsExpired(&c->inflight[i].timer))
+            continue;
+
+        if (c->inflight[i].retries >= MQTT_MAX_RETRIES)
+        {
+            completeInflight(c, i, FAILURE);
+            continue;
+        }
+
+        c->inflight[i].retries++;
+        c->inflight[i].message.dup = 1;
+        if (sendInflight(c, i) != SUCCESS)
+        {
+            sendFailed(c);
+            return FAILURE;
+        }
+    }
+
+    return SUCCESS;
+}
+
+int MQTTInflightLeftMS(MQTTClient* c)
+{
+    int i;
+    int left = -1;
+
+    for (i = 0; i < MAX_INFLIGHT_MESSAGES; ++i)
+    {
+        if (c->inflight[i].topicName != NULL)
+        {
+            int ms = TimerLeftMS(&c->inflight[i].timer);
+            if (left < 0 || ms < left)
+                left = ms;
+        }
+    }
+
+    return left;
+}
+
 // int keepalive(MQTTClient* c)
 // {
 //     int rc = SUCCESS;
@@ -489,6 +709,10 @@ void MQTTCloseSession(MQTTClient* c)
     c->isconnected = 0;
     if (c->cleansession)
         MQTTCleanSession(c);
+
+    /* aliases only live as long as the network connection, and publishes still in flight
+       are failed: the application decides whether to send them again */
+    sendFailed(c);
 }
 
 int cycle(MQTTClient* c, Timer* timer)
@@ -516,7 +740,13 @@ int cycle(MQTTClient* c, Timer* timer)
         case CONNACK:
             break;
         case PUBACK:
-			break;
+        {
+            unsigned short mypacketid;
+            unsigned char dup, type;
+            if (MQTTV5Deserialize_ack(&type, &dup, &mypacketid, &c->reasonCode, NULL, c->readbuf, c->readbuf_size) == 1)
+                ackInflight(c, mypacketid, (c->reasonCode >= 0x80) ? FAILURE : SUCCESS);
+            break;
+        }
         case SUBACK:
 			break;
         case UNSUBACK:
@@ -525,9 +755,11 @@ int cycle(MQTTClient* c, Timer* timer)
         {
             MQTTString topicName;
             MQTTMessage msg;
+            MQTTProperties props = MQTTProperties_initializer;  /* MQTT 5 properties are parsed and skipped */
             int intQoS;
             msg.payloadlen = 0; /* this is a size_t, but deserialize publish sets this as int */
-            if (MQTTDeserialize_publish(&msg.dup, &intQoS, &msg.retained, &msg.id, &topicName,
+            msg.properties = NULL;
+            if (MQTTV5Deserialize_publish(&msg.dup, &intQoS, &msg.retained, &msg.id, &topicName, (c->MQTTVersion < 5) ? NULL : &props,
                (unsigned char**)&msg.payload, (int*)&msg.payloadlen, c->readbuf, c->readbuf_size) != 1)
                 goto exit;
             msg.qos = (enum QoS)intQoS;
@@ -572,6 +804,16 @@ int cycle(MQTTClient* c, Timer* timer)
         case PINGRESP:
             c->ping_outstanding = 0;
             break;
+        case DISCONNECT:    /* MQTT 5 server closing the connection, the reason code says why */
+            MQTTV5Deserialize_disconnect(NULL, &c->reasonCode, c->readbuf, c->readbuf_size);
+            rc = FAILURE;
+            goto exit;
+    }
+
+    if (retransmitInflight(c) != SUCCESS)
+    {
+        rc = FAILURE;
+        goto exit;
     }
 
     if (keepalive(c) != SUCCESS) {
@@ -586,7 +828,8 @@ int cycle(MQTTClient* c, Timer* timer)
             memset(&mqttMsg, 0, sizeof(mqttMsg));
             mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
 
-            xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
+            if (mqttSendMsgHandle != NULL)  // only created by MQTTRun
+                xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
         }
         else
         {
@@ -597,7 +840,8 @@ int cycle(MQTTClient* c, Timer* timer)
                 memset(&mqttMsg, 0, sizeof(mqttMsg));
                 mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
 
-                xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
+                if (mqttSendMsgHandle != NULL)
+                    xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
             }
             else
             {
@@ -640,6 +884,16 @@ int MQTTYield(MQTTClient* c, int timeout_ms)
     return rc;
 }
 
+int MQTTProcess(MQTTClient* c, int timeout_ms)
+{
+    Timer timer;
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, timeout_ms);
+
+    return cycle(c, &timer);
+}
+
 // int MQTTIsConnected(MQTTClient* client)
 // {
 //   return client->isconnected;
@@ -729,6 +983,12 @@ int waitfor(MQTTClient* c, int packet_type, Timer* timer)
 }
 
 int MQTTConnectWithResults(MQTTClient* c, MQTTPacket_connectData* options, MQTTConnackData* data)
+{
+    return MQTTV5ConnectWithResults(c, options, NULL, NULL, data);
+}
+
+int MQTTV5ConnectWithResults(MQTTClient* c, MQTTPacket_connectData* options,
+    MQTTProperties* connectProperties, MQTTProperties* willProperties, MQTTConnackData* data)
 {
     Timer connect_timer;
     int rc = FAILURE;
@@ -749,8 +1009,12 @@ int MQTTConnectWithResults(MQTTClient* c, MQTTPacket_connectData* options, MQTTC
 
     c->keepAliveInterval = options->keepAliveInterval;
     c->cleansession = options->cleansession;
+    c->MQTTVersion = options->MQTTVersion;
+    c->receiveMaximum = MAX_INFLIGHT_MESSAGES;
+    c->topicAliasMaximum = 0;
+    resetTopicAliases(c);
     TimerCountdown(&c->last_received, c->keepAliveInterval);
-    if ((len = MQTTSerialize_connect(c->buf, c->buf_size, options)) <= 0)
+    if ((len = MQTTV5Serialize_connect(c->buf, c->buf_size, options, connectProperties, willProperties)) <= 0)
         goto exit;
     if ((rc = sendPacket(c, len, &connect_timer)) != SUCCESS)  // send the connect packet
         goto exit; // there was a problem
@@ -758,12 +1022,22 @@ int MQTTConnectWithResults(MQTTClient* c, MQTTPacket_connectData* options, MQTTC
     // this will be a blocking call, wait for the connack
     if (waitfor(c, CONNACK, &connect_timer) == CONNACK)
     {
+        MQTTProperty connack[10];
+        MQTTProperties props = {0, 10, 0, connack};
+        unsigned int value;
+
         data->rc = 0;
         data->sessionPresent = 0;
-        if (MQTTDeserialize_connack(&data->sessionPresent, &data->rc, c->readbuf, c->readbuf_size) == 1)
+        if (MQTTV5Deserialize_connack((c->MQTTVersion < 5) ? NULL : &props, &data->sessionPresent, &data->rc,
+                c->readbuf, c->readbuf_size) == 1)
             rc = data->rc;
         else
             rc = FAILURE;
+
+        if (MQTTProperties_getNumericValue(&props, MQTTPROPERTY_CODE_RECEIVE_MAXIMUM, &value) && value < c->receiveMaximum)
+            c->receiveMaximum = value;
+        if (MQTTProperties_getNumericValue(&props, MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM, &value))
+            c->topicAliasMaximum = value;
     }
     else
         rc = FAILURE;
@@ -869,6 +1143,7 @@ int MQTTSubscribeWithResults(MQTTClient* c, const char* topicFilter, enum QoS qo
     Timer timer;
     int len = 0;
     int mqttQos = (int)qos;
+    MQTTProperties props = MQTTProperties_initializer;
     MQTTString topic = MQTTString_initializer;
     topic.cstring = (char *)topicFilter;
 
@@ -881,7 +1156,8 @@ int MQTTSubscribeWithResults(MQTTClient* c, const char* topicFilter, enum QoS qo
     TimerInit(&timer);
     TimerCountdownMS(&timer, c->command_timeout_ms);
 
-    len = MQTTSerialize_subscribe(c->buf, c->buf_size, 0, getNextPacketId(c), 1, &topic, (int*)&mqttQos);
+    len = MQTTV5Serialize_subscribe(c->buf, c->buf_size, 0, getNextPacketId(c), (c->MQTTVersion < 5) ? NULL : &props,
+              1, &topic, (int*)&mqttQos);
     if (len <= 0)
         goto exit;
     if ((rc = sendPacket(c, len, &timer)) != SUCCESS) // send the subscribe packet
@@ -889,14 +1165,19 @@ int MQTTSubscribeWithResults(MQTTClient* c, const char* topicFilter, enum QoS qo
 
     if (waitfor(c, SUBACK, &timer) == SUBACK)      // wait for suback
     {
+        MQTTProperties props = MQTTProperties_initializer;
         int count = 0;
         unsigned short mypacketid;
         data->grantedQoS = QOS0;
         mqttQos = (int)data->grantedQoS;
-        if (MQTTDeserialize_suback(&mypacketid, 1, &count, (int*)&mqttQos, c->readbuf, c->readbuf_size) == 1)
+        if (MQTTV5Deserialize_suback(&mypacketid, (c->MQTTVersion < 5) ? NULL : &props, 1, &count, (int*)&mqttQos,
+                c->readbuf, c->readbuf_size) == 1)
         {
-            if (data->grantedQoS != 0x80)
+            data->grantedQoS = (enum QoS)mqttQos;
+            if (mqttQos < 0x80)     // SUBFAIL, or an MQTT 5 failure reason code
                 rc = MQTTSetMessageHandler(c, topicFilter, messageHandler);
+            else
+                c->reasonCode = mqttQos;
         }
     }
     else
@@ -929,6 +1210,7 @@ int MQTTUnsubscribe(MQTTClient* c, const char* topicFilter)
     int rc = FAILURE;
     Timer timer;
     MQTTString topic = MQTTString_initializer;
+    MQTTProperties props = MQTTProperties_initializer;
     topic.cstring = (char *)topicFilter;
     int len = 0;
 
@@ -941,7 +1223,8 @@ int MQTTUnsubscribe(MQTTClient* c, const char* topicFilter)
     TimerInit(&timer);
     TimerCountdownMS(&timer, c->command_timeout_ms);
 
-    if ((len = MQTTSerialize_unsubscribe(c->buf, c->buf_size, 0, getNextPacketId(c), 1, &topic)) <= 0)
+    if ((len = MQTTV5Serialize_unsubscribe(c->buf, c->buf_size, 0, getNextPacketId(c), (c->MQTTVersion < 5) ? NULL : &props,
+            1, &topic)) <= 0)
         goto exit;
     if ((rc = sendPacket(c, len, &timer)) != SUCCESS) // send the subscribe packet
         goto exit; // there was a problem
@@ -949,7 +1232,9 @@ int MQTTUnsubscribe(MQTTClient* c, const char* topicFilter)
     if (waitfor(c, UNSUBACK, &timer) == UNSUBACK)
     {
         unsigned short mypacketid;  // should be the same as the packetid above
-        if (MQTTDeserialize_unsuback(&mypacketid, c->readbuf, c->readbuf_size) == 1)
+        int count = 0, reasonCode = MQTTREASONCODE_SUCCESS;
+        if ((c->MQTTVersion < 5) ? MQTTDeserialize_unsuback(&mypacketid, c->readbuf, c->readbuf_size) == 1 :
+            MQTTV5Deserialize_unsuback(&mypacketid, &props, 1, &count, &reasonCode, c->readbuf, c->readbuf_size) == 1)
         {
             /* remove the subscription message handler associated with this topic, if there is one */
             MQTTSetMessageHandler(c, topicFilter, NULL);
@@ -975,9 +1260,7 @@ int MQTTPublish(MQTTClient* c, const char* topicName, MQTTMessage* message)
 {
     int rc = FAILURE;
     Timer timer;
-    MQTTString topic = MQTTString_initializer;
-    topic.cstring = (char *)topicName;
-    int len = 0;
+    struct iovec iov[2];
 
 #if defined(MQTT_TASK)
       MutexLock(&c->mutex);
@@ -991,24 +1274,29 @@ int MQTTPublish(MQTTClient* c, const char* topicName, MQTTMessage* message)
     if (message->qos == QOS1 || message->qos == QOS2)
         message->id = getNextPacketId(c);
 
-    len = MQTTSerialize_publish(c->buf, c->buf_size, 0, message->qos, message->retained, message->id,
-              topic, (unsigned char*)message->payload, message->payloadlen);
-    if (len <= 0)
+    message->dup = 0;
+    if (serializePublishv(c, 0, topicName, message, iov) <= 0)
         goto exit;
-    if ((rc = sendPacket(c, len, &timer)) != SUCCESS) // send the subscribe packet
+    if ((rc = sendPacketv(c, iov, 2, &timer)) != SUCCESS) // payload sent from the caller's buffer
+    {
+        sendFailed(c);
         goto exit; // there was a problem
+    }
 
     if (message->qos == QOS1)
     {
-        if (waitfor(c, PUBACK, &timer) == PUBACK)
+        rc = FAILURE;
+        while (waitfor(c, PUBACK, &timer) == PUBACK)    // PUBACKs of asynchronous publishes are skipped
         {
             unsigned short mypacketid;
             unsigned char dup, type;
-            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
-                rc = FAILURE;
+            if (MQTTV5Deserialize_ack(&type, &dup, &mypacketid, &c->reasonCode, NULL, c->readbuf, c->readbuf_size) == 1 &&
+                mypacketid == message->id)
+            {
+                rc = (c->reasonCode >= 0x80) ? FAILURE : SUCCESS;
+                break;
+            }
         }
-        else
-            rc = FAILURE;
     }
     else if (message->qos == QOS2)
     {
@@ -1039,6 +1327,156 @@ exit:
     return rc;
 }
 
+int MQTTPublishAsync(MQTTClient* c, const char* topicName, MQTTMessage* message,
+        publishHandler handler, void* context)
+{
+    int rc = FAILURE;
+    int i;
+
+    if (message->qos != QOS1)
+        return FAILURE;
+
+#if defined(MQTT_TASK)
+      MutexLock(&c->mutex);
+#endif
+      if (!c->isconnected)
+            goto exit;
+
+    if ((i = freeInflight(c)) < 0)
+    {
+        rc = WINDOW_FULL;
+        goto exit;
+    }
+
+    message->id = getNextPacketId(c);
+    message->dup = 0;
+
+    c->inflight[i].message = *message;
+    c->inflight[i].fp = handler;
+    c->inflight[i].context = context;
+    c->inflight[i].retries = 0;
+    c->inflight[i].topicName = topicName;
+    TimerInit(&c->inflight[i].timer);
+
+    if ((rc = sendInflight(c, i)) != SUCCESS)
+    {
+        c->inflight[i].topicName = NULL;   // not queued, so the handler is not called
+        sendFailed(c);
+    }
+
+exit:
+    if (rc == FAILURE)
+#if MQTT_TLS_ENABLE == 1
+        ;//MQTTCloseSession(c);
+#else
+        MQTTCloseSession(c);
+#endif
+#if defined(MQTT_TASK)
+      MutexUnlock(&c->mutex);
+#endif
+    return rc;
+}
+
+int MQTTPublishBatch(MQTTClient* c, MQTTBatchMessage* messages, int count, int disconnect)
+{
+    int rc = FAILURE;
+    Timer timer;
+    struct iovec iov[2 * MAX_BATCH_MESSAGES + 1];
+    int reserved[MAX_INFLIGHT_MESSAGES];
+    int nreserved = 0;
+    int window_full = 0;
+    int len = 0;
+    int i, j, n;
+
+#if defined(MQTT_TASK)
+      MutexLock(&c->mutex);
+#endif
+      if (!c->isconnected)
+            goto exit;
+
+    for (i = 0; i < count && i < MAX_BATCH_MESSAGES; ++i)
+    {
+        MQTTMessage* message = &messages[i].message;
+        int slot = -1;
+
+        if (message->qos == QOS1)
+        {
+            if ((slot = freeInflight(c)) < 0)
+            {
+                window_full = 1;
+                break;
+            }
+            message->id = getNextPacketId(c);
+        }
+        else if (message->qos != QOS0)
+            break;
+
+        message->dup = 0;
+        n = serializePublishv(c, len, messages[i].topicName, message, &iov[2 * i]);   // headers share c->buf
+        if (n <= 0)
+            break;
+        len += n;
+
+        if (slot >= 0)
+        {
+            c->inflight[slot].message = *message;
+            c->inflight[slot].fp = messages[i].fp;
+            c->inflight[slot].context = messages[i].context;
+            c->inflight[slot].retries = 0;
+            c->inflight[slot].topicName = messages[i].topicName;
+            TimerCountdownMS(&c->inflight[slot].timer, MQTT_RETRY_TIMEOUT_MS);
+            reserved[nreserved++] = slot;
+        }
+    }
+
+    if (i == 0)
+    {
+        rc = window_full ? WINDOW_FULL : BUFFER_OVERFLOW;
+        goto exit;
+    }
+
+    n = 2 * i;
+    if (disconnect && i == count && (j = MQTTSerialize_disconnect(c->buf + len, c->buf_size - len)) > 0)
+    {
+        iov[n].iov_base = c->buf + len;
+        iov[n++].iov_len = j;
+    }
+    else
+        disconnect = 0;
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, c->command_timeout_ms);
+
+    if (sendPacketv(c, iov, n, &timer) != SUCCESS)  // one write for the whole burst
+    {
+        for (j = 0; j < nreserved; ++j)
+            c->inflight[reserved[j]].topicName = NULL;    // not sent, so the handlers are not called
+        sendFailed(c);
+        goto exit;
+    }
+
+    for (j = 0; j < i; ++j)
+        if (messages[j].message.qos == QOS0 && messages[j].fp != NULL)
+            messages[j].fp(SUCCESS, messages[j].context);
+
+    if (disconnect)
+        MQTTCloseSession(c);
+
+    rc = i;
+
+exit:
+    if (rc == FAILURE)
+#if MQTT_TLS_ENABLE == 1
+        ;//MQTTCloseSession(c);
+#else
+        MQTTCloseSession(c);
+#endif
+#if defined(MQTT_TASK)
+      MutexUnlock(&c->mutex);
+#endif
+    return rc;
+}
+
 int MQTTDisconnect(MQTTClient* c)
 {
     int rc = FAILURE;
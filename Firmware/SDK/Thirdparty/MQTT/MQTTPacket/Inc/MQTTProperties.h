@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * MQTT 5 properties, the optional fields that follow the variable header of
+ * most MQTT 5 packets.
+ *
+ * Properties are read in place: binary and string values point into the packet
+ * buffer and are only valid while it is. Reading stores up to max_count of them
+ * in the caller's array and validates and skips the rest, so a reader that only
+ * needs a few values can pass a small array.
+ *******************************************************************************/
+
+#if !defined(MQTTPROPERTIES_H)
+#define MQTTPROPERTIES_H
+
+#if !defined(DLLImport)
+  #define DLLImport
+#endif
+#if !defined(DLLExport)
+  #define DLLExport
+#endif
+
+#define MQTT_INVALID_PROPERTY_ID -2
+
+enum MQTTPropertyCodes {
+	MQTTPROPERTY_CODE_PAYLOAD_FORMAT_INDICATOR = 1,          /**< The value is 1 */
+	MQTTPROPERTY_CODE_MESSAGE_EXPIRY_INTERVAL = 2,           /**< The value is 2 */
+	MQTTPROPERTY_CODE_CONTENT_TYPE = 3,                      /**< The value is 3 */
+	MQTTPROPERTY_CODE_RESPONSE_TOPIC = 8,                    /**< The value is 8 */
+	MQTTPROPERTY_CODE_CORRELATION_DATA = 9,                  /**< The value is 9 */
+	MQTTPROPERTY_CODE_SUBSCRIPTION_IDENTIFIER = 11,          /**< The value is 11 */
+	MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL = 17,          /**< The value is 17 */
+	MQTTPROPERTY_CODE_ASSIGNED_CLIENT_IDENTIFER = 18,        /**< The value is 18 */
+	MQTTPROPERTY_CODE_SERVER_KEEP_ALIVE = 19,                /**< The value is 19 */
+	MQTTPROPERTY_CODE_AUTHENTICATION_METHOD = 21,            /**< The value is 21 */
+	MQTTPROPERTY_CODE_AUTHENTICATION_DATA = 22,              /**< The value is 22 */
+	MQTTPROPERTY_CODE_REQUEST_PROBLEM_INFORMATION = 23,      /**< The value is 23 */
+	MQTTPROPERTY_CODE_WILL_DELAY_INTERVAL = 24,              /**< The value is 24 */
+	MQTTPROPERTY_CODE_REQUEST_RESPONSE_INFORMATION = 25,     /**< The value is 25 */
+	MQTTPROPERTY_CODE_RESPONSE_INFORMATION = 26,             /**< The value is 26 */
+	MQTTPROPERTY_CODE_SERVER_REFERENCE = 28,                 /**< The value is 28 */
+	MQTTPROPERTY_CODE_REASON_STRING = 31,                    /**< The value is 31 */
+	MQTTPROPERTY_CODE_RECEIVE_MAXIMUM = 33,                  /**< The value is 33*/
+	MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM = 34,              /**< The value is 34 */
+	MQTTPROPERTY_CODE_TOPIC_ALIAS = 35,                      /**< The value is 35 */
+	MQTTPROPERTY_CODE_MAXIMUM_QOS = 36,                      /**< The value is 36 */
+	MQTTPROPERTY_CODE_RETAIN_AVAILABLE = 37,                 /**< The value is 37 */
+	MQTTPROPERTY_CODE_USER_PROPERTY = 38,                    /**< The value is 38 */
+	MQTTPROPERTY_CODE_MAXIMUM_PACKET_SIZE = 39,              /**< The value is 39 */
+	MQTTPROPERTY_CODE_WILDCARD_SUBSCRIPTION_AVAILABLE = 40,  /**< The value is 40 */
+	MQTTPROPERTY_CODE_SUBSCRIPTION_IDENTIFIERS_AVAILABLE = 41,/**< The value is 41 */
+	MQTTPROPERTY_CODE_SHARED_SUBSCRIPTION_AVAILABLE = 42     /**< The value is 42 */
+};
+
+enum MQTTPropertyTypes {
+	MQTTPROPERTY_TYPE_BYTE,
+	MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER,
+	MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER,
+	MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER,
+	MQTTPROPERTY_TYPE_BINARY_DATA,
+	MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING,
+	MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR
+};
+
+typedef struct
+{
+	int identifier; /**<  The MQTT V5 property id. A multi-byte integer. */
+	/** The value of the property, as a union of the different possible types. */
+	union {
+		unsigned char byte;       /**< holds the value of a byte property type */
+		unsigned short integer2;  /**< holds the value of a 2 byte integer property type */
+		unsigned int integer4;    /**< holds the value of a 4 byte or variable byte integer property type */
+		struct {
+			MQTTLenString data;  /**< The value of a string property, or the name of a user property. */
+			MQTTLenString value; /**< The value of a user property. */
+		};
+	} value;
+} MQTTProperty;
+
+typedef struct MQTTProperties
+{
+	int count;     /**< number of property entries in the array */
+	int max_count; /**< max number of properties that the currently allocated array can store */
+	int length;    /**< mbi: byte length of all properties */
+	MQTTProperty *array;  /**< array of properties */
+} MQTTProperties;
+
+#define MQTTProperties_initializer {0, 0, 0, NULL}
+
+DLLExport int MQTTProperty_getType(int identifier);
+
+/* length of the properties when serialized, including the leading variable byte length */
+DLLExport int MQTTProperties_len(MQTTProperties* props);
+
+/* copies prop into the array, returns 0 or -1 when the array is full or the id unknown */
+DLLExport int MQTTProperties_add(MQTTProperties* props, const MQTTProperty* prop);
+
+/* writes the properties, or an empty property length when props is NULL; returns bytes written */
+int MQTTProperties_write(unsigned char** pptr, const MQTTProperties* props);
+
+/* reads the properties at *pptr, returns 1 on success or 0 when they are malformed */
+int MQTTProperties_read(MQTTProperties* props, unsigned char** pptr, unsigned char* enddata);
+
+/* value of a byte or integer property, returns 1 when it was found */
+DLLExport int MQTTProperties_getNumericValue(MQTTProperties* props, int identifier, unsigned int* value);
+
+/* number of bytes taken by a variable byte integer */
+int MQTTPacket_VBIlen(int rem_len);
+
+#endif /* MQTTPROPERTIES_H */
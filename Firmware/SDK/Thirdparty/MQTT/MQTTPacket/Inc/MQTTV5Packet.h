@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * MQTT 5 packet serialisation.
+ *
+ * Each function takes the properties of its packet. A NULL properties pointer
+ * selects the MQTT 3.1.1 layout, so the MQTT 3 functions are the same code
+ * called with NULL. CONNECT is the exception: its layout follows
+ * options->MQTTVersion and NULL sends no properties. When reading, a MQTTProperties with max_count 0 parses the
+ * MQTT 5 layout and discards the properties.
+ *******************************************************************************/
+
+#if !defined(MQTTV5PACKET_H)
+#define MQTTV5PACKET_H
+
+#include "MQTTProperties.h"
+#include "MQTTReasonCodes.h"
+
+DLLExport int MQTTV5Serialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData* options,
+		MQTTProperties* connectProperties, MQTTProperties* willProperties);
+DLLExport int MQTTV5Deserialize_connack(MQTTProperties* connackProperties, unsigned char* sessionPresent,
+		unsigned char* reasonCode, unsigned char* buf, int buflen);
+
+DLLExport int MQTTV5Serialize_disconnect(unsigned char* buf, int buflen, unsigned char reasonCode, MQTTProperties* properties);
+DLLExport int MQTTV5Deserialize_disconnect(MQTTProperties* properties, unsigned char* reasonCode, unsigned char* buf, int buflen);
+
+DLLExport int MQTTV5Serialize_publishHeader(unsigned char* buf, int buflen, unsigned char dup, int qos, unsigned char retained,
+		unsigned short packetid, MQTTString topicName, MQTTProperties* properties, int payloadlen);
+DLLExport int MQTTV5Deserialize_publish(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid,
+		MQTTString* topicName, MQTTProperties* properties, unsigned char** payload, int* payloadlen, unsigned char* buf, int len);
+
+/* reasonCode is MQTTREASONCODE_SUCCESS when the ack omits it, as MQTT 3 acks always do */
+DLLExport int MQTTV5Deserialize_ack(unsigned char* packettype, unsigned char* dup, unsigned short* packetid,
+		unsigned char* reasonCode, MQTTProperties* properties, unsigned char* buf, int buflen);
+
+/* options: requested QoS in bits 0-1, the other MQTT 5 subscription options above */
+DLLExport int MQTTV5Serialize_subscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid,
+		MQTTProperties* properties, int count, MQTTString topicFilters[], int options[]);
+DLLExport int MQTTV5Deserialize_suback(unsigned short* packetid, MQTTProperties* properties, int maxcount, int* count,
+		int reasonCodes[], unsigned char* buf, int buflen);
+
+DLLExport int MQTTV5Serialize_unsubscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid,
+		MQTTProperties* properties, int count, MQTTString topicFilters[]);
+DLLExport int MQTTV5Deserialize_unsuback(unsigned short* packetid, MQTTProperties* properties, int maxcount, int* count,
+		int reasonCodes[], unsigned char* buf, int buflen);
+
+#endif /* MQTTV5PACKET_H */
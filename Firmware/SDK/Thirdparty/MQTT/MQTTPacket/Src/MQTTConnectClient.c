@@ -20,11 +20,13 @@
 #include <string.h>
 
 /**
-  * Determines the length of the MQTT connect packet that would be produced using the supplied connect options.
+  * Determines the length of the MQTT connect packet, including the MQTT 5 properties
   * @param options the options to be used to build the connect packet
+  * @param connectProperties the connect properties, NULL for none
+  * @param willProperties the will properties, NULL for none
   * @return the length of buffer needed to contain the serialized version of the packet
   */
-int MQTTSerialize_connectLength(MQTTPacket_connectData* options)
+static int MQTTV5Serialize_connectLength(MQTTPacket_connectData* options, MQTTProperties* connectProperties, MQTTProperties* willProperties)
 {
 	int len = 0;
 
@@ -32,12 +34,19 @@ int MQTTSerialize_connectLength(MQTTPacket_connectData* options)
 
 	if (options->MQTTVersion == 3)
 		len = 12; /* variable depending on MQTT or MQIsdp */
-	else if (options->MQTTVersion == 4)
+	else if (options->MQTTVersion >= 4)
 		len = 10;
 
+	if (options->MQTTVersion == 5)
+		len += MQTTProperties_len(connectProperties);
+
 	len += MQTTstrlen(options->clientID)+2;
 	if (options->willFlag)
+	{
 		len += MQTTstrlen(options->will.topicName)+2 + MQTTstrlen(options->will.message)+2;
+		if (options->MQTTVersion == 5)
+			len += MQTTProperties_len(willProperties);
+	}
 	if (options->username.cstring || options->username.lenstring.data)
 		len += MQTTstrlen(options->username)+2;
 	if (options->password.cstring || options->password.lenstring.data)
@@ -48,6 +57,17 @@ int MQTTSerialize_connectLength(MQTTPacket_connectData* options)
 }
 
 
+/**
+  * Determines the length of the MQTT connect packet that would be produced using the supplied connect options.
+  * @param options the options to be used to build the connect packet
+  * @return the length of buffer needed to contain the serialized version of the packet
+  */
+int MQTTSerialize_connectLength(MQTTPacket_connectData* options)
+{
+	return MQTTV5Serialize_connectLength(options, NULL, NULL);
+}
+
+
 /**
   * Serializes the connect options into the buffer.
   * @param buf the buffer into which the packet will be serialized
@@ -56,6 +76,23 @@ int MQTTSerialize_connectLength(MQTTPacket_connectData* options)
   * @return serialized length, or error if 0
   */
 int MQTTSerialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData* options)
+{
+	return MQTTV5Serialize_connect(buf, buflen, options, NULL, NULL);
+}
+
+
+/**
+  * Serializes the connect options into the buffer, with the MQTT 5 properties when
+  * options->MQTTVersion is 5.
+  * @param buf the buffer into which the packet will be serialized
+  * @param len the length in bytes of the supplied buffer
+  * @param options the options to be used to build the connect packet
+  * @param connectProperties the connect properties, NULL for none
+  * @param willProperties the will properties, NULL for none
+  * @return serialized length, or error if 0
+  */
+int MQTTV5Serialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData* options,
+		MQTTProperties* connectProperties, MQTTProperties* willProperties)
 {
 	unsigned char *ptr = buf;
 	MQTTHeader header = {0};
@@ -64,7 +101,7 @@ int MQTTSerialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData
 	int rc = -1;
 
 	FUNC_ENTRY;
-	if (MQTTPacket_len(len = MQTTSerialize_connectLength(options)) > buflen)
+	if (MQTTPacket_len(len = MQTTV5Serialize_connectLength(options, connectProperties, willProperties)) > buflen)
 	{
 		rc = MQTTPACKET_BUFFER_TOO_SHORT;
 		goto exit;
@@ -76,10 +113,10 @@ int MQTTSerialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData
 
 	ptr += MQTTPacket_encode(ptr, len); /* write remaining length */
 
-	if (options->MQTTVersion == 4)
+	if (options->MQTTVersion >= 4)
 	{
 		writeCString(&ptr, "MQTT");
-		writeChar(&ptr, (char) 4);
+		writeChar(&ptr, (char) options->MQTTVersion);
 	}
 	else
 	{
@@ -103,9 +140,13 @@ int MQTTSerialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData
 
 	writeChar(&ptr, flags.all);
 	writeInt(&ptr, options->keepAliveInterval);
+	if (options->MQTTVersion == 5)
+		MQTTProperties_write(&ptr, connectProperties);
 	writeMQTTString(&ptr, options->clientID);
 	if (options->willFlag)
 	{
+		if (options->MQTTVersion == 5)
+			MQTTProperties_write(&ptr, willProperties);
 		writeMQTTString(&ptr, options->will.topicName);
 		writeMQTTString(&ptr, options->will.message);
 	}
@@ -130,6 +171,22 @@ int MQTTSerialize_connect(unsigned char* buf, int buflen, MQTTPacket_connectData
   * @return error code.  1 is success, 0 is failure
   */
 int MQTTDeserialize_connack(unsigned char* sessionPresent, unsigned char* connack_rc, unsigned char* buf, int buflen)
+{
+	return MQTTV5Deserialize_connack(NULL, sessionPresent, connack_rc, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into connack data - reason code and properties
+  * @param connackProperties returned MQTT 5 properties, NULL for an MQTT 3 connack
+  * @param sessionPresent the session present flag returned
+  * @param reasonCode returned integer value of the connack return code, or MQTT 5 reason code
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param len the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_connack(MQTTProperties* connackProperties, unsigned char* sessionPresent,
+		unsigned char* reasonCode, unsigned char* buf, int buflen)
 {
 	MQTTHeader header = {0};
 	unsigned char* curdata = buf;
@@ -150,7 +207,11 @@ int MQTTDeserialize_connack(unsigned char* sessionPresent, unsigned char* connac
 
 	flags.all = readChar(&curdata);
 	*sessionPresent = flags.bits.sessionpresent;
-	*connack_rc = readChar(&curdata);
+	*reasonCode = readChar(&curdata);
+
+	rc = 0;
+	if (connackProperties && !MQTTProperties_read(connackProperties, &curdata, enddata))
+		goto exit;
 
 	rc = 1;
 exit:
@@ -202,6 +263,90 @@ int MQTTSerialize_disconnect(unsigned char* buf, int buflen)
 }
 
 
+/**
+  * Serializes an MQTT 5 disconnect packet. With a normal disconnection and no properties
+  * it is the same 2 byte packet as MQTT 3.
+  * @param buf the buffer into which the packet will be serialized
+  * @param buflen the length in bytes of the supplied buffer, to avoid overruns
+  * @param reasonCode the MQTT 5 reason code
+  * @param properties the disconnect properties, NULL for none
+  * @return serialized length, or error if 0
+  */
+int MQTTV5Serialize_disconnect(unsigned char* buf, int buflen, unsigned char reasonCode, MQTTProperties* properties)
+{
+	MQTTHeader header = {0};
+	unsigned char *ptr = buf;
+	int rem_len = 0;
+	int rc = -1;
+
+	FUNC_ENTRY;
+	if (reasonCode == MQTTREASONCODE_NORMAL_DISCONNECTION && (properties == NULL || properties->length == 0))
+	{
+		rc = MQTTSerialize_zero(buf, buflen, DISCONNECT);
+		goto exit;
+	}
+
+	rem_len = 1 + MQTTProperties_len(properties);
+	if (MQTTPacket_len(rem_len) > buflen)
+	{
+		rc = MQTTPACKET_BUFFER_TOO_SHORT;
+		goto exit;
+	}
+
+	header.byte = 0;
+	header.bits.type = DISCONNECT;
+	writeChar(&ptr, header.byte); /* write header */
+
+	ptr += MQTTPacket_encode(ptr, rem_len); /* write remaining length */
+	writeChar(&ptr, reasonCode);
+	MQTTProperties_write(&ptr, properties);
+
+	rc = ptr - buf;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
+
+
+/**
+  * Deserializes a disconnect packet sent by an MQTT 5 server
+  * @param properties returned properties, may be NULL
+  * @param reasonCode returned MQTT 5 reason code
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_disconnect(MQTTProperties* properties, unsigned char* reasonCode, unsigned char* buf, int buflen)
+{
+	MQTTHeader header = {0};
+	unsigned char* curdata = buf;
+	unsigned char* enddata = NULL;
+	int rc = 0;
+	int mylen;
+
+	FUNC_ENTRY;
+	header.byte = readChar(&curdata);
+	if (header.bits.type != DISCONNECT)
+		goto exit;
+
+	curdata += (rc = MQTTPacket_decodeBuf(curdata, &mylen)); /* read remaining length */
+	enddata = curdata + mylen;
+
+	*reasonCode = MQTTREASONCODE_NORMAL_DISCONNECTION;
+	if (curdata < enddata)
+		*reasonCode = readChar(&curdata);
+
+	rc = 0;
+	if (properties && !MQTTProperties_read(properties, &curdata, enddata))
+		goto exit;
+
+	rc = 1;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
+
+
 /**
   * Serializes a disconnect packet into the supplied buffer, ready for writing to a socket
   * @param buf the buffer into which the packet will be serialized
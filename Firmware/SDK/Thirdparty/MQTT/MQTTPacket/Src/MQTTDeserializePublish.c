@@ -35,6 +35,18 @@
   */
 int MQTTDeserialize_publish(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid, MQTTString* topicName,
 		unsigned char** payload, int* payloadlen, unsigned char* buf, int buflen)
+{
+	return MQTTV5Deserialize_publish(dup, qos, retained, packetid, topicName, NULL, payload, payloadlen, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into publish data, with the MQTT 5 properties
+  * @param properties returned properties, NULL for an MQTT 3 publish
+  * @return error code.  1 is success
+  */
+int MQTTV5Deserialize_publish(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid,
+		MQTTString* topicName, MQTTProperties* properties, unsigned char** payload, int* payloadlen, unsigned char* buf, int buflen)
 {
 	MQTTHeader header = {0};
 	unsigned char* curdata = buf;
@@ -60,6 +72,10 @@ int MQTTDeserialize_publish(unsigned char* dup, int* qos, unsigned char* retaine
 	if (*qos > 0)
 		*packetid = readInt(&curdata);
 
+	rc = 0;
+	if (properties && !MQTTProperties_read(properties, &curdata, enddata))
+		goto exit;
+
 	*payloadlen = enddata - curdata;
 	*payload = curdata;
 	rc = 1;
@@ -80,6 +96,21 @@ exit:
   * @return error code.  1 is success, 0 is failure
   */
 int MQTTDeserialize_ack(unsigned char* packettype, unsigned char* dup, unsigned short* packetid, unsigned char* buf, int buflen)
+{
+	unsigned char reasonCode;
+
+	return MQTTV5Deserialize_ack(packettype, dup, packetid, &reasonCode, NULL, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into an ack, with the MQTT 5 reason code and properties
+  * @param reasonCode returned MQTT 5 reason code, MQTTREASONCODE_SUCCESS when omitted
+  * @param properties returned properties, may be NULL
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_ack(unsigned char* packettype, unsigned char* dup, unsigned short* packetid,
+		unsigned char* reasonCode, MQTTProperties* properties, unsigned char* buf, int buflen)
 {
 	MQTTHeader header = {0};
 	unsigned char* curdata = buf;
@@ -99,6 +130,14 @@ int MQTTDeserialize_ack(unsigned char* packettype, unsigned char* dup, unsigned
 		goto exit;
 	*packetid = readInt(&curdata);
 
+	*reasonCode = MQTTREASONCODE_SUCCESS;
+	if (curdata < enddata)
+		*reasonCode = readChar(&curdata);
+
+	rc = 0;
+	if (properties && !MQTTProperties_read(properties, &curdata, enddata))
+		goto exit;
+
 	rc = 1;
 exit:
 	FUNC_EXIT_RC(rc);
@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * MQTT 5 properties: encoding and decoding of the property list that follows
+ * the variable header of MQTT 5 packets.
+ *******************************************************************************/
+
+#include "MQTTPacket.h"
+#include "StackTrace.h"
+
+#include <string.h>
+
+static const struct nameToType
+{
+	unsigned char name;
+	unsigned char type;
+} namesToTypes[] =
+{
+	{MQTTPROPERTY_CODE_PAYLOAD_FORMAT_INDICATOR, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_MESSAGE_EXPIRY_INTERVAL, MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_CONTENT_TYPE, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_RESPONSE_TOPIC, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_CORRELATION_DATA, MQTTPROPERTY_TYPE_BINARY_DATA},
+	{MQTTPROPERTY_CODE_SUBSCRIPTION_IDENTIFIER, MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL, MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_ASSIGNED_CLIENT_IDENTIFER, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_SERVER_KEEP_ALIVE, MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_AUTHENTICATION_METHOD, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_AUTHENTICATION_DATA, MQTTPROPERTY_TYPE_BINARY_DATA},
+	{MQTTPROPERTY_CODE_REQUEST_PROBLEM_INFORMATION, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_WILL_DELAY_INTERVAL, MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_REQUEST_RESPONSE_INFORMATION, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_RESPONSE_INFORMATION, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_SERVER_REFERENCE, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_REASON_STRING, MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING},
+	{MQTTPROPERTY_CODE_RECEIVE_MAXIMUM, MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM, MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_TOPIC_ALIAS, MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_MAXIMUM_QOS, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_RETAIN_AVAILABLE, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_USER_PROPERTY, MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR},
+	{MQTTPROPERTY_CODE_MAXIMUM_PACKET_SIZE, MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER},
+	{MQTTPROPERTY_CODE_WILDCARD_SUBSCRIPTION_AVAILABLE, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_SUBSCRIPTION_IDENTIFIERS_AVAILABLE, MQTTPROPERTY_TYPE_BYTE},
+	{MQTTPROPERTY_CODE_SHARED_SUBSCRIPTION_AVAILABLE, MQTTPROPERTY_TYPE_BYTE}
+};
+
+
+/**
+ * Returns the data type of a property
+ * @param identifier the MQTT 5 property id
+ * @return one of MQTTPropertyTypes, or -1 for an unknown id
+ */
+int MQTTProperty_getType(int identifier)
+{
+	int i;
+
+	for (i = 0; i < (int)(sizeof(namesToTypes) / sizeof(namesToTypes[0])); ++i)
+	{
+		if (namesToTypes[i].name == identifier)
+			return namesToTypes[i].type;
+	}
+	return -1;
+}
+
+
+int MQTTPacket_VBIlen(int rem_len)
+{
+	if (rem_len < 128)
+		return 1;
+	else if (rem_len < 16384)
+		return 2;
+	else if (rem_len < 2097152)
+		return 3;
+	return 4;
+}
+
+
+static int MQTTProperty_len(const MQTTProperty* prop)
+{
+	int rc = -1;
+
+	switch (MQTTProperty_getType(prop->identifier))
+	{
+		case MQTTPROPERTY_TYPE_BYTE:
+			rc = 1;
+			break;
+		case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+			rc = 2;
+			break;
+		case MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER:
+			rc = 4;
+			break;
+		case MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER:
+			rc = MQTTPacket_VBIlen(prop->value.integer4);
+			break;
+		case MQTTPROPERTY_TYPE_BINARY_DATA:
+		case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+			rc = 2 + prop->value.data.len;
+			break;
+		case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+			rc = 2 + prop->value.data.len + 2 + prop->value.value.len;
+			break;
+	}
+	return (rc < 0) ? rc : rc + 1; /* identifier, all known ids fit in one byte */
+}
+
+
+int MQTTProperties_len(MQTTProperties* props)
+{
+	if (props == NULL)
+		return 1;
+	return props->length + MQTTPacket_VBIlen(props->length);
+}
+
+
+int MQTTProperties_add(MQTTProperties* props, const MQTTProperty* prop)
+{
+	int len;
+
+	if (props->count == props->max_count)
+		return -1;
+	if ((len = MQTTProperty_len(prop)) < 0)
+		return MQTT_INVALID_PROPERTY_ID;
+
+	props->array[props->count++] = *prop;
+	props->length += len;
+	return 0;
+}
+
+
+static void writeLenString(unsigned char** pptr, const MQTTLenString* string)
+{
+	writeInt(pptr, string->len);
+	if (string->len > 0)
+		memcpy(*pptr, string->data, string->len);
+	*pptr += string->len;
+}
+
+
+int MQTTProperties_write(unsigned char** pptr, const MQTTProperties* props)
+{
+	unsigned char* start = *pptr;
+	int i;
+
+	if (props == NULL)
+	{
+		writeChar(pptr, 0);
+		return 1;
+	}
+
+	*pptr += MQTTPacket_encode(*pptr, props->length);
+	for (i = 0; i < props->count; ++i)
+	{
+		const MQTTProperty* prop = &props->array[i];
+
+		writeChar(pptr, prop->identifier);
+		switch (MQTTProperty_getType(prop->identifier))
+		{
+			case MQTTPROPERTY_TYPE_BYTE:
+				writeChar(pptr, prop->value.byte);
+				break;
+			case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+				writeInt(pptr, prop->value.integer2);
+				break;
+			case MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER:
+				writeInt(pptr, prop->value.integer4 >> 16);
+				writeInt(pptr, prop->value.integer4 & 0xFFFF);
+				break;
+			case MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER:
+				*pptr += MQTTPacket_encode(*pptr, prop->value.integer4);
+				break;
+			case MQTTPROPERTY_TYPE_BINARY_DATA:
+			case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+				writeLenString(pptr, &prop->value.data);
+				break;
+			case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+				writeLenString(pptr, &prop->value.data);
+				writeLenString(pptr, &prop->value.value);
+				break;
+		}
+	}
+	return *pptr - start;
+}
+
+
+/* variable byte integer within the buffer, returns the number of bytes or 0 when malformed */
+static int readVBI(unsigned char** pptr, unsigned char* enddata, int* value)
+{
+	int multiplier = 1;
+	int len = 0;
+	unsigned char c;
+
+	*value = 0;
+	do
+	{
+		if (*pptr >= enddata || ++len > 4)
+			return 0;
+		c = *(*pptr)++;
+		*value += (c & 127) * multiplier;
+		multiplier *= 128;
+	} while ((c & 128) != 0);
+	return len;
+}
+
+
+static int readLenString(MQTTLenString* string, unsigned char** pptr, unsigned char* enddata)
+{
+	MQTTString mqttstring;
+
+	if (!readMQTTLenString(&mqttstring, pptr, enddata))
+		return 0;
+	*string = mqttstring.lenstring;
+	return 1;
+}
+
+
+int MQTTProperties_read(MQTTProperties* props, unsigned char** pptr, unsigned char* enddata)
+{
+	MQTTProperty prop;
+	unsigned char* end;
+	int length = 0;
+	int rc = 0;
+	int vbi;
+
+	FUNC_ENTRY;
+	props->count = 0;
+	props->length = 0;
+
+	/* properties may be omitted at the end of acks, meaning none */
+	if (*pptr == enddata)
+	{
+		rc = 1;
+		goto exit;
+	}
+
+	if (readVBI(pptr, enddata, &length) == 0 || *pptr + length > enddata)
+		goto exit;
+	end = *pptr + length;
+
+	while (*pptr < end)
+	{
+		memset(&prop, 0, sizeof(prop));
+		prop.identifier = readChar(pptr);
+		switch (MQTTProperty_getType(prop.identifier))
+		{
+			case MQTTPROPERTY_TYPE_BYTE:
+				if (end - *pptr < 1)
+					goto exit;
+				prop.value.byte = readChar(pptr);
+				break;
+			case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+				if (end - *pptr < 2)
+					goto exit;
+				prop.value.integer2 = readInt(pptr);
+				break;
+			case MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER:
+				if (end - *pptr < 4)
+					goto exit;
+				prop.value.integer4 = (unsigned int)readInt(pptr) << 16;
+				prop.value.integer4 |= readInt(pptr);
+				break;
+			case MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER:
+				if (readVBI(pptr, end, &vbi) == 0)
+					goto exit;
+				prop.value.integer4 = vbi;
+				break;
+			case MQTTPROPERTY_TYPE_BINARY_DATA:
+			case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+				if (!readLenString(&prop.value.data, pptr, end))
+					goto exit;
+				break;
+			case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+				if (!readLenString(&prop.value.data, pptr, end) || !readLenString(&prop.value.value, pptr, end))
+					goto exit;
+				break;
+			default:
+				goto exit; /* unknown id: the rest cannot be parsed */
+		}
+
+		if (props->count < props->max_count)
+			props->array[props->count++] = prop;
+	}
+
+	props->length = length;
+	rc = 1;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
+
+
+int MQTTProperties_getNumericValue(MQTTProperties* props, int identifier, unsigned int* value)
+{
+	int i;
+
+	for (i = 0; props != NULL && i < props->count; ++i)
+	{
+		if (props->array[i].identifier != identifier)
+			continue;
+
+		switch (MQTTProperty_getType(identifier))
+		{
+			case MQTTPROPERTY_TYPE_BYTE:
+				*value = props->array[i].value.byte;
+				return 1;
+			case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+				*value = props->array[i].value.integer2;
+				return 1;
+			case MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER:
+			case MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER:
+				*value = props->array[i].value.integer4;
+				return 1;
+		}
+	}
+	return 0;
+}
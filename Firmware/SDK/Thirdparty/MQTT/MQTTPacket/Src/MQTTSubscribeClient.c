@@ -49,6 +49,19 @@ int MQTTSerialize_subscribeLength(int count, MQTTString topicFilters[])
   */
 int MQTTSerialize_subscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid, int count,
 		MQTTString topicFilters[], int requestedQoSs[])
+{
+	return MQTTV5Serialize_subscribe(buf, buflen, dup, packetid, NULL, count, topicFilters, requestedQoSs);
+}
+
+
+/**
+  * Serializes the supplied subscribe data with the MQTT 5 properties and subscription options
+  * @param properties the subscribe properties, NULL for an MQTT 3 subscribe
+  * @param options - array of subscription options, the requested QoS in bits 0-1
+  * @return the length of the serialized data.  <= 0 indicates error
+  */
+int MQTTV5Serialize_subscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid,
+		MQTTProperties* properties, int count, MQTTString topicFilters[], int options[])
 {
 	unsigned char *ptr = buf;
 	MQTTHeader header = {0};
@@ -57,7 +70,10 @@ int MQTTSerialize_subscribe(unsigned char* buf, int buflen, unsigned char dup, u
 	int i = 0;
 
 	FUNC_ENTRY;
-	if (MQTTPacket_len(rem_len = MQTTSerialize_subscribeLength(count, topicFilters)) > buflen)
+	rem_len = MQTTSerialize_subscribeLength(count, topicFilters);
+	if (properties)
+		rem_len += MQTTProperties_len(properties);
+	if (MQTTPacket_len(rem_len) > buflen)
 	{
 		rc = MQTTPACKET_BUFFER_TOO_SHORT;
 		goto exit;
@@ -73,10 +89,13 @@ int MQTTSerialize_subscribe(unsigned char* buf, int buflen, unsigned char dup, u
 
 	writeInt(&ptr, packetid);
 
+	if (properties)
+		MQTTProperties_write(&ptr, properties);
+
 	for (i = 0; i < count; ++i)
 	{
 		writeMQTTString(&ptr, topicFilters[i]);
-		writeChar(&ptr, requestedQoSs[i]);
+		writeChar(&ptr, options[i]);
 	}
 
 	rc = ptr - buf;
@@ -98,6 +117,19 @@ exit:
   * @return error code.  1 is success, 0 is failure
   */
 int MQTTDeserialize_suback(unsigned short* packetid, int maxcount, int* count, int grantedQoSs[], unsigned char* buf, int buflen)
+{
+	return MQTTV5Deserialize_suback(packetid, NULL, maxcount, count, grantedQoSs, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into suback data, with the MQTT 5 properties
+  * @param properties returned properties, NULL for an MQTT 3 suback
+  * @param reasonCodes returned array of integers - the granted QoS, or a reason code from 0x80 on failure
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_suback(unsigned short* packetid, MQTTProperties* properties, int maxcount, int* count,
+		int reasonCodes[], unsigned char* buf, int buflen)
 {
 	MQTTHeader header = {0};
 	unsigned char* curdata = buf;
@@ -117,15 +149,19 @@ int MQTTDeserialize_suback(unsigned short* packetid, int maxcount, int* count, i
 
 	*packetid = readInt(&curdata);
 
+	rc = 0;
+	if (properties && !MQTTProperties_read(properties, &curdata, enddata))
+		goto exit;
+
 	*count = 0;
 	while (curdata < enddata)
 	{
-		if (*count > maxcount)
+		if (*count >= maxcount)
 		{
 			rc = -1;
 			goto exit;
 		}
-		grantedQoSs[(*count)++] = readChar(&curdata);
+		reasonCodes[(*count)++] = readChar(&curdata);
 	}
 
 	rc = 1;
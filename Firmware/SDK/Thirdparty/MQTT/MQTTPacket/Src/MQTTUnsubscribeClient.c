@@ -48,6 +48,18 @@ int MQTTSerialize_unsubscribeLength(int count, MQTTString topicFilters[])
   */
 int MQTTSerialize_unsubscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid,
 		int count, MQTTString topicFilters[])
+{
+	return MQTTV5Serialize_unsubscribe(buf, buflen, dup, packetid, NULL, count, topicFilters);
+}
+
+
+/**
+  * Serializes the supplied unsubscribe data with the MQTT 5 properties
+  * @param properties the unsubscribe properties, NULL for an MQTT 3 unsubscribe
+  * @return the length of the serialized data.  <= 0 indicates error
+  */
+int MQTTV5Serialize_unsubscribe(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid,
+		MQTTProperties* properties, int count, MQTTString topicFilters[])
 {
 	unsigned char *ptr = buf;
 	MQTTHeader header = {0};
@@ -56,7 +68,10 @@ int MQTTSerialize_unsubscribe(unsigned char* buf, int buflen, unsigned char dup,
 	int i = 0;
 
 	FUNC_ENTRY;
-	if (MQTTPacket_len(rem_len = MQTTSerialize_unsubscribeLength(count, topicFilters)) > buflen)
+	rem_len = MQTTSerialize_unsubscribeLength(count, topicFilters);
+	if (properties)
+		rem_len += MQTTProperties_len(properties);
+	if (MQTTPacket_len(rem_len) > buflen)
 	{
 		rc = MQTTPACKET_BUFFER_TOO_SHORT;
 		goto exit;
@@ -72,6 +87,9 @@ int MQTTSerialize_unsubscribe(unsigned char* buf, int buflen, unsigned char dup,
 
 	writeInt(&ptr, packetid);
 
+	if (properties)
+		MQTTProperties_write(&ptr, properties);
+
 	for (i = 0; i < count; ++i)
 		writeMQTTString(&ptr, topicFilters[i]);
 
@@ -104,3 +122,55 @@ int MQTTDeserialize_unsuback(unsigned short* packetid, unsigned char* buf, int b
 }
 
 
+/**
+  * Deserializes an MQTT 5 unsuback: packet identifier, properties and one reason code per topic filter
+  * @param packetid returned integer - the MQTT packet identifier
+  * @param properties returned properties, may have max_count 0
+  * @param maxcount - the maximum number of members allowed in the reasonCodes array
+  * @param count returned integer - number of members in the reasonCodes array
+  * @param reasonCodes returned array of integers - MQTT 5 reason codes
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_unsuback(unsigned short* packetid, MQTTProperties* properties, int maxcount, int* count,
+		int reasonCodes[], unsigned char* buf, int buflen)
+{
+	MQTTHeader header = {0};
+	unsigned char* curdata = buf;
+	unsigned char* enddata = NULL;
+	int rc = 0;
+	int mylen;
+
+	FUNC_ENTRY;
+	header.byte = readChar(&curdata);
+	if (header.bits.type != UNSUBACK)
+		goto exit;
+
+	curdata += (rc = MQTTPacket_decodeBuf(curdata, &mylen)); /* read remaining length */
+	enddata = curdata + mylen;
+	rc = 0;
+	if (enddata - curdata < 2)
+		goto exit;
+
+	*packetid = readInt(&curdata);
+
+	if (properties && !MQTTProperties_read(properties, &curdata, enddata))
+		goto exit;
+
+	*count = 0;
+	while (curdata < enddata)
+	{
+		if (*count >= maxcount)
+		{
+			rc = -1;
+			goto exit;
+		}
+		reasonCodes[(*count)++] = readChar(&curdata);
+	}
+
+	rc = 1;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}